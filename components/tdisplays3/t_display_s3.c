@@ -2,25 +2,22 @@
 // SPDX-License-Identifier: MIT
 
 #include "t_display_s3.h"
+#include "t_display_s3_priv.h"
 #include <stdio.h>
+#include <inttypes.h>
 #include <esp_log.h>
-#include "esp_adc/adc_oneshot.h"
-#include <soc/adc_channel.h>
 #include <esp_lcd_panel_st7789.h>
 #include <driver/ledc.h>
-#include "math.h"
 #include "aw9364.h"
 //
 
 
 static const char *TAG = "esp_idf_t_display_s3";
 
-// ADC handle for battery voltage monitoring
-static adc_oneshot_unit_handle_t adc_handle;
-// ADC calibration handle for battery voltage monitoring
-static adc_cali_handle_t adc_cali_handle;
+#if !LCD_BK_LIGHT_RMT
 // AW9364 handle (brightness controller)
 static aw9364_dev_handle_t aw9364_dev_hdl;
+#endif
 
 // initialize the LCD I80 bus
 static void init_lcd_i80_bus(esp_lcd_panel_io_handle_t *io_handle) {
@@ -58,9 +55,9 @@ static void init_lcd_i80_bus(esp_lcd_panel_io_handle_t *io_handle) {
                     .dc_dummy_level = LCD_I80_DC_DUMMY_LEVEL,
                     .dc_data_level = LCD_I80_DC_DATA_LEVEL,
             },
-//            .flags = {
-//                    .swap_color_bytes = !LV_COLOR_16_SWAP, // Swap can be done in LvGL (default) or DMA
-//            },
+            .flags = {
+                    .swap_color_bytes = LCD_I80_SWAP_COLOR_BYTES, // Swap can be done in LvGL or DMA
+            },
 //            .user_ctx = user_ctx,
             .lcd_cmd_bits = LCD_CMD_BITS,
             .lcd_param_bits = LCD_PARAM_BITS,
@@ -87,71 +84,13 @@ static void init_lcd_panel(esp_lcd_panel_io_handle_t io_handle, esp_lcd_panel_ha
     // landscape, buttons on left, screen on right
     esp_lcd_panel_swap_xy(panel_handle, true);
     esp_lcd_panel_mirror(panel_handle, false, true);
-    esp_lcd_panel_set_gap(panel_handle, 0, 35);
+    esp_lcd_panel_set_gap(panel_handle, LCD_X_GAP, LCD_Y_GAP);
 
     ESP_ERROR_CHECK(esp_lcd_panel_disp_on_off(panel_handle, true));
 
     *panel = panel_handle;
 }
 
-static void init_battery_adc() {
-    if (adc_handle == NULL) {
-        /* Initialize ADC */
-        const adc_oneshot_unit_init_cfg_t adc_cfg = {
-                .unit_id = ADC_UNIT_1,
-        };
-        ESP_ERROR_CHECK(adc_oneshot_new_unit(&adc_cfg, &adc_handle));
-    }
-}
-
-static void init_battery_monitor() {
-    ESP_LOGI(TAG, "Configuring battery monitor...");
-    /* Initialize ADC and get ADC handle */
-    init_battery_adc();
-
-    /* Init ADC channels */
-    const adc_oneshot_chan_cfg_t adc_chan_cfg = {
-            .bitwidth = ADC_BITWIDTH_DEFAULT,
-            .atten = ADC_ATTEN_DB_12,
-    };
-    ESP_ERROR_CHECK(adc_oneshot_config_channel(adc_handle, ADC_CHANNEL_3, &adc_chan_cfg));
-
-    /* ESP32-S3 supports Curve Fitting calibration scheme */
-    const adc_cali_curve_fitting_config_t cali_config = {
-            .unit_id = ADC_UNIT_1,
-            .atten = ADC_ATTEN_DB_12,
-            .bitwidth = ADC_BITWIDTH_DEFAULT,
-    };
-    ESP_ERROR_CHECK(adc_cali_create_scheme_curve_fitting(&cali_config, &adc_cali_handle));
-}
-
-
-int get_battery_voltage() {
-    int voltage, adc_raw;
-
-    assert(adc_handle);
-    ESP_ERROR_CHECK(adc_oneshot_read(adc_handle, ADC_CHANNEL_3, &adc_raw));
-    ESP_ERROR_CHECK(adc_cali_raw_to_voltage(adc_cali_handle, adc_raw, &voltage));
-    return voltage * 2;
-}
-
-double volts_to_percentage(double volts) {
-    // equation based on https://electronics.stackexchange.com/a/551667
-    return 123 - ((double) 123 / pow((1 + pow(((double) volts / 3.7), 80)), 0.165));
-}
-
-int get_battery_percentage() {
-    return (int) ceil(volts_to_percentage((double)get_battery_voltage()/1000));
-}
-
-bool usb_power_voltage(int milliVolts) {
-    return ceilf((float) (milliVolts - 100) / 1000) == 5.0;
-}
-
-bool usb_power_connected() {
-    return usb_power_voltage((double)get_battery_voltage());
-}
-
 static void lcd_power_init(void) {
     ESP_LOGI(TAG, "Configuring LCD PWR GPIO...");
     gpio_config_t lcd_pwr_gpio_config = {
@@ -173,6 +112,10 @@ static void lcd_power_init(void) {
 
 static void lcd_brightness_init(void) {
     ESP_LOGI(TAG, "Configuring LCD Brightness...");
+#if LCD_BK_LIGHT_RMT
+    // pulse count dimming from the RMT on the EN pin
+    ESP_ERROR_CHECK(lcd_aw9364_init(LCD_PIN_NUM_BK_LIGHT));
+#else
     // Setup LEDC peripheral for PWM backlight control
     const ledc_channel_config_t lcd_backlight_channel = {
             .gpio_num = LCD_PIN_NUM_BK_LIGHT,
@@ -194,8 +137,48 @@ static void lcd_brightness_init(void) {
     ESP_LOGI(TAG, "aw9364_init");
     esp_err_t err = aw9364_init(&lcd_backlight_channel, &lcd_backlight_timer, &aw9364_dev_hdl);
     ESP_ERROR_CHECK(err);
+#endif
 }
 
+#if LCD_BK_LIGHT_RMT
+
+void lcd_set_brightness_step(uint8_t brightness_step) {
+    ESP_ERROR_CHECK(lcd_aw9364_set_step(brightness_step, 0));
+}
+
+void lcd_set_brightness_step_fade(uint8_t brightness_step, uint32_t fade_time_ms) {
+    ESP_ERROR_CHECK(lcd_aw9364_set_step(brightness_step, fade_time_ms));
+}
+
+// same step per percent as the aw9364 component
+void lcd_set_brightness_pct(uint8_t brightness_percent) {
+    lcd_set_brightness_pct_fade(brightness_percent, 0);
+}
+
+void lcd_set_brightness_pct_fade(uint8_t brightness_percent, uint32_t fade_time_ms) {
+    uint8_t pct = brightness_percent > 100 ? 100 : brightness_percent;
+    ESP_ERROR_CHECK(lcd_aw9364_set_step(pct * AW9364_MAX_BRIGHTNESS_STEPS / 100, fade_time_ms));
+}
+
+void lcd_increment_brightness_step() {
+    ESP_ERROR_CHECK(lcd_aw9364_set_step(lcd_aw9364_get_step() + 1, 0));
+}
+
+void lcd_decrement_brightness_step() {
+    uint8_t step = lcd_aw9364_get_step();
+    ESP_ERROR_CHECK(lcd_aw9364_set_step(step > 0 ? step - 1 : 0, 0));
+}
+
+uint8_t lcd_get_brightness_step() {
+    return lcd_aw9364_get_step();
+}
+
+uint8_t lcd_get_brightness_pct() {
+    return lcd_aw9364_get_step() * 100 / AW9364_MAX_BRIGHTNESS_STEPS;
+}
+
+#else
+
 void lcd_set_brightness_step(uint8_t brightness_step) {
     ESP_ERROR_CHECK(aw9364_set_brightness_step(aw9364_dev_hdl, brightness_step, 0));
 }
@@ -228,6 +211,8 @@ uint8_t lcd_get_brightness_pct() {
     return aw9364_get_brightness_pct(aw9364_dev_hdl);
 }
 
+#endif
+
 static lv_disp_t *lcd_lvgl_add_disp(esp_lcd_panel_io_handle_t io_handle, esp_lcd_panel_handle_t panel_handle) {
     ESP_LOGI(TAG, "Adding display driver to lvgl port...");
     /* Add LCD screen */
@@ -235,7 +220,8 @@ static lv_disp_t *lcd_lvgl_add_disp(esp_lcd_panel_io_handle_t io_handle, esp_lcd
             .io_handle = io_handle,
             .panel_handle = panel_handle,
             .buffer_size = LVGL_BUFFER_SIZE,
-            .double_buffer = true,
+            // stripe buffers of the flush pipeline are added by lcd_flush_init
+            .double_buffer = false,
             .hres = LCD_H_RES,
             .vres = LCD_V_RES,
             .monochrome = false,
@@ -248,10 +234,29 @@ static lv_disp_t *lcd_lvgl_add_disp(esp_lcd_panel_io_handle_t io_handle, esp_lcd
             },
             .flags = {
                     .buff_spiram = true,
-                    .swap_bytes = true,
+                    .swap_bytes = !LCD_I80_SWAP_COLOR_BYTES,
             }
     };
-    return lvgl_port_add_disp(&disp_cfg);
+    lv_disp_t *disp = lvgl_port_add_disp(&disp_cfg);
+
+    lvgl_port_lock(0);
+    ESP_ERROR_CHECK(lcd_tick_init(disp));
+    ESP_ERROR_CHECK(lcd_flush_init(disp, io_handle, panel_handle));
+    // the gap of unchanged rows the row hashes send along instead of another command sequence
+    uint32_t setup_ns;
+    uint32_t px_ns;
+    ESP_ERROR_CHECK(lcd_flush_measure_cost(&setup_ns, &px_ns));
+    ESP_LOGI(TAG, "Flush cost: %" PRIu32 " ns per flush, %" PRIu32 " ns per px", setup_ns, px_ns);
+    lcd_trace_init(disp);
+    lcd_latency_init(disp);
+    lcd_mem_draw_buf_init();
+    lcd_image_cache_init();
+    lcd_shadow_cache_init();
+    lcd_glyph_cache_init();
+    lcd_font_lut_init();
+    lvgl_port_unlock();
+
+    return disp;
 }
 
 void lcd_init(lv_disp_t **disp_handle, bool backlight_on) {
@@ -259,20 +264,29 @@ void lcd_init(lv_disp_t **disp_handle, bool backlight_on) {
     const lvgl_port_cfg_t lvgl_cfg = {
             .task_priority = LVGL_TASK_PRIORITY,
             .task_stack = LVGL_TASK_STACK_SIZE,
-            .task_affinity = 1,
+            .task_affinity = LVGL_TASK_AFFINITY,
             .task_max_sleep_ms = LVGL_MAX_SLEEP_MS,
             .timer_period_ms = LVGL_TICK_PERIOD_MS
 
     };
+#if LCD_SIMD_BLEND && CONFIG_TDISPLAYS3_BLEND_SELF_TEST
+    // a self-test, the kernels are compiled into LVGL whatever it finds
+    if (lcd_blend_check() != ESP_OK) {
+        ESP_LOGE(TAG, "SIMD blend kernels differ from LVGL's C path, disable CONFIG_LV_DRAW_SW_ASM_CUSTOM");
+    }
+#endif
     esp_err_t err = lvgl_port_init(&lvgl_cfg);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "error initializing lvgl port!");
     }
+    // with CONFIG_LV_OS_FREERTOS, lv_init() (run by the port task) has started one render thread per draw unit,
+    // unpinned, the LVGL task waits for them on core LVGL_TASK_AFFINITY
+    ESP_LOGI(TAG, "LVGL software rendering with %d draw unit(s)", LV_DRAW_SW_DRAW_UNIT_CNT);
 
     lcd_power_init();
     lcd_brightness_init();
 
-    init_battery_monitor();
+    ESP_ERROR_CHECK(battery_monitor_init());
 
     /* LCD IO */
     esp_lcd_panel_io_handle_t io_handle = NULL;
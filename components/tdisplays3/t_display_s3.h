@@ -29,11 +29,28 @@ extern "C" {
 #define LCD_PIN_NUM_RST            5   // LCD_RES
 
 #define LCD_BK_LIGHT_LEDC_CH       0
+// drive the AW9364 EN pin with its native pulse count dimming from the RMT (t_display_s3_aw9364.c) instead of the
+// LEDC PWM of the aw9364 component, the lcd_*brightness*() API stays the same. Timings of the pulse trains in
+// microseconds
+#define LCD_BK_LIGHT_RMT           1
+#define LCD_BK_LIGHT_PULSE_LOW_US  2     // one step down, 0.5 - 500 us low
+#define LCD_BK_LIGHT_PULSE_HIGH_US 2     // between pulses, > 0.5 us
+#define LCD_BK_LIGHT_INIT_US       40    // high after enabling the AW9364, it starts at step 16
+#define LCD_BK_LIGHT_OFF_US        3000  // low to shut down, > 2.5 ms
 
 // T-Display Battery Voltage
 #define BAT_PIN_NUM_VOLT           4     // (ADC_UNIT_1, ADC_CHANNEL_3) -  LCD_BAT_VOLT
 #define NO_BAT_MILLIVOLTS          4500  // greater than 4600 no battery connected
 #define BAT_CHARGE_MILLIVOLTS      4350  // greater than 4350 means charging
+// battery monitor, the divider is sampled by the ADC DMA at BAT_ADC_SAMPLE_FREQ_HZ and filtered per frame
+// (median of BAT_ADC_FRAME_SAMPLES samples, then an EMA with a weight of 1 / 2^BAT_EMA_SHIFT)
+#define BAT_ADC_SAMPLE_FREQ_HZ     1000
+#define BAT_ADC_FRAME_SAMPLES      128
+#define BAT_EMA_SHIFT              3
+#define BAT_FIRST_SAMPLE_TIMEOUT_MS 500
+#define BAT_MONITOR_TASK_STACK_SIZE (3 * 1024)
+#define BAT_MONITOR_TASK_PRIORITY  1
+#define BAT_MONITOR_TASK_AFFINITY  0
 // T-Display Buttons
 #define BTN_PIN_NUM_1              GPIO_NUM_0   // BOOT
 #define BTN_PIN_NUM_2              GPIO_NUM_14  // IO14
@@ -48,6 +65,9 @@ extern "C" {
 // The pixel number in horizontal and vertical
 #define LCD_H_RES              320
 #define LCD_V_RES              170
+// offset of the visible area in the ST7789 frame memory (240x320)
+#define LCD_X_GAP              0
+#define LCD_Y_GAP              35
 
 #define LCD_PWR_ON_LEVEL  1
 #define LCD_PWR_OFF_LEVEL !LCD_PWR_ON_LEVEL
@@ -60,9 +80,20 @@ extern "C" {
 // Number of LCD i80 data lines (0-7)
 #define LCD_I80_BUS_WIDTH      8
 
+// Stripes are copied from the PSRAM stripe buffers into two LCD_BOUNCE_BUFFER_SIZE internal SRAM buffers, the copy
+// of the next one overlapping the DMA of the other, so the i80 DMA never waits on PSRAM
+#define LCD_BOUNCE_BUFFER      1
+#define LCD_BOUNCE_BUFFER_SIZE (LCD_H_RES * 16 * sizeof(uint16_t))
+
+#if LCD_BOUNCE_BUFFER
+// the ST7789 is specified for a 66 ns write cycle (15 MHz), most panels run at 20-40 MHz,
+// lcd_flush_benchmark_sweep() shows what the bus achieves at the PCLK of the build
+#define LCD_PIXEL_CLOCK_HZ     (20 * 1000 * 1000)
+#else
 // PCLK frequency can't go too high as the limitation of PSRAM bandwidth
 // try 2-17
 #define LCD_PIXEL_CLOCK_HZ     (17 * 1000 * 1000)
+#endif
 
 #define LCD_I80_TRANS_QUEUE_SIZE 20
 #define LCD_I80_DC_CMD_LEVEL     0
@@ -70,6 +101,14 @@ extern "C" {
 #define LCD_I80_DC_DUMMY_LEVEL   0
 #define LCD_I80_DC_DATA_LEVEL    1
 
+// Swap the RGB565 color bytes in the i80 peripheral while the data is DMA'd,
+// instead of an extra lv_draw_sw_rgb565_swap() pass over the (PSRAM) LVGL buffer before every flush
+#define LCD_I80_SWAP_COLOR_BYTES 1
+
+// fills and RGB565 image blends are rendered by the esp_lvgl_port SIMD kernels (CONFIG_LV_DRAW_SW_ASM_CUSTOM, see
+// t_display_s3_lv_blend.h), with CONFIG_TDISPLAYS3_BLEND_SELF_TEST lcd_init checks them against LVGL's C path
+#define LCD_SIMD_BLEND (CONFIG_LV_DRAW_SW_ASM_CUSTOM && CONFIG_IDF_TARGET_ESP32S3)
+
 
 // Supported alignment: 16, 32, 64.
 // A higher alignment can enable higher burst transfer size, thus a higher i80 bus throughput.
@@ -81,13 +120,285 @@ extern "C" {
 
 // LVGL Timer options
 #define LVGL_TICK_PERIOD_MS    5
+// tickless: LVGL reads the time from esp_timer instead of the port's periodic tick timer, and the LVGL task sleeps
+// until the next LVGL timer is due or another task invalidates / starts something (see t_display_s3_tick.c)
+#define LVGL_TICKLESS          1
+#if LVGL_TICKLESS
+#define LVGL_MAX_SLEEP_MS      500 // only when no LVGL timer is running, the task is woken for anything new
+#else
 #define LVGL_MAX_SLEEP_MS      (LVGL_TICK_PERIOD_MS * 2) // this affects how fast the screen is refreshed
+#endif
 #define LVGL_TASK_STACK_SIZE   (4 * 1024)
 #define LVGL_TASK_PRIORITY     2
-
+#define LVGL_TASK_AFFINITY     1
+
+// number of stripe buffers LVGL renders into while the previous stripes are sent over the i80 bus (2-4)
+#define LVGL_STRIPE_BUFFER_COUNT  3
+
+// task feeding the rendered stripes to the i80 bus, pinned to core 0 as the LVGL task runs on core 1
+// its priority is above LVGL's render threads (tskIDLE_PRIORITY + LV_THREAD_PRIO_HIGH) when CONFIG_LV_OS_FREERTOS is
+// set, so a finished stripe is queued to the bus without waiting for a render thread's time slice on core 0
+#define LCD_FLUSH_TASK_STACK_SIZE (3 * 1024)
+#define LCD_FLUSH_TASK_PRIORITY   (LVGL_TASK_PRIORITY + 2)
+#define LCD_FLUSH_TASK_AFFINITY   0
+
+// row hashes of what the panel shows, rows of a stripe that would send the same pixels again are not flushed
+// (see t_display_s3_rowhash.c). Each band of LCD_ROW_HASH_ROWS rows keeps the hashes of the last LCD_ROW_HASH_SPANS
+// column spans flushed to it, a stripe is sent in up to LCD_ROW_HASH_MAX_SEGMENTS transfers
+#define LCD_ROW_HASH              1
+#define LCD_ROW_HASH_ROWS         1
+#define LCD_ROW_HASH_SPANS        4
+#define LCD_ROW_HASH_MAX_SEGMENTS 8
+
+// frame timing trace, number of events kept (power of 2)
+#define LCD_TRACE_RING_SIZE           512
+// trace histogram buckets are powers of 2 in microseconds, the first is < 64 us, the last >= 64 ms
+#define LCD_TRACE_HISTOGRAM_BUCKETS   12
+#define LCD_TRACE_HISTOGRAM_MIN_LOG2  6
+
+// input event channel (t_display_s3_input.c), rings of the producer tasks and events handed to the handler at once
+#define LCD_INPUT_MAX_RINGS            4
+#define LCD_INPUT_BATCH_SIZE           16
+
+// input latency probes, inputs followed at once and the latencies kept per metric
+#define LCD_LATENCY_MAX_PROBES         8
+#define LCD_LATENCY_SAMPLES            128
+
+// two-button navigation profile (t_display_s3_nav.c), hold time of a long press (enter) and key transitions queued
+// for the LVGL task (power of 2)
+#define LCD_NAV_LONG_PRESS_MS          500
+#define LCD_NAV_QUEUE_SIZE             16
+
+// LVGL image cache budget, decoded images up to LVGL_IMAGE_CACHE_SRAM_MAX_ENTRY bytes (icons) are kept in internal
+// SRAM until LVGL_IMAGE_CACHE_SRAM_SIZE is used up, everything else in PSRAM
+#define LVGL_IMAGE_CACHE_SRAM_SIZE      (32 * 1024)
+#define LVGL_IMAGE_CACHE_SRAM_MAX_ENTRY (8 * 1024)
+#define LVGL_IMAGE_CACHE_PSRAM_SIZE     (512 * 1024)
+// number of image headers (size and color format) kept by the LVGL image header cache
+#define LVGL_IMAGE_HEADER_CACHE_COUNT   32
+
+// number of blurred box shadow corners kept in PSRAM, each up to CONFIG_LV_DRAW_SW_SHADOW_CACHE_SIZE squared bytes
+#define LVGL_SHADOW_CACHE_COUNT        16
+
+// A8 glyph bitmaps kept in internal SRAM so redrawn text doesn't unpack the font data again
+#define LVGL_GLYPH_CACHE_SIZE          (16 * 1024)
+
+// fonts with Latin-1 / LV_SYMBOL glyph id tables (lcd_font_lut_register), each takes ~1.5 KB of internal SRAM
+#define LVGL_FONT_LUT_MAX_FONTS        8
+// symbol hash slots per font (power of 2), holds up to half as many symbols
+#define LVGL_FONT_LUT_SYMBOL_SLOTS     256
+// fonts with more kerning pairs keep LVGL's binary search
+#define LVGL_FONT_LUT_MAX_KERN_PAIRS   4096
+
+// flush pipeline stats of the last refreshed frame
+typedef struct {
+    uint32_t frame_count;     // frames refreshed since lcd_init
+    uint32_t stripes;         // stripes flushed in the frame
+    uint32_t render_wait_us;  // time LVGL waited for a free stripe buffer (DMA still running)
+    uint32_t bus_idle_us;     // time the i80 bus sat idle while the frame was being refreshed
+    uint32_t frame_time_us;   // refresh start to refresh ready
+    uint32_t copy_us;         // time spent copying the stripes into the SRAM bounce buffers
+} lcd_flush_stats_t;
+
+// full screen flushes timed by lcd_flush_benchmark()
+typedef struct {
+    uint32_t pclk_hz;
+    uint32_t chunk_bytes;     // bytes per transfer from the SRAM bounce buffers, 0: DMA straight from PSRAM
+    uint32_t fps;
+    uint32_t frame_us;        // one full screen
+    uint32_t copy_us;         // copying one full screen into the bounce buffers
+} lcd_flush_benchmark_t;
+
+// durations derived from the frame timing trace
+typedef enum {
+    LCD_TRACE_FRAME_TIME,     // refresh start to refresh ready
+    LCD_TRACE_RENDER_TIME,    // rendering of one area (stripe)
+    LCD_TRACE_FLUSH_LATENCY,  // flush_cb entry to i80 DMA done of the same stripe
+    // input events followed by the input latency probes (t_display_s3_latency.c), all from the input timestamp
+    LCD_TRACE_INPUT_TO_INVALIDATE, // first area the input invalidated
+    LCD_TRACE_INPUT_TO_RENDER,     // start of the refresh that renders it
+    LCD_TRACE_INPUT_TO_FLUSH,      // flush_cb of the first stripe showing it
+    LCD_TRACE_INPUT_TO_PHOTON,     // i80 DMA done of the last stripe showing it
+    LCD_TRACE_METRIC_MAX,
+} lcd_trace_metric_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t p50_us;
+    uint32_t p95_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+    uint32_t histogram[LCD_TRACE_HISTOGRAM_BUCKETS];
+} lcd_trace_stats_t;
+
+// filtered battery reading, published by the battery monitor a few times per second
+typedef struct {
+    int millivolts;
+    int percentage;
+    bool usb_power;
+    bool charging;
+} battery_info_t;
+
+// battery discharge curve, percentage[i] is the charge at min_millivolts + i * step_millivolts (non decreasing)
+typedef struct {
+    const char *name;
+    int min_millivolts;
+    int step_millivolts;
+    uint32_t count;
+    const uint8_t *percentage;
+} battery_discharge_curve_t;
+
+// default curve, 3.7 V LiPo / Li-ion cell
+extern const battery_discharge_curve_t battery_curve_lipo;
+
+// LVGL image and image header cache counters since lcd_init
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;            // images decoded and added to the cache
+    uint32_t evictions;
+    uint32_t header_hits;
+    uint32_t header_misses;
+    uint32_t header_evictions;
+    size_t cached_bytes;        // decoded image data held by the cache
+    size_t sram_bytes;          // decoded image data allocated in internal SRAM
+    size_t psram_bytes;         // decoded image data allocated in PSRAM
+} lcd_image_cache_stats_t;
+
+// box shadow corner cache counters since lcd_init
+typedef struct {
+    uint32_t hits;              // shadows drawn with a cached corner, clipped out shadows aren't counted
+    uint32_t misses;            // shadow corners blurred
+    uint32_t evictions;
+    uint32_t entries;
+} lcd_shadow_cache_stats_t;
+
+// glyph bitmap cache counters since lcd_init
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;            // glyphs unpacked from the font data
+    uint32_t evictions;
+    size_t cached_bytes;
+} lcd_glyph_cache_stats_t;
+
+// label text update counters since lcd_init
+typedef struct {
+    uint32_t set_text_calls;    // lv_label_set_text() / lv_label_set_text_fmt() calls
+    uint32_t skipped_updates;   // the label already showed the text
+    uint32_t partial_updates;   // only the changed letters were invalidated
+    uint32_t full_updates;      // the whole label was re-measured and invalidated
+    uint64_t invalidated_px;    // pixels invalidated by the updates (before clipping)
+} lcd_label_stats_t;
+
+// memory LVGL allocates from, the IDF heap of each (t_display_s3_mem.c)
+typedef enum {
+    LCD_MEM_POOL_SRAM,
+    LCD_MEM_POOL_PSRAM,
+    LCD_MEM_POOL_MAX,
+} lcd_mem_pool_t;
+
+typedef struct {
+    size_t total_bytes;
+    size_t free_bytes;
+    size_t min_free_bytes;      // low-water mark since boot
+    size_t largest_free_block;
+    uint32_t allocated_blocks;
+    uint32_t fallbacks;         // draw / glyph buffers that went to the other memory as this one was full
+} lcd_mem_pool_stats_t;
+
+// row hash counters since lcd_init
+typedef struct {
+    uint32_t stripes;           // stripes checked against the row hashes
+    uint32_t stripes_skipped;   // stripes the panel already showed, nothing was sent
+    uint32_t segments;          // transfers the changed rows were sent in
+    uint64_t bytes_rendered;    // pixel bytes of the checked stripes
+    uint64_t bytes_saved;       // pixel bytes not sent on the i80 bus
+} lcd_row_hash_stats_t;
+
+// LVGL task wakeups and idle time, over the last measurement period (about a second)
+typedef struct {
+    uint32_t wakeups_per_s;     // lv_timer_handler() runs
+    uint32_t event_wakes_per_s; // wakeups requested by other tasks (refresh requests of the display)
+    uint32_t tick_irqs_per_s;   // rate of the periodic tick timer (1000 / LVGL_TICK_PERIOD_MS), 0 when tickless
+    uint32_t idle_pct;          // idle time of the LVGL task's core (time outside lv_timer_handler() without
+                                // CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS)
+} lcd_tick_stats_t;
+
+// sources of input events, what id and value mean is up to the producer
+typedef enum {
+    LCD_INPUT_BUTTON,           // id: button, value: button event
+    LCD_INPUT_READING,          // a hw reading changed (battery, brightness, ...), id: which one, value: new value
+    LCD_INPUT_TIMER,
+    LCD_INPUT_USER,
+} lcd_input_type_t;
+
+// input event, 16 bytes
+typedef struct {
+    int64_t time_us;            // esp_timer time of lcd_input_post()
+    uint8_t type;               // lcd_input_type_t
+    uint8_t id;
+    int32_t value;
+} lcd_input_event_t;
+
+// single producer / single consumer ring of input events
+typedef struct lcd_input_ring_t *lcd_input_ring_handle_t;
+
+// called by lcd_input_drain() under lvgl_port_lock, with up to LCD_INPUT_BATCH_SIZE events of one ring in post order
+typedef void (*lcd_input_handler_t)(const lcd_input_event_t *events, uint32_t count, void *user_data);
+
+// input channel counters since boot
+typedef struct {
+    uint32_t posted;
+    uint32_t dropped;           // posts to a full ring
+    uint32_t handled;
+    uint32_t drains;            // lcd_input_drain() runs that took the LVGL lock
+    uint32_t batches;           // handler calls
+    uint32_t max_batch;
+    uint32_t avg_latency_us;    // post to handler call
+    uint32_t max_latency_us;
+} lcd_input_stats_t;
 
 void lcd_init(lv_disp_t **disp_handle, bool backlight_on);
 
+void lcd_get_flush_stats(lcd_flush_stats_t *stats);
+
+esp_err_t lcd_flush_benchmark(uint32_t chunk_bytes, uint32_t frames, lcd_flush_benchmark_t *result);
+
+void lcd_flush_benchmark_sweep(void);
+
+#if LCD_SIMD_BLEND
+esp_err_t lcd_blend_check(void);
+
+void lcd_blend_benchmark(void);
+#endif
+
+void lcd_get_row_hash_stats(lcd_row_hash_stats_t *stats);
+
+void lcd_get_tick_stats(lcd_tick_stats_t *stats);
+
+esp_err_t lcd_trace_get_stats(lcd_trace_metric_t metric, lcd_trace_stats_t *stats);
+
+// print the stats and histograms of all trace metrics to the console
+void lcd_trace_dump(void);
+
+void lcd_get_image_cache_stats(lcd_image_cache_stats_t *stats);
+
+void lcd_get_shadow_cache_stats(lcd_shadow_cache_stats_t *stats);
+
+void lcd_get_glyph_cache_stats(lcd_glyph_cache_stats_t *stats);
+
+// drop the cached glyphs of a font, call under lvgl_port_lock before freeing a font created at run time (e.g. by
+// lv_binfont_create())
+void lcd_glyph_cache_drop_font(const lv_font_t *font);
+
+// build the glyph id / kerning tables of an LVGL fmt_txt font (e.g. a SquareLine font), call under lvgl_port_lock,
+// the enabled Montserrat fonts are registered by lcd_init
+esp_err_t lcd_font_lut_register(const lv_font_t *font);
+
+void lcd_get_label_stats(lcd_label_stats_t *stats);
+
+esp_err_t lcd_get_mem_pool_stats(lcd_mem_pool_t pool, lcd_mem_pool_stats_t *stats);
+
 void lcd_set_brightness_step(uint8_t brightness_step);
 
 void lcd_set_brightness_step_fade(uint8_t brightness_step, uint32_t fade_time_ms);
@@ -104,10 +415,41 @@ uint8_t lcd_get_brightness_step();
 
 uint8_t lcd_get_brightness_pct();
 
+// create the ring of one producer task, size is a power of 2 (up to LCD_INPUT_MAX_RINGS rings)
+esp_err_t lcd_input_ring_create(uint32_t size, lcd_input_ring_handle_t *ret_ring);
+
+// timestamp and queue an event from the ring's producer task, never blocks, returns false (and drops the event) when
+// the ring is full
+bool lcd_input_post(lcd_input_ring_handle_t ring, lcd_input_type_t type, uint8_t id, int32_t value);
+
+// lcd_input_post() with the esp_timer time the input happened, e.g. the edge of a debounced button press
+bool lcd_input_post_at(lcd_input_ring_handle_t ring, lcd_input_type_t type, uint8_t id, int32_t value, int64_t time_us);
+
+// consumer: wait up to timeout_ms for events (portMAX_DELAY: forever), then hand the events of all rings to the handler
+// under one lvgl_port_lock, returns the number of events handled. Always called from the same task
+uint32_t lcd_input_drain(lcd_input_handler_t handler, void *user_data, uint32_t timeout_ms);
+
+void lcd_input_get_stats(lcd_input_stats_t *stats);
+
+// follow the input handled between these calls (under lvgl_port_lock) to the pixels it changes, input_us is the
+// esp_timer time of the input. lcd_input_drain() does this for the batches with LCD_INPUT_BUTTON events, the latencies
+// are reported by lcd_trace_get_stats() (LCD_TRACE_INPUT_*)
+void lcd_latency_input_begin(int64_t input_us);
+
+void lcd_latency_input_end(void);
+
+// latest battery reading, these never touch the ADC
+void get_battery_info(battery_info_t *info);
+
 int get_battery_voltage();
 
 int get_battery_percentage();
 
+// use another discharge curve (cell chemistry) for the battery percentage, the curve must stay valid
+void battery_set_discharge_curve(const battery_discharge_curve_t *curve);
+
+int millivolts_to_percentage(int millivolts);
+
 double volts_to_percentage(double volts);
 
 bool usb_power_voltage(int milliVolts);
@@ -0,0 +1,226 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// AW9364 pulse count dimming
+//
+// The aw9364 component runs a 5 kHz LEDC PWM on the EN pin of the AW9364 and maps the 16 steps onto duty cycles. The
+// AW9364 is a one-wire dimmer with 16 native levels though:
+//  - EN low for more than 2.5 ms shuts it down (step 0),
+//  - the first rising edge after that turns it on at step 16,
+//  - every low pulse (0.5 - 500 us) after that is one step down, step 1 wraps around to 16.
+// With LCD_BK_LIGHT_RMT the lcd_*brightness*() functions of t_display_s3.c drive the AW9364 through this backend
+// instead of the aw9364 component, and a step change is one RMT transmission of the pulses from the current step to
+// the new one (lcd_aw9364_pulse_train()), EN then stays at the end of transmission level: no PWM, no LEDC timer and
+// no fade interrupts. A fade is one step per fade_time_ms / steps from an esp_timer. The esp_timer task also runs the
+// button timers, so the fade callback never waits for the RMT: the symbols of a train are in use until its
+// on_trans_done callback, a fade step due before that is sent on the next timer period.
+
+#include <stdlib.h>
+#include <esp_log.h>
+#include <esp_check.h>
+#include <esp_timer.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "driver/rmt_tx.h"
+#include "aw9364.h"
+#include "t_display_s3.h"
+#include "t_display_s3_priv.h"
+
+#if LCD_BK_LIGHT_RMT
+
+static const char *TAG = "esp_idf_t_display_s3_aw9364";
+
+// 1 us RMT ticks
+#define LCD_AW9364_RESOLUTION_HZ  (1000 * 1000)
+// enable + 15 pulses
+#define LCD_AW9364_MAX_SYMBOLS    AW9364_MAX_BRIGHTNESS_STEPS
+// longest train (3 ms off) still on the wire when a step is set through the API
+#define LCD_AW9364_TX_TIMEOUT_MS  10
+
+typedef struct {
+    rmt_channel_handle_t channel;
+    rmt_encoder_handle_t encoder;
+    esp_timer_handle_t fade_timer;
+    SemaphoreHandle_t lock;         // serializes the transmissions, held while the step on EN is updated
+    SemaphoreHandle_t tx_idle;      // given by on_trans_done when symbols can be rewritten
+    rmt_symbol_word_t symbols[LCD_AW9364_MAX_SYMBOLS];
+    uint8_t brightness_step;        // step set through the API, the target of a fade
+    uint8_t output_step;            // step EN was pulsed to
+    int8_t fade_dir;
+} lcd_aw9364_t;
+
+static lcd_aw9364_t aw9364;
+
+// the RMT symbols that take the AW9364 from one step to another, returns the number of symbols (0: nothing to send)
+static size_t lcd_aw9364_pulse_train(uint8_t from_step, uint8_t to_step, rmt_symbol_word_t *symbols) {
+    size_t count = 0;
+    if (from_step == to_step) {
+        return 0;
+    }
+    if (to_step == 0) {
+        symbols[count++] = (rmt_symbol_word_t) {
+                .level0 = 0,
+                .duration0 = LCD_BK_LIGHT_OFF_US / 2,
+                .level1 = 0,
+                .duration1 = LCD_BK_LIGHT_OFF_US - LCD_BK_LIGHT_OFF_US / 2,
+        };
+        return count;
+    }
+    if (from_step == 0) {
+        // the rising edge turns it on at the highest step
+        symbols[count++] = (rmt_symbol_word_t) {
+                .level0 = 1,
+                .duration0 = LCD_BK_LIGHT_INIT_US / 2,
+                .level1 = 1,
+                .duration1 = LCD_BK_LIGHT_INIT_US - LCD_BK_LIGHT_INIT_US / 2,
+        };
+        from_step = AW9364_MAX_BRIGHTNESS_STEPS;
+    }
+    uint32_t pulses = (from_step - to_step + AW9364_MAX_BRIGHTNESS_STEPS) % AW9364_MAX_BRIGHTNESS_STEPS;
+    for (uint32_t i = 0; i < pulses; i++) {
+        symbols[count++] = (rmt_symbol_word_t) {
+                .level0 = 0,
+                .duration0 = LCD_BK_LIGHT_PULSE_LOW_US,
+                .level1 = 1,
+                .duration1 = LCD_BK_LIGHT_PULSE_HIGH_US,
+        };
+    }
+    return count;
+}
+
+static bool lcd_aw9364_tx_done_cb(rmt_channel_handle_t channel, const rmt_tx_done_event_data_t *edata, void *user_ctx) {
+    lcd_aw9364_t *dev = (lcd_aw9364_t *) user_ctx;
+    BaseType_t need_yield = pdFALSE;
+    xSemaphoreGiveFromISR(dev->tx_idle, &need_yield);
+    return need_yield == pdTRUE;
+}
+
+// queue the pulses from the step on EN to another step, waits up to wait ticks for the last train to be sent.
+// Called with dev->lock held, returns ESP_ERR_TIMEOUT while the last train is still being sent
+static esp_err_t lcd_aw9364_output(lcd_aw9364_t *dev, uint8_t step, TickType_t wait) {
+    if (step == dev->output_step) {
+        return ESP_OK;
+    }
+    if (xSemaphoreTake(dev->tx_idle, wait) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+    size_t count = lcd_aw9364_pulse_train(dev->output_step, step, dev->symbols);
+    rmt_transmit_config_t tx_config = {
+            .flags.eot_level = step > 0,
+    };
+    esp_err_t ret = rmt_transmit(dev->channel, dev->encoder, dev->symbols, count * sizeof(rmt_symbol_word_t),
+                                 &tx_config);
+    if (ret != ESP_OK) {
+        xSemaphoreGive(dev->tx_idle);
+        ESP_LOGE(TAG, "transmit pulses failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    // the next train starts from the step this one ends at
+    dev->output_step = step;
+    return ESP_OK;
+}
+
+// runs in the esp_timer task, shared with the button timers: nothing in here waits
+static void lcd_aw9364_fade_timer_cb(void *arg) {
+    lcd_aw9364_t *dev = (lcd_aw9364_t *) arg;
+    if (xSemaphoreTake(dev->lock, 0) != pdTRUE) {
+        // the step is being set through the API, which stops the fade
+        return;
+    }
+    if (dev->fade_dir != 0 && dev->output_step != dev->brightness_step) {
+        // a step that can't be sent yet is sent on the next period
+        lcd_aw9364_output(dev, dev->output_step + dev->fade_dir, 0);
+    }
+    if (dev->output_step == dev->brightness_step) {
+        dev->fade_dir = 0;
+        esp_timer_stop(dev->fade_timer);
+    }
+    xSemaphoreGive(dev->lock);
+}
+
+esp_err_t lcd_aw9364_init(int en_gpio_num) {
+    lcd_aw9364_t *dev = &aw9364;
+    esp_err_t ret = ESP_OK;
+    dev->lock = xSemaphoreCreateMutex();
+    ESP_GOTO_ON_FALSE(dev->lock, ESP_ERR_NO_MEM, err, TAG, "no memory for aw9364 lock");
+    dev->tx_idle = xSemaphoreCreateBinary();
+    ESP_GOTO_ON_FALSE(dev->tx_idle, ESP_ERR_NO_MEM, err, TAG, "no memory for aw9364 semaphore");
+    xSemaphoreGive(dev->tx_idle);
+    // EN idles low, the AW9364 stays off until the first step is set
+    rmt_tx_channel_config_t channel_cfg = {
+            .gpio_num = en_gpio_num,
+            .clk_src = RMT_CLK_SRC_DEFAULT,
+            .resolution_hz = LCD_AW9364_RESOLUTION_HZ,
+            .mem_block_symbols = 48,
+            .trans_queue_depth = 1,
+    };
+    ESP_GOTO_ON_ERROR(rmt_new_tx_channel(&channel_cfg, &dev->channel), err, TAG, "create rmt channel failed");
+    rmt_copy_encoder_config_t encoder_cfg = {};
+    ESP_GOTO_ON_ERROR(rmt_new_copy_encoder(&encoder_cfg, &dev->encoder), err, TAG, "create rmt encoder failed");
+    const rmt_tx_event_callbacks_t cbs = {
+            .on_trans_done = lcd_aw9364_tx_done_cb,
+    };
+    ESP_GOTO_ON_ERROR(rmt_tx_register_event_callbacks(dev->channel, &cbs, dev), err, TAG,
+                      "register rmt callbacks failed");
+    ESP_GOTO_ON_ERROR(rmt_enable(dev->channel), err, TAG, "enable rmt channel failed");
+    const esp_timer_create_args_t fade_timer_args = {
+            .callback = lcd_aw9364_fade_timer_cb,
+            .arg = dev,
+            .name = "aw9364_fade",
+    };
+    ESP_GOTO_ON_ERROR(esp_timer_create(&fade_timer_args, &dev->fade_timer), err, TAG, "create fade timer failed");
+    return ESP_OK;
+
+err:
+    if (dev->channel) {
+        rmt_disable(dev->channel);
+        rmt_del_channel(dev->channel);
+    }
+    if (dev->encoder) {
+        rmt_del_encoder(dev->encoder);
+    }
+    if (dev->tx_idle) {
+        vSemaphoreDelete(dev->tx_idle);
+    }
+    if (dev->lock) {
+        vSemaphoreDelete(dev->lock);
+    }
+    *dev = (lcd_aw9364_t) {0};
+    return ret;
+}
+
+esp_err_t lcd_aw9364_set_step(uint8_t step, uint32_t fade_time_ms) {
+    lcd_aw9364_t *dev = &aw9364;
+    ESP_RETURN_ON_FALSE(dev->lock, ESP_ERR_INVALID_STATE, TAG, "aw9364 not initialized");
+    if (step > AW9364_MAX_BRIGHTNESS_STEPS) {
+        step = AW9364_MAX_BRIGHTNESS_STEPS;
+    }
+    if (fade_time_ms > AW9364_MAX_FADE_TIME_MS) {
+        fade_time_ms = AW9364_MAX_FADE_TIME_MS;
+    }
+
+    esp_err_t ret = ESP_OK;
+    xSemaphoreTake(dev->lock, portMAX_DELAY);
+    esp_timer_stop(dev->fade_timer);
+    dev->fade_dir = 0;
+    dev->brightness_step = step;
+    uint32_t steps = abs((int) step - (int) dev->output_step);
+    if (fade_time_ms > AW9364_MIN_FADE_TIME_MS && steps > 1) {
+        // first step now, the rest from the fade timer
+        dev->fade_dir = step > dev->output_step ? 1 : -1;
+        ret = lcd_aw9364_output(dev, dev->output_step + dev->fade_dir, pdMS_TO_TICKS(LCD_AW9364_TX_TIMEOUT_MS));
+        if (ret == ESP_OK) {
+            ret = esp_timer_start_periodic(dev->fade_timer, (uint64_t) fade_time_ms * 1000 / steps);
+        }
+    } else {
+        ret = lcd_aw9364_output(dev, step, pdMS_TO_TICKS(LCD_AW9364_TX_TIMEOUT_MS));
+    }
+    xSemaphoreGive(dev->lock);
+    return ret;
+}
+
+uint8_t lcd_aw9364_get_step(void) {
+    return aw9364.brightness_step;
+}
+
+#endif // LCD_BK_LIGHT_RMT
@@ -0,0 +1,291 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Battery monitor
+//
+// The battery voltage divider (BAT_PIN_NUM_VOLT) is sampled by the ADC continuous (DMA) driver. For every frame of
+// BAT_ADC_FRAME_SAMPLES samples the battery monitor task takes the median, which drops the spikes of the noisy
+// divider, and feeds it to a fixed point EMA. The filtered reading is calibrated, converted to mV / % / usb / charging
+// once per frame and published through a seqlock, so get_battery_info() and friends only copy the last snapshot and
+// never touch the ADC.
+
+#include <math.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <esp_log.h>
+#include <esp_check.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_adc/adc_continuous.h"
+#include "esp_adc/adc_cali_scheme.h"
+#include "soc/soc_caps.h"
+#include "t_display_s3.h"
+#include "t_display_s3_priv.h"
+
+static const char *TAG = "esp_idf_t_display_s3_battery";
+
+#define BAT_ADC_UNIT     ADC_UNIT_1
+#define BAT_ADC_CHANNEL  ADC_CHANNEL_3
+#define BAT_ADC_ATTEN    ADC_ATTEN_DB_12
+
+// the EMA keeps the raw reading with 8 fractional bits
+#define BAT_EMA_FRAC_BITS 8
+
+typedef struct {
+    adc_continuous_handle_t adc_handle;
+    adc_cali_handle_t adc_cali_handle;
+    TaskHandle_t task;
+    uint8_t frame[BAT_ADC_FRAME_SAMPLES * SOC_ADC_DIGI_RESULT_BYTES];
+    uint16_t samples[BAT_ADC_FRAME_SAMPLES];
+    int32_t ema_q8;
+    // seqlock, odd while the battery monitor task is writing the snapshot
+    atomic_uint seq;
+    battery_info_t info;
+} battery_monitor_ctx_t;
+
+static battery_monitor_ctx_t battery_ctx;
+
+// 3.7 V LiPo / Li-ion cell, sampled every 50 mV from 123 - 123 / (1 + (V / 3.7)^80)^0.165
+// (https://electronics.stackexchange.com/a/551667) and clamped to 0-100 %,
+// interpolated it stays within 1.1 % of the equation between 3000 and 4500 mV (generated by
+// tools/gen_battery_curve.py, checked by host_sim)
+static const uint8_t battery_curve_lipo_pct[] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0,                   // 3000 - 3450 mV
+        0, 1, 2, 6, 13, 25, 38, 51, 62, 71,             // 3500 - 3950 mV
+        79, 86, 91, 96, 100, 100, 100, 100, 100, 100,   // 4000 - 4450 mV
+        100,                                            // 4500 mV
+};
+
+const battery_discharge_curve_t battery_curve_lipo = {
+        .name = "LiPo 3.7V",
+        .min_millivolts = 3000,
+        .step_millivolts = 50,
+        .count = sizeof(battery_curve_lipo_pct),
+        .percentage = battery_curve_lipo_pct,
+};
+
+static _Atomic(const battery_discharge_curve_t *) discharge_curve = &battery_curve_lipo;
+
+static bool battery_adc_conv_done_cb(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata,
+                                     void *user_data) {
+    BaseType_t need_yield = pdFALSE;
+    vTaskNotifyGiveFromISR(battery_ctx.task, &need_yield);
+    return need_yield == pdTRUE;
+}
+
+// median of the samples (quickselect, reorders them)
+static uint16_t battery_samples_median(uint16_t *samples, int count) {
+    int k = count / 2;
+    int lo = 0;
+    int hi = count - 1;
+    uint16_t tmp;
+    while (lo < hi) {
+        // partition around the middle sample, moved to the end of the range
+        int mid = (lo + hi) / 2;
+        tmp = samples[mid];
+        samples[mid] = samples[hi];
+        samples[hi] = tmp;
+        uint16_t pivot = samples[hi];
+        int store = lo;
+        for (int i = lo; i < hi; i++) {
+            if (samples[i] < pivot) {
+                tmp = samples[i];
+                samples[i] = samples[store];
+                samples[store] = tmp;
+                store++;
+            }
+        }
+        samples[hi] = samples[store];
+        samples[store] = pivot;
+
+        if (k == store) {
+            break;
+        } else if (k < store) {
+            hi = store - 1;
+        } else {
+            lo = store + 1;
+        }
+    }
+    return samples[k];
+}
+
+static void battery_publish(int millivolts) {
+    battery_info_t info = {
+            .millivolts = millivolts,
+            .percentage = millivolts_to_percentage(millivolts),
+            .usb_power = usb_power_voltage(millivolts),
+            .charging = millivolts > BAT_CHARGE_MILLIVOLTS && millivolts <= NO_BAT_MILLIVOLTS,
+    };
+
+    atomic_fetch_add_explicit(&battery_ctx.seq, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    battery_ctx.info = info;
+    atomic_fetch_add_explicit(&battery_ctx.seq, 1, memory_order_release);
+}
+
+// filter one DMA frame, returns false when it held no battery samples
+static bool battery_filter_frame(uint32_t frame_bytes) {
+    int count = 0;
+    for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= frame_bytes; i += SOC_ADC_DIGI_RESULT_BYTES) {
+        const adc_digi_output_data_t *p = (const adc_digi_output_data_t *) &battery_ctx.frame[i];
+        if (p->type2.channel == BAT_ADC_CHANNEL) {
+            battery_ctx.samples[count++] = p->type2.data;
+        }
+    }
+    if (count == 0) {
+        return false;
+    }
+
+    int32_t median_q8 = (int32_t) battery_samples_median(battery_ctx.samples, count) << BAT_EMA_FRAC_BITS;
+    if (atomic_load_explicit(&battery_ctx.seq, memory_order_relaxed) == 0) {
+        // first frame, nothing to average with yet
+        battery_ctx.ema_q8 = median_q8;
+    } else {
+        battery_ctx.ema_q8 += (median_q8 - battery_ctx.ema_q8) >> BAT_EMA_SHIFT;
+    }
+    return true;
+}
+
+static void battery_monitor_task(void *arg) {
+    uint32_t frame_bytes = 0;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        // drain every frame the driver has buffered, only the last filtered value is published
+        bool updated = false;
+        while (adc_continuous_read(battery_ctx.adc_handle, battery_ctx.frame, sizeof(battery_ctx.frame),
+                                   &frame_bytes, 0) == ESP_OK) {
+            updated |= battery_filter_frame(frame_bytes);
+        }
+        if (!updated) {
+            continue;
+        }
+
+        int raw = (battery_ctx.ema_q8 + (1 << (BAT_EMA_FRAC_BITS - 1))) >> BAT_EMA_FRAC_BITS;
+        int voltage = 0;
+        if (adc_cali_raw_to_voltage(battery_ctx.adc_cali_handle, raw, &voltage) == ESP_OK) {
+            // the battery voltage is halved by the divider
+            battery_publish(voltage * 2);
+        }
+    }
+
+    // a freeRTOS task should never return ^^^
+}
+
+esp_err_t battery_monitor_init(void) {
+    ESP_LOGI(TAG, "Configuring battery monitor...");
+
+    // ESP32-S3 supports Curve Fitting calibration scheme
+    const adc_cali_curve_fitting_config_t cali_config = {
+            .unit_id = BAT_ADC_UNIT,
+            .atten = BAT_ADC_ATTEN,
+            .bitwidth = SOC_ADC_DIGI_MAX_BITWIDTH,
+    };
+    ESP_RETURN_ON_ERROR(adc_cali_create_scheme_curve_fitting(&cali_config, &battery_ctx.adc_cali_handle), TAG,
+                        "create adc calibration failed");
+
+    const adc_continuous_handle_cfg_t adc_cfg = {
+            .max_store_buf_size = 2 * sizeof(battery_ctx.frame),
+            .conv_frame_size = sizeof(battery_ctx.frame),
+    };
+    ESP_RETURN_ON_ERROR(adc_continuous_new_handle(&adc_cfg, &battery_ctx.adc_handle), TAG, "create adc failed");
+
+    adc_digi_pattern_config_t adc_pattern = {
+            .atten = BAT_ADC_ATTEN,
+            .channel = BAT_ADC_CHANNEL,
+            .unit = BAT_ADC_UNIT,
+            .bit_width = SOC_ADC_DIGI_MAX_BITWIDTH,
+    };
+    const adc_continuous_config_t dig_cfg = {
+            .pattern_num = 1,
+            .adc_pattern = &adc_pattern,
+            .sample_freq_hz = BAT_ADC_SAMPLE_FREQ_HZ,
+            .conv_mode = ADC_CONV_SINGLE_UNIT_1,
+            .format = ADC_DIGI_OUTPUT_FORMAT_TYPE2,
+    };
+    ESP_RETURN_ON_ERROR(adc_continuous_config(battery_ctx.adc_handle, &dig_cfg), TAG, "configure adc failed");
+
+    BaseType_t res = xTaskCreatePinnedToCore(battery_monitor_task, "battery_monitor", BAT_MONITOR_TASK_STACK_SIZE,
+                                             NULL, BAT_MONITOR_TASK_PRIORITY, &battery_ctx.task,
+                                             BAT_MONITOR_TASK_AFFINITY);
+    ESP_RETURN_ON_FALSE(res == pdPASS, ESP_ERR_NO_MEM, TAG, "create battery monitor task failed");
+
+    const adc_continuous_evt_cbs_t cbs = {
+            .on_conv_done = battery_adc_conv_done_cb,
+    };
+    ESP_RETURN_ON_ERROR(adc_continuous_register_event_callbacks(battery_ctx.adc_handle, &cbs, NULL), TAG,
+                        "register adc callbacks failed");
+    ESP_RETURN_ON_ERROR(adc_continuous_start(battery_ctx.adc_handle), TAG, "start adc failed");
+
+    // wait for the first frame so the readers never see an empty snapshot
+    for (int i = 0; i < BAT_FIRST_SAMPLE_TIMEOUT_MS / 10; i++) {
+        if (atomic_load_explicit(&battery_ctx.seq, memory_order_acquire) != 0) {
+            return ESP_OK;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    ESP_LOGW(TAG, "no battery reading after %d ms", BAT_FIRST_SAMPLE_TIMEOUT_MS);
+    return ESP_OK;
+}
+
+void get_battery_info(battery_info_t *info) {
+    unsigned seq_start;
+    unsigned seq_end;
+    do {
+        seq_start = atomic_load_explicit(&battery_ctx.seq, memory_order_acquire);
+        *info = battery_ctx.info;
+        atomic_thread_fence(memory_order_acquire);
+        seq_end = atomic_load_explicit(&battery_ctx.seq, memory_order_relaxed);
+    } while ((seq_start & 1) || seq_start != seq_end);
+}
+
+int get_battery_voltage() {
+    battery_info_t info;
+    get_battery_info(&info);
+    return info.millivolts;
+}
+
+void battery_set_discharge_curve(const battery_discharge_curve_t *curve) {
+    atomic_store(&discharge_curve, curve);
+    ESP_LOGI(TAG, "Battery discharge curve: %s", curve->name);
+}
+
+int millivolts_to_percentage(int millivolts) {
+    const battery_discharge_curve_t *curve = atomic_load(&discharge_curve);
+
+    int offset = millivolts - curve->min_millivolts;
+    if (offset <= 0) {
+        return curve->percentage[0];
+    }
+    uint32_t idx = offset / curve->step_millivolts;
+    if (idx >= curve->count - 1) {
+        return curve->percentage[curve->count - 1];
+    }
+
+    // linear interpolation between the two closest points, rounded
+    int lo = curve->percentage[idx];
+    int hi = curve->percentage[idx + 1];
+    int rem = offset - (int) idx * curve->step_millivolts;
+    return lo + ((hi - lo) * rem + curve->step_millivolts / 2) / curve->step_millivolts;
+}
+
+double volts_to_percentage(double volts) {
+    return millivolts_to_percentage((int) (volts * 1000));
+}
+
+int get_battery_percentage() {
+    battery_info_t info;
+    get_battery_info(&info);
+    return info.percentage;
+}
+
+bool usb_power_voltage(int milliVolts) {
+    return ceilf((float) (milliVolts - 100) / 1000) == 5.0;
+}
+
+bool usb_power_connected() {
+    battery_info_t info;
+    get_battery_info(&info);
+    return info.usb_power;
+}
@@ -0,0 +1,200 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Interrupt-driven GPIO buttons
+//
+// espressif/button runs its debounce and state machine from a periodic esp_timer every CONFIG_BUTTON_PERIOD_TIME_MS,
+// reading the GPIO of every button even when nobody touches the board. Its power save mode already stops that timer
+// once all buttons are idle (BUTTON_NONE_PRESS, nothing left to debounce) and hands each button to
+// enter_power_save(), button_edge_new_gpio_device() uses this to scan only while a button is pressed:
+//  - the GPIO interrupt of a button is enabled for its active level, the ISR disables it and starts the button timer
+//    (iot_button_resume()), so the first edge arms the timer and the bounces after it cost nothing,
+//  - when the timer went idle, enter_power_save() enables the interrupt again. It is level triggered, a press that
+//    came between the last scan and this fires right away instead of being missed like an edge would be.
+// Unlike the power save mode of button_gpio.c, the pins are not made light sleep wakeup sources.
+//
+// With the timer only running during presses, CONFIG_BUTTON_PERIOD_TIME_MS can be shorter than the idle scan rate a
+// polled button could afford (see sdkconfig.defaults), a press is reported CONFIG_BUTTON_DEBOUNCE_TICKS scans after
+// its edge. The time of that edge is kept for button_edge_take_press_time_us(), so a press can be timestamped when the
+// finger went down rather than when the debounce was done with it.
+
+#include <stdlib.h>
+#include <esp_log.h>
+#include <esp_check.h>
+#include <esp_timer.h>
+#include "freertos/FreeRTOS.h"
+#include "driver/gpio.h"
+#include "button_interface.h"
+#include "t_display_s3_button.h"
+
+static const char *TAG = "esp_idf_t_display_s3_button";
+
+typedef struct {
+    button_driver_t base;
+    gpio_num_t gpio_num;
+    uint8_t active_level;
+    button_handle_t handle;
+    int64_t edge_us;            // interrupt of the last press, 0: taken
+} button_edge_obj_t;
+
+typedef struct {
+    bool armed;                 // the button timer runs
+    int64_t armed_at_us;
+    button_edge_obj_t *buttons[BUTTON_EDGE_MAX_BUTTONS];
+    button_edge_stats_t stats;
+} button_edge_ctx_t;
+
+static button_edge_ctx_t edge_ctx;
+static portMUX_TYPE edge_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void button_edge_isr(void *arg) {
+    button_edge_obj_t *btn = (button_edge_obj_t *) arg;
+    gpio_intr_disable(btn->gpio_num);
+    int64_t now_us = esp_timer_get_time();
+
+    portENTER_CRITICAL_ISR(&edge_lock);
+    edge_ctx.stats.edges++;
+    btn->edge_us = now_us;
+    bool arm = !edge_ctx.armed;
+    if (arm) {
+        edge_ctx.armed = true;
+        edge_ctx.armed_at_us = now_us;
+        edge_ctx.stats.arms++;
+    }
+    portEXIT_CRITICAL_ISR(&edge_lock);
+
+    if (arm) {
+        iot_button_resume();
+    }
+}
+
+static uint8_t button_edge_get_key_level(button_driver_t *button_driver) {
+    button_edge_obj_t *btn = __containerof(button_driver, button_edge_obj_t, base);
+    portENTER_CRITICAL(&edge_lock);
+    edge_ctx.stats.level_reads++;
+    portEXIT_CRITICAL(&edge_lock);
+    return gpio_get_level(btn->gpio_num) == btn->active_level ? 1 : 0;
+}
+
+// the button timer stopped, called for every button
+static esp_err_t button_edge_enter_power_save(button_driver_t *button_driver) {
+    button_edge_obj_t *btn = __containerof(button_driver, button_edge_obj_t, base);
+    portENTER_CRITICAL(&edge_lock);
+    if (edge_ctx.armed) {
+        edge_ctx.armed = false;
+        edge_ctx.stats.armed_us += esp_timer_get_time() - edge_ctx.armed_at_us;
+    }
+    portEXIT_CRITICAL(&edge_lock);
+    return gpio_intr_enable(btn->gpio_num);
+}
+
+static void button_edge_release_slot(button_edge_obj_t *btn) {
+    portENTER_CRITICAL(&edge_lock);
+    for (int i = 0; i < BUTTON_EDGE_MAX_BUTTONS; i++) {
+        if (edge_ctx.buttons[i] == btn) {
+            edge_ctx.buttons[i] = NULL;
+        }
+    }
+    portEXIT_CRITICAL(&edge_lock);
+}
+
+static esp_err_t button_edge_del(button_driver_t *button_driver) {
+    button_edge_obj_t *btn = __containerof(button_driver, button_edge_obj_t, base);
+    gpio_isr_handler_remove(btn->gpio_num);
+    button_edge_release_slot(btn);
+    esp_err_t ret = gpio_reset_pin(btn->gpio_num);
+    free(btn);
+    return ret;
+}
+
+esp_err_t button_edge_new_gpio_device(const button_config_t *button_config, const button_gpio_config_t *gpio_cfg,
+                                      button_handle_t *ret_button) {
+    ESP_RETURN_ON_FALSE(button_config && gpio_cfg && ret_button, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(GPIO_IS_VALID_GPIO(gpio_cfg->gpio_num), ESP_ERR_INVALID_ARG, TAG, "invalid gpio num");
+    ESP_RETURN_ON_FALSE(!gpio_cfg->enable_power_save, ESP_ERR_NOT_SUPPORTED, TAG,
+                        "power save is not supported in edge mode");
+
+    button_edge_obj_t *btn = calloc(1, sizeof(button_edge_obj_t));
+    ESP_RETURN_ON_FALSE(btn, ESP_ERR_NO_MEM, TAG, "no memory for button");
+    // the slot button_edge_take_press_time_us() finds the button in
+    bool slot_found = false;
+    portENTER_CRITICAL(&edge_lock);
+    for (int i = 0; i < BUTTON_EDGE_MAX_BUTTONS && !slot_found; i++) {
+        if (edge_ctx.buttons[i] == NULL) {
+            edge_ctx.buttons[i] = btn;
+            slot_found = true;
+        }
+    }
+    portEXIT_CRITICAL(&edge_lock);
+    if (!slot_found) {
+        free(btn);
+        ESP_LOGE(TAG, "gpio %d: already %d buttons in edge mode (BUTTON_EDGE_MAX_BUTTONS)", (int) gpio_cfg->gpio_num,
+                 BUTTON_EDGE_MAX_BUTTONS);
+        return ESP_ERR_NO_MEM;
+    }
+
+    gpio_config_t io_conf = {
+            .pin_bit_mask = 1ULL << gpio_cfg->gpio_num,
+            .mode = GPIO_MODE_INPUT,
+            .pull_up_en = !gpio_cfg->disable_pull && !gpio_cfg->active_level,
+            .pull_down_en = !gpio_cfg->disable_pull && gpio_cfg->active_level,
+            .intr_type = GPIO_INTR_DISABLE,
+    };
+    esp_err_t ret = ESP_OK;
+    ESP_GOTO_ON_ERROR(gpio_config(&io_conf), err, TAG, "configure gpio failed");
+    // the ISRs call into esp_timer, they don't need to run with the flash cache disabled
+    ret = gpio_install_isr_service(0);
+    ESP_GOTO_ON_FALSE(ret == ESP_OK || ret == ESP_ERR_INVALID_STATE, ret, err, TAG, "install gpio isr service failed");
+    ESP_GOTO_ON_ERROR(gpio_set_intr_type(gpio_cfg->gpio_num,
+                                         gpio_cfg->active_level ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL),
+                      err, TAG, "set gpio interrupt type failed");
+
+    btn->gpio_num = gpio_cfg->gpio_num;
+    btn->active_level = gpio_cfg->active_level;
+    // enable_power_save keeps iot_button_create() from starting the timer and lets button_cb() stop it
+    btn->base.enable_power_save = true;
+    btn->base.get_key_level = button_edge_get_key_level;
+    btn->base.enter_power_save = button_edge_enter_power_save;
+    btn->base.del = button_edge_del;
+
+    ESP_GOTO_ON_ERROR(gpio_isr_handler_add(btn->gpio_num, button_edge_isr, btn), err, TAG,
+                      "add gpio isr handler failed");
+    ret = iot_button_create(button_config, &btn->base, ret_button);
+    if (ret != ESP_OK) {
+        gpio_isr_handler_remove(btn->gpio_num);
+        ESP_LOGE(TAG, "create button failed");
+        goto err;
+    }
+    btn->handle = *ret_button;
+    // a button already held fires right away
+    return gpio_intr_enable(btn->gpio_num);
+
+err:
+    button_edge_release_slot(btn);
+    free(btn);
+    return ret;
+}
+
+int64_t button_edge_take_press_time_us(button_handle_t button) {
+    int64_t edge_us = 0;
+    portENTER_CRITICAL(&edge_lock);
+    for (int i = 0; i < BUTTON_EDGE_MAX_BUTTONS; i++) {
+        button_edge_obj_t *btn = edge_ctx.buttons[i];
+        if (btn != NULL && btn->handle == button) {
+            edge_us = btn->edge_us;
+            btn->edge_us = 0;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&edge_lock);
+    return edge_us > 0 ? edge_us : esp_timer_get_time();
+}
+
+void button_edge_get_stats(button_edge_stats_t *stats) {
+    portENTER_CRITICAL(&edge_lock);
+    *stats = edge_ctx.stats;
+    if (edge_ctx.armed) {
+        stats->armed_us += esp_timer_get_time() - edge_ctx.armed_at_us;
+    }
+    portEXIT_CRITICAL(&edge_lock);
+}
@@ -0,0 +1,62 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Interrupt-driven GPIO buttons for espressif/button (t_display_s3_button.c) and the two-button navigation profile
+// over them (t_display_s3_nav.c)
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "iot_button.h"
+#include "button_gpio.h"
+#include "lvgl.h"
+
+// buttons that can be created in edge mode
+#define BUTTON_EDGE_MAX_BUTTONS 4
+
+// edge mode counters since boot
+typedef struct {
+    uint32_t edges;             // GPIO interrupts taken
+    uint32_t arms;              // times an edge started the button timer
+    uint32_t level_reads;       // GPIO reads of the button timer (one per button and scan)
+    uint64_t armed_us;          // time the button timer ran
+} button_edge_stats_t;
+
+// iot_button_new_gpio_device() in edge mode: the button timer of espressif/button is started by the first edge of a
+// button and stopped once all buttons are back to BUTTON_NONE_PRESS, instead of scanning every
+// CONFIG_BUTTON_PERIOD_TIME_MS. enable_power_save is not supported, all buttons must be created in edge mode.
+// ESP_ERR_NO_MEM once BUTTON_EDGE_MAX_BUTTONS buttons exist.
+esp_err_t button_edge_new_gpio_device(const button_config_t *button_config, const button_gpio_config_t *gpio_cfg,
+                                      button_handle_t *ret_button);
+
+// time of the interrupt that caught the last press of a button, for BUTTON_PRESS_DOWN. The interrupt stays disabled
+// while the button timer runs, a press it didn't catch (or one already taken) returns the current time.
+int64_t button_edge_take_press_time_us(button_handle_t button);
+
+void button_edge_get_stats(button_edge_stats_t *stats);
+
+// navigation profile counters since boot
+typedef struct {
+    uint32_t keys;              // key presses and releases queued
+    uint32_t dropped;           // dropped on a full queue
+    uint32_t presses;           // key presses read by LVGL
+    uint32_t avg_read_us;       // button press (gpio edge when known) to lv_indev_read()
+    uint32_t max_read_us;
+} lcd_nav_stats_t;
+
+// two buttons as an LVGL encoder in event mode, the way lvgl_port_add_navigation_buttons() drives three: a press of
+// btn_prev / btn_next is LV_KEY_LEFT / LV_KEY_RIGHT, holding either for LCD_NAV_LONG_PRESS_MS is LV_KEY_ENTER (after
+// the step of its press). The key is read by the LVGL task right after the button callback wakes it, and the
+// refresh of what it changed runs in the same lv_timer_handler() call. Assign a group with lv_indev_set_group().
+lv_indev_t *lcd_add_navigation_buttons(lv_display_t *disp, button_handle_t btn_prev, button_handle_t btn_next);
+
+void lcd_get_navigation_stats(lcd_nav_stats_t *stats);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
@@ -0,0 +1,165 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// LVGL image / image header cache policy
+//
+// Decoded images are kept in lv_image_cache (LRU, size based) so they are not decoded again on every draw. The
+// decoded buffers of small images (icons) are placed in internal SRAM up to LVGL_IMAGE_CACHE_SRAM_SIZE bytes, anything
+// larger, or anything that no longer fits, goes to PSRAM. Hits, misses and evictions are counted by wrapping the
+// cache class callbacks of both caches.
+
+#include <string.h>
+#include <esp_log.h>
+#include <esp_heap_caps.h>
+#include <esp_memory_utils.h>
+#include "freertos/FreeRTOS.h"
+#include "t_display_s3.h"
+#include "t_display_s3_priv.h"
+#include "core/lv_global.h"
+#include "misc/cache/lv_cache_private.h"
+
+static const char *TAG = "esp_idf_t_display_s3_cache";
+
+typedef struct {
+    lv_cache_class_t clz;                   // copy of the original cache class with the counting callbacks
+    const lv_cache_class_t *orig_clz;
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t evictions;
+} lcd_cache_counter_t;
+
+static lcd_cache_counter_t image_cache_counter;
+static lcd_cache_counter_t header_cache_counter;
+
+// decoded image bytes currently allocated from each memory, images are decoded by the render threads so
+// with more than one SW draw unit the buffers are allocated and freed concurrently
+static size_t sram_bytes;
+static size_t psram_bytes;
+static portMUX_TYPE buf_bytes_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static lcd_cache_counter_t *lcd_cache_counter_get(lv_cache_t *cache) {
+    return cache->clz == &image_cache_counter.clz ? &image_cache_counter : &header_cache_counter;
+}
+
+static lv_cache_entry_t *lcd_cache_get_cb(lv_cache_t *cache, const void *key, void *user_data) {
+    lcd_cache_counter_t *counter = lcd_cache_counter_get(cache);
+    lv_cache_entry_t *entry = counter->orig_clz->get_cb(cache, key, user_data);
+    if (entry != NULL) {
+        counter->hits++;
+    }
+    return entry;
+}
+
+// entries are only added after a lookup missed
+static lv_cache_entry_t *lcd_cache_add_cb(lv_cache_t *cache, const void *key, void *user_data) {
+    lcd_cache_counter_t *counter = lcd_cache_counter_get(cache);
+    counter->misses++;
+    return counter->orig_clz->add_cb(cache, key, user_data);
+}
+
+// the victim is only looked up when an entry has to be evicted to make room
+static lv_cache_entry_t *lcd_cache_get_victim_cb(lv_cache_t *cache, void *user_data) {
+    lcd_cache_counter_t *counter = lcd_cache_counter_get(cache);
+    lv_cache_entry_t *victim = counter->orig_clz->get_victim_cb(cache, user_data);
+    if (victim != NULL) {
+        counter->evictions++;
+    }
+    return victim;
+}
+
+static void lcd_cache_counter_install(lv_cache_t *cache, lcd_cache_counter_t *counter) {
+    counter->orig_clz = cache->clz;
+    counter->clz = *cache->clz;
+    counter->clz.get_cb = lcd_cache_get_cb;
+    counter->clz.add_cb = lcd_cache_add_cb;
+    counter->clz.get_victim_cb = lcd_cache_get_victim_cb;
+    cache->clz = &counter->clz;
+}
+
+// allocate the decoded image buffers, small ones in internal SRAM while the SRAM budget lasts
+static void *lcd_image_buf_malloc(size_t size_bytes, lv_color_format_t color_format) {
+    LV_UNUSED(color_format);
+
+    // allocate larger memory to be sure it can be aligned as needed (same as LVGL's default handler)
+    size_bytes += LV_DRAW_BUF_ALIGN - 1;
+
+    portENTER_CRITICAL(&buf_bytes_lock);
+    bool use_sram = size_bytes <= LVGL_IMAGE_CACHE_SRAM_MAX_ENTRY &&
+                    sram_bytes + size_bytes <= LVGL_IMAGE_CACHE_SRAM_SIZE;
+    portEXIT_CRITICAL(&buf_bytes_lock);
+
+    void *buf = NULL;
+    if (use_sram) {
+        buf = heap_caps_malloc(size_bytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    if (buf == NULL) {
+        buf = heap_caps_malloc(size_bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    }
+    if (buf == NULL) {
+        return NULL;
+    }
+
+    size_t allocated = heap_caps_get_allocated_size(buf);
+    portENTER_CRITICAL(&buf_bytes_lock);
+    if (esp_ptr_internal(buf)) {
+        sram_bytes += allocated;
+    } else {
+        psram_bytes += allocated;
+    }
+    portEXIT_CRITICAL(&buf_bytes_lock);
+    return buf;
+}
+
+static void lcd_image_buf_free(void *buf) {
+    if (buf == NULL) {
+        return;
+    }
+    size_t allocated = heap_caps_get_allocated_size(buf);
+    portENTER_CRITICAL(&buf_bytes_lock);
+    if (esp_ptr_internal(buf)) {
+        sram_bytes -= allocated;
+    } else {
+        psram_bytes -= allocated;
+    }
+    portEXIT_CRITICAL(&buf_bytes_lock);
+    heap_caps_free(buf);
+}
+
+void lcd_image_cache_init(void) {
+    lv_cache_t *img_cache = LV_GLOBAL_DEFAULT()->img_cache;
+    lv_cache_t *img_header_cache = LV_GLOBAL_DEFAULT()->img_header_cache;
+
+    lv_draw_buf_handlers_t *handlers = lv_draw_buf_get_image_handlers();
+    handlers->buf_malloc_cb = lcd_image_buf_malloc;
+    handlers->buf_free_cb = lcd_image_buf_free;
+
+    // called before any image is decoded, so every cached buffer comes from the handlers above
+    lv_image_cache_resize(LVGL_IMAGE_CACHE_SRAM_SIZE + LVGL_IMAGE_CACHE_PSRAM_SIZE, false);
+    lv_image_header_cache_resize(LVGL_IMAGE_HEADER_CACHE_COUNT, false);
+
+    lcd_cache_counter_install(img_cache, &image_cache_counter);
+    lcd_cache_counter_install(img_header_cache, &header_cache_counter);
+
+    ESP_LOGI(TAG, "Image cache %d KB (%d KB SRAM), header cache %d entries",
+             (LVGL_IMAGE_CACHE_SRAM_SIZE + LVGL_IMAGE_CACHE_PSRAM_SIZE) / 1024, LVGL_IMAGE_CACHE_SRAM_SIZE / 1024,
+             LVGL_IMAGE_HEADER_CACHE_COUNT);
+}
+
+void lcd_get_image_cache_stats(lcd_image_cache_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+
+    lvgl_port_lock(0);
+    stats->hits = image_cache_counter.hits;
+    stats->misses = image_cache_counter.misses;
+    stats->evictions = image_cache_counter.evictions;
+    stats->header_hits = header_cache_counter.hits;
+    stats->header_misses = header_cache_counter.misses;
+    stats->header_evictions = header_cache_counter.evictions;
+    stats->cached_bytes = lv_cache_get_size(LV_GLOBAL_DEFAULT()->img_cache, NULL);
+    lvgl_port_unlock();
+
+    portENTER_CRITICAL(&buf_bytes_lock);
+    stats->sram_bytes = sram_bytes;
+    stats->psram_bytes = psram_bytes;
+    portEXIT_CRITICAL(&buf_bytes_lock);
+}
@@ -0,0 +1,596 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Stripe ring flush pipeline
+//
+// LVGL renders single buffered (partial mode) into one of LVGL_STRIPE_BUFFER_COUNT stripe buffers. A rendered
+// stripe is handed to lcd_flush_task, which feeds the i80 bus, and LVGL carries on rendering into the next free
+// buffer straight away. LVGL only waits (lcd_flush_wait_cb) when every other buffer is still queued or in flight.
+//
+// With LCD_ROW_HASH a stripe is only sent as the row ranges the panel doesn't show yet (t_display_s3_rowhash.c), in
+// zero or more transfers. The buffers are rendered into in ring order, so a stripe buffer is only released when the
+// transfers queued before it are done: by the last transfer of its stripe, or by the last transfer still on the bus
+// when none of its rows had to be sent. A stripe whose transfer can't be queued (the panel IO returns an error) is
+// dropped from there on and released the same way, so LVGL never waits for a buffer that is never sent.
+//
+// With LCD_BOUNCE_BUFFER the i80 DMA doesn't read PSRAM: an area is sent with its own CASET/RASET, then in chunks
+// copied into two internal SRAM bounce buffers, RAMWR for the first and WRMEMC (write memory continue) for the rest.
+// A chunk is copied while the previous one is on the bus, a bounce buffer is taken again when its transfer is done.
+//
+// In the host simulation (host_sim/) the flush cost is measured on the simulated i80 bus time of the mock panel IO
+// instead of esp_timer, so the cost model doesn't depend on how fast the host is.
+
+#include <string.h>
+#include <inttypes.h>
+#include <esp_log.h>
+#include <esp_check.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_lcd_panel_commands.h"
+#include "t_display_s3.h"
+#include "t_display_s3_priv.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include "esp_lcd_sim.h"
+#endif
+
+#if LVGL_STRIPE_BUFFER_COUNT < 2 || LVGL_STRIPE_BUFFER_COUNT > 4
+#error "LVGL_STRIPE_BUFFER_COUNT must be between 2 and 4"
+#endif
+
+static const char *TAG = "esp_idf_t_display_s3_flush";
+
+#if CONFIG_IDF_TARGET_LINUX
+#define LCD_FLUSH_COST_CLOCK_NS() ((int64_t) esp_lcd_sim_get_bus_time_ns())
+#else
+#define LCD_FLUSH_COST_CLOCK_NS() (esp_timer_get_time() * 1000)
+#endif
+
+typedef struct {
+    lv_area_t area;
+    uint8_t *px_map;
+    uint32_t seq;                   // stripe number of the input latency probes
+} lcd_flush_stripe_t;
+
+typedef struct {
+    uint8_t release;                // stripe buffers released when the transfer is done
+    bool bounce;                    // the transfer was sent from a bounce buffer
+    uint32_t seq;                   // last stripe on the panel when the transfer is done, 0: none
+} lcd_flush_trans_t;
+
+typedef struct {
+    lv_display_t *disp;
+    esp_lcd_panel_io_handle_t io_handle;
+    esp_lcd_panel_handle_t panel_handle;
+    uint8_t *bufs[LVGL_STRIPE_BUFFER_COUNT];
+    uint8_t buf_idx;                // stripe buffer LVGL is rendering into
+    QueueHandle_t stripe_queue;     // rendered stripes waiting for the i80 bus
+    SemaphoreHandle_t free_bufs;    // stripe buffers that are neither rendered into nor transmitted
+    TaskHandle_t flush_task;
+    uint32_t sending_seq;           // stripe lcd_flush_task is sending
+#if LCD_BOUNCE_BUFFER
+    uint8_t *bounce[2];
+    uint8_t bounce_idx;             // bounce buffer the next chunk is copied into
+    uint32_t bounce_chunk;          // bytes per transfer, 0 sends straight from PSRAM (lcd_flush_benchmark)
+    SemaphoreHandle_t free_bounce;  // bounce buffers that are not on the bus
+#endif
+    uint32_t gap_px;                // unchanged pixels cheaper to send along than another command sequence
+    portMUX_TYPE lock;              // guards the fields below, they are also updated from the i80 ISR
+    uint32_t trans_inflight;
+    lcd_flush_trans_t trans[32];    // queued transfers, in queue order
+    uint8_t trans_head;
+    uint8_t trans_tail;
+    bool in_frame;
+    int64_t frame_start_us;
+    int64_t bus_idle_since_us;
+    uint64_t copy_us;               // time spent copying into the bounce buffers since lcd_init
+    lcd_flush_stats_t frame;        // stats of the frame being refreshed
+    lcd_flush_stats_t last_frame;   // stats of the last completed frame
+} lcd_flush_ctx_t;
+
+static lcd_flush_ctx_t flush_ctx = {
+        .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+// point LVGL's draw buffer at the next stripe buffer of the ring
+static void lcd_flush_next_buf(void) {
+    lv_draw_buf_t *draw_buf = lv_display_get_buf_active(flush_ctx.disp);
+    flush_ctx.buf_idx = (flush_ctx.buf_idx + 1) % LVGL_STRIPE_BUFFER_COUNT;
+    draw_buf->data = flush_ctx.bufs[flush_ctx.buf_idx];
+    draw_buf->unaligned_data = flush_ctx.bufs[flush_ctx.buf_idx];
+}
+
+static bool lcd_flush_io_ready_callback(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx) {
+    BaseType_t need_yield = pdFALSE;
+    lcd_flush_trans_t trans = {0};
+
+    portENTER_CRITICAL_ISR(&flush_ctx.lock);
+    if (flush_ctx.trans_inflight > 0) {
+        trans = flush_ctx.trans[flush_ctx.trans_tail++ % 32];
+        if (--flush_ctx.trans_inflight == 0) {
+            flush_ctx.bus_idle_since_us = esp_timer_get_time();
+        }
+    }
+    portEXIT_CRITICAL_ISR(&flush_ctx.lock);
+
+    if (trans.seq != 0) {
+        lcd_latency_stripe_done(trans.seq);
+    }
+    // the transmitted stripe buffers can be rendered into again, one DMA_DONE per stripe pairs with its FLUSH_CB
+    for (uint8_t i = 0; i < trans.release; i++) {
+        lcd_trace_record(LCD_TRACE_EVENT_DMA_DONE);
+        xSemaphoreGiveFromISR(flush_ctx.free_bufs, &need_yield);
+    }
+#if LCD_BOUNCE_BUFFER
+    if (trans.bounce) {
+        xSemaphoreGiveFromISR(flush_ctx.free_bounce, &need_yield);
+    }
+#endif
+    return need_yield == pdTRUE;
+}
+
+// record a transfer about to be queued on the i80 bus
+static void lcd_flush_trans_push(uint8_t release, bool bounce) {
+    portENTER_CRITICAL(&flush_ctx.lock);
+    if (flush_ctx.trans_inflight == 0 && flush_ctx.in_frame) {
+        flush_ctx.frame.bus_idle_us += (uint32_t) (esp_timer_get_time() - flush_ctx.bus_idle_since_us);
+    }
+    flush_ctx.trans_inflight++;
+    flush_ctx.trans[flush_ctx.trans_head++ % 32] = (lcd_flush_trans_t) {
+            .release = release,
+            .bounce = bounce,
+            .seq = release > 0 ? flush_ctx.sending_seq : 0,
+    };
+    portEXIT_CRITICAL(&flush_ctx.lock);
+}
+
+// drop the transfer recorded last, it couldn't be queued on the i80 bus
+static void lcd_flush_trans_pop(void) {
+    portENTER_CRITICAL(&flush_ctx.lock);
+    flush_ctx.trans_head--;
+    if (--flush_ctx.trans_inflight == 0) {
+        flush_ctx.bus_idle_since_us = esp_timer_get_time();
+    }
+    portEXIT_CRITICAL(&flush_ctx.lock);
+}
+
+// release stripe buffers that have nothing (more) to send, after the transfers queued before them
+static void lcd_flush_release(uint8_t release) {
+    if (release == 0) {
+        return;
+    }
+
+    bool release_now;
+    portENTER_CRITICAL(&flush_ctx.lock);
+    release_now = flush_ctx.trans_inflight == 0;
+    if (!release_now) {
+        lcd_flush_trans_t *trans = &flush_ctx.trans[(uint8_t) (flush_ctx.trans_head - 1) % 32];
+        trans->release += release;
+        trans->seq = flush_ctx.sending_seq;
+    }
+    portEXIT_CRITICAL(&flush_ctx.lock);
+
+    if (release_now) {
+        // the panel already shows the whole stripe, or never will
+        lcd_latency_stripe_done(flush_ctx.sending_seq);
+        for (uint8_t i = 0; i < release; i++) {
+            lcd_trace_record(LCD_TRACE_EVENT_DMA_DONE);
+            xSemaphoreGive(flush_ctx.free_bufs);
+        }
+    }
+}
+
+// queue a transfer on the i80 bus straight from the buffer, its completion releases release stripe buffers
+static esp_err_t lcd_flush_draw(const lv_area_t *area, const uint8_t *px_map, uint8_t release) {
+    lcd_flush_trans_push(release, false);
+
+    // blocks while the previous stripe is still on the bus (CASET/RASET can't be queued behind color data)
+    esp_err_t ret = esp_lcd_panel_draw_bitmap(flush_ctx.panel_handle, area->x1, area->y1, area->x2 + 1, area->y2 + 1,
+                                              px_map);
+    if (ret != ESP_OK) {
+        lcd_flush_trans_pop();
+        lcd_flush_release(release);
+    }
+    return ret;
+}
+
+#if LCD_BOUNCE_BUFFER
+// queue an area through the bounce buffers, the completion of its last chunk releases release stripe buffers
+static esp_err_t lcd_flush_draw_bounce(const lv_area_t *area, const uint8_t *px_map, uint8_t release) {
+    int32_t x1 = area->x1 + LCD_X_GAP;
+    int32_t x2 = area->x2 + LCD_X_GAP;
+    int32_t y1 = area->y1 + LCD_Y_GAP;
+    int32_t y2 = area->y2 + LCD_Y_GAP;
+
+    // like esp_lcd_panel_draw_bitmap(), the parameters wait for the transfers on the bus
+    esp_err_t ret = esp_lcd_panel_io_tx_param(flush_ctx.io_handle, LCD_CMD_CASET, (uint8_t[]) {
+            (x1 >> 8) & 0xFF, x1 & 0xFF, (x2 >> 8) & 0xFF, x2 & 0xFF,
+    }, 4);
+    if (ret == ESP_OK) {
+        ret = esp_lcd_panel_io_tx_param(flush_ctx.io_handle, LCD_CMD_RASET, (uint8_t[]) {
+                (y1 >> 8) & 0xFF, y1 & 0xFF, (y2 >> 8) & 0xFF, y2 & 0xFF,
+        }, 4);
+    }
+
+    uint32_t size = lv_area_get_size(area) * sizeof(uint16_t);
+    for (uint32_t offset = 0; offset < size && ret == ESP_OK;) {
+        uint32_t len = LV_MIN(flush_ctx.bounce_chunk, size - offset);
+        xSemaphoreTake(flush_ctx.free_bounce, portMAX_DELAY);
+        uint8_t *bounce = flush_ctx.bounce[flush_ctx.bounce_idx];
+        flush_ctx.bounce_idx ^= 1;
+
+        int64_t copy_start_us = esp_timer_get_time();
+        memcpy(bounce, px_map + offset, len);
+        uint32_t copy_us = (uint32_t) (esp_timer_get_time() - copy_start_us);
+
+        portENTER_CRITICAL(&flush_ctx.lock);
+        flush_ctx.frame.copy_us += copy_us;
+        flush_ctx.copy_us += copy_us;
+        portEXIT_CRITICAL(&flush_ctx.lock);
+
+        int cmd = offset == 0 ? LCD_CMD_RAMWR : LCD_CMD_WRMEMC;
+        offset += len;
+        lcd_flush_trans_push(offset == size ? release : 0, true);
+        ret = esp_lcd_panel_io_tx_color(flush_ctx.io_handle, cmd, bounce, len);
+        if (ret != ESP_OK) {
+            // the bounce buffer isn't on the bus, it's the next one to copy into again
+            lcd_flush_trans_pop();
+            flush_ctx.bounce_idx ^= 1;
+            xSemaphoreGive(flush_ctx.free_bounce);
+        }
+    }
+
+    if (ret != ESP_OK) {
+        // the rest of the area is dropped, the chunks already on the bus release the stripe buffers
+        lcd_flush_release(release);
+    }
+    return ret;
+}
+#endif
+
+// queue the pixels of an area, through the bounce buffers when enabled. When a transfer can't be queued the rest of
+// the area is dropped and the release stripe buffers are still released, after the transfers queued before them
+static esp_err_t lcd_flush_send(const lv_area_t *area, const uint8_t *px_map, uint8_t release) {
+#if LCD_BOUNCE_BUFFER
+    if (flush_ctx.bounce_chunk > 0) {
+        return lcd_flush_draw_bounce(area, px_map, release);
+    }
+#endif
+    return lcd_flush_draw(area, px_map, release);
+}
+
+static void lcd_flush_task(void *pvParam) {
+    lcd_flush_stripe_t stripe;
+#if LCD_ROW_HASH
+    lv_area_t segments[LCD_ROW_HASH_MAX_SEGMENTS];
+#endif
+
+    for (;;) {
+        xQueueReceive(flush_ctx.stripe_queue, &stripe, portMAX_DELAY);
+        flush_ctx.sending_seq = stripe.seq;
+        esp_err_t ret = ESP_OK;
+
+#if LCD_ROW_HASH
+        uint32_t count = lcd_row_hash_trim(&stripe.area, stripe.px_map, flush_ctx.gap_px, segments);
+        if (count == 0) {
+            lcd_flush_release(1);
+            continue;
+        }
+        uint32_t stride = lv_area_get_width(&stripe.area) * sizeof(uint16_t);
+        for (uint32_t i = 0; i < count && ret == ESP_OK; i++) {
+            bool last = i == count - 1;
+            ret = lcd_flush_send(&segments[i], stripe.px_map + (segments[i].y1 - stripe.area.y1) * stride, last);
+            if (ret != ESP_OK && !last) {
+                // the release was left to the last segment
+                lcd_flush_release(1);
+            }
+        }
+        if (ret != ESP_OK) {
+            // the hashes of the dropped rows don't match the panel anymore
+            lcd_row_hash_reset();
+        }
+#else
+        ret = lcd_flush_send(&stripe.area, stripe.px_map, 1);
+#endif
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "stripe (%d,%d)-(%d,%d) not sent: %s", (int) stripe.area.x1, (int) stripe.area.y1,
+                     (int) stripe.area.x2, (int) stripe.area.y2, esp_err_to_name(ret));
+        }
+    }
+}
+
+static void lcd_flush_callback(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map) {
+    lcd_trace_record(LCD_TRACE_EVENT_FLUSH_CB);
+
+#if !LCD_I80_SWAP_COLOR_BYTES
+    lv_draw_sw_rgb565_swap(px_map, lv_area_get_size(area));
+#endif
+
+    // the queue holds as many stripes as there are buffers, this never blocks
+    const lcd_flush_stripe_t stripe = {
+            .area = *area,
+            .px_map = px_map,
+            .seq = lcd_latency_flush(area),
+    };
+    xQueueSend(flush_ctx.stripe_queue, &stripe, portMAX_DELAY);
+
+    portENTER_CRITICAL(&flush_ctx.lock);
+    flush_ctx.frame.stripes++;
+    portEXIT_CRITICAL(&flush_ctx.lock);
+
+    // keep rendering if another stripe buffer is free, otherwise LVGL waits in lcd_flush_wait_callback
+    if (xSemaphoreTake(flush_ctx.free_bufs, 0) == pdTRUE) {
+        lcd_flush_next_buf();
+        lv_display_flush_ready(disp);
+    }
+}
+
+static void lcd_flush_wait_callback(lv_display_t *disp) {
+    int64_t wait_start_us = esp_timer_get_time();
+    xSemaphoreTake(flush_ctx.free_bufs, portMAX_DELAY);
+    lcd_flush_next_buf();
+
+    portENTER_CRITICAL(&flush_ctx.lock);
+    flush_ctx.frame.render_wait_us += (uint32_t) (esp_timer_get_time() - wait_start_us);
+    portEXIT_CRITICAL(&flush_ctx.lock);
+}
+
+static void lcd_flush_refr_event_callback(lv_event_t *e) {
+    int64_t now_us = esp_timer_get_time();
+
+    portENTER_CRITICAL(&flush_ctx.lock);
+    if (lv_event_get_code(e) == LV_EVENT_REFR_START) {
+        memset(&flush_ctx.frame, 0, sizeof(flush_ctx.frame));
+        flush_ctx.in_frame = true;
+        flush_ctx.frame_start_us = now_us;
+        if (flush_ctx.trans_inflight == 0) {
+            flush_ctx.bus_idle_since_us = now_us;
+        }
+    } else if (flush_ctx.in_frame && flush_ctx.frame.stripes > 0) {
+        // only frames that flushed something are reported (the perf monitor refreshes every period)
+        if (flush_ctx.trans_inflight == 0) {
+            flush_ctx.frame.bus_idle_us += (uint32_t) (now_us - flush_ctx.bus_idle_since_us);
+        }
+        flush_ctx.frame.frame_time_us = (uint32_t) (now_us - flush_ctx.frame_start_us);
+        flush_ctx.frame.frame_count = flush_ctx.last_frame.frame_count + 1;
+        flush_ctx.last_frame = flush_ctx.frame;
+        flush_ctx.in_frame = false;
+    } else {
+        flush_ctx.in_frame = false;
+    }
+    portEXIT_CRITICAL(&flush_ctx.lock);
+}
+
+esp_err_t lcd_flush_init(lv_display_t *disp, esp_lcd_panel_io_handle_t io_handle, esp_lcd_panel_handle_t panel_handle) {
+    ESP_RETURN_ON_FALSE(disp && io_handle && panel_handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(!lv_display_is_double_buffered(disp), ESP_ERR_INVALID_STATE, TAG, "display must be single buffered");
+
+    ESP_LOGI(TAG, "Configuring %d stripe buffer flush pipeline...", LVGL_STRIPE_BUFFER_COUNT);
+    flush_ctx.disp = disp;
+    flush_ctx.io_handle = io_handle;
+    flush_ctx.panel_handle = panel_handle;
+#if LCD_ROW_HASH
+    ESP_RETURN_ON_ERROR(lcd_row_hash_init(disp), TAG, "row hash init failed");
+#endif
+
+    // the buffer allocated by lvgl_port_add_disp() is the first stripe buffer
+    lv_draw_buf_t *draw_buf = lv_display_get_buf_active(disp);
+    flush_ctx.bufs[0] = draw_buf->data;
+    for (int i = 1; i < LVGL_STRIPE_BUFFER_COUNT; i++) {
+        flush_ctx.bufs[i] = heap_caps_aligned_alloc(LCD_PSRAM_TRANS_ALIGN, draw_buf->data_size, MALLOC_CAP_SPIRAM);
+        ESP_RETURN_ON_FALSE(flush_ctx.bufs[i], ESP_ERR_NO_MEM, TAG, "Not enough memory for stripe buffer %d allocation!", i);
+    }
+
+#if LCD_BOUNCE_BUFFER
+    for (int i = 0; i < 2; i++) {
+        flush_ctx.bounce[i] = heap_caps_aligned_alloc(LCD_SRAM_TRANS_ALIGN, LCD_BOUNCE_BUFFER_SIZE,
+                                                      MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+        ESP_RETURN_ON_FALSE(flush_ctx.bounce[i], ESP_ERR_NO_MEM, TAG, "Not enough memory for bounce buffer %d allocation!", i);
+    }
+    flush_ctx.bounce_chunk = LCD_BOUNCE_BUFFER_SIZE;
+    flush_ctx.free_bounce = xSemaphoreCreateCounting(2, 2);
+    ESP_RETURN_ON_FALSE(flush_ctx.free_bounce, ESP_ERR_NO_MEM, TAG, "Create bounce buffer semaphore fail!");
+    ESP_LOGI(TAG, "Sending through 2 x %d byte SRAM bounce buffers, PCLK %d MHz", (int) LCD_BOUNCE_BUFFER_SIZE,
+             LCD_PIXEL_CLOCK_HZ / 1000000);
+#endif
+
+    flush_ctx.stripe_queue = xQueueCreate(LVGL_STRIPE_BUFFER_COUNT, sizeof(lcd_flush_stripe_t));
+    ESP_RETURN_ON_FALSE(flush_ctx.stripe_queue, ESP_ERR_NO_MEM, TAG, "Create stripe queue fail!");
+    // every buffer except the one LVGL renders into is free
+    flush_ctx.free_bufs = xSemaphoreCreateCounting(LVGL_STRIPE_BUFFER_COUNT, LVGL_STRIPE_BUFFER_COUNT - 1);
+    ESP_RETURN_ON_FALSE(flush_ctx.free_bufs, ESP_ERR_NO_MEM, TAG, "Create stripe buffer semaphore fail!");
+
+    BaseType_t res = xTaskCreatePinnedToCore(lcd_flush_task, "lcd_flush", LCD_FLUSH_TASK_STACK_SIZE, NULL,
+                                             LCD_FLUSH_TASK_PRIORITY, &flush_ctx.flush_task, LCD_FLUSH_TASK_AFFINITY);
+    ESP_RETURN_ON_FALSE(res == pdPASS, ESP_FAIL, TAG, "Create flush task fail!");
+
+    // replace the esp_lvgl_port flush handling
+    const esp_lcd_panel_io_callbacks_t cbs = {
+            .on_color_trans_done = lcd_flush_io_ready_callback,
+    };
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_register_event_callbacks(io_handle, &cbs, NULL), TAG, "Register i80 callbacks fail!");
+    lv_display_set_flush_cb(disp, lcd_flush_callback);
+    lv_display_set_flush_wait_cb(disp, lcd_flush_wait_callback);
+    lv_display_add_event_cb(disp, lcd_flush_refr_event_callback, LV_EVENT_REFR_START, NULL);
+    lv_display_add_event_cb(disp, lcd_flush_refr_event_callback, LV_EVENT_REFR_READY, NULL);
+
+    return ESP_OK;
+}
+
+esp_err_t lcd_flush_measure_cost(uint32_t *setup_ns, uint32_t *px_ns) {
+    ESP_RETURN_ON_FALSE(flush_ctx.disp && setup_ns && px_ns, ESP_ERR_INVALID_STATE, TAG, "flush pipeline not set up");
+
+    // a single pixel is all command sequence / DMA setup, a full stripe buffer is mostly pixels
+    lv_draw_buf_t *draw_buf = lv_display_get_buf_active(flush_ctx.disp);
+    int32_t w = lv_display_get_horizontal_resolution(flush_ctx.disp);
+    int32_t h = lv_display_get_vertical_resolution(flush_ctx.disp);
+    int32_t rows = LV_MIN((int32_t) (draw_buf->data_size / (w * sizeof(uint16_t))), h);
+    const int32_t widths[2] = {1, w};
+    const int32_t heights[2] = {1, rows};
+    int64_t times_ns[2];
+
+    // claim the free stripe buffers, so the semaphore is only given by lcd_flush_io_ready_callback when the DMA is done
+    UBaseType_t free_count = uxSemaphoreGetCount(flush_ctx.free_bufs);
+    for (UBaseType_t i = 0; i < free_count; i++) {
+        xSemaphoreTake(flush_ctx.free_bufs, 0);
+    }
+
+    // nothing renders into the second stripe buffer yet, send black so nothing shows before the first frame
+    uint8_t *buf = flush_ctx.bufs[1];
+    memset(buf, 0, w * rows * sizeof(uint16_t));
+    esp_err_t ret = ESP_OK;
+    for (int i = 0; i < 2 && ret == ESP_OK; i++) {
+        int64_t start_ns = LCD_FLUSH_COST_CLOCK_NS();
+        lv_area_t area = {0, 0, widths[i] - 1, heights[i] - 1};
+        // a failed send has released the buffer already
+        ret = lcd_flush_send(&area, buf, 1);
+        if (xSemaphoreTake(flush_ctx.free_bufs, pdMS_TO_TICKS(100)) != pdTRUE) {
+            ret = ESP_ERR_TIMEOUT;
+        }
+        times_ns[i] = LCD_FLUSH_COST_CLOCK_NS() - start_ns;
+    }
+
+    for (UBaseType_t i = 0; i < free_count; i++) {
+        xSemaphoreGive(flush_ctx.free_bufs);
+    }
+    ESP_RETURN_ON_ERROR(ret, TAG, "i80 transfer failed");
+
+    int64_t px_cost = (times_ns[1] - times_ns[0]) / ((int64_t) w * rows - 1);
+    *px_ns = (uint32_t) LV_MAX(px_cost, 1);
+    *setup_ns = (uint32_t) LV_MAX(times_ns[0] - px_cost, 0);
+    flush_ctx.gap_px = *setup_ns / *px_ns;
+    return ESP_OK;
+}
+
+esp_err_t lcd_flush_wait_idle(uint32_t timeout_ms) {
+    ESP_RETURN_ON_FALSE(flush_ctx.disp, ESP_ERR_INVALID_STATE, TAG, "flush pipeline not set up");
+
+    // every buffer but the one LVGL renders into is free once the stripes it queued are sent
+    int taken = 0;
+    TickType_t timeout = pdMS_TO_TICKS(timeout_ms);
+    TickType_t start = xTaskGetTickCount();
+    while (taken < LVGL_STRIPE_BUFFER_COUNT - 1) {
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        if (elapsed > timeout || xSemaphoreTake(flush_ctx.free_bufs, timeout - elapsed) != pdTRUE) {
+            break;
+        }
+        taken++;
+    }
+    for (int i = 0; i < taken; i++) {
+        xSemaphoreGive(flush_ctx.free_bufs);
+    }
+    ESP_RETURN_ON_FALSE(taken == LVGL_STRIPE_BUFFER_COUNT - 1, ESP_ERR_TIMEOUT, TAG, "stripes still queued");
+    return ESP_OK;
+}
+
+esp_err_t lcd_flush_benchmark(uint32_t chunk_bytes, uint32_t frames, lcd_flush_benchmark_t *result) {
+    ESP_RETURN_ON_FALSE(flush_ctx.disp, ESP_ERR_INVALID_STATE, TAG, "flush pipeline not set up");
+    ESP_RETURN_ON_FALSE(result && frames > 0 && chunk_bytes % sizeof(uint16_t) == 0, ESP_ERR_INVALID_ARG, TAG,
+                        "invalid argument");
+#if LCD_BOUNCE_BUFFER
+    ESP_RETURN_ON_FALSE(chunk_bytes <= LCD_BOUNCE_BUFFER_SIZE, ESP_ERR_INVALID_ARG, TAG, "chunk larger than the bounce buffers");
+#else
+    ESP_RETURN_ON_FALSE(chunk_bytes == 0, ESP_ERR_NOT_SUPPORTED, TAG, "bounce buffers disabled (LCD_BOUNCE_BUFFER)");
+#endif
+
+    // LVGL can't start a refresh, once the stripes it queued are sent every buffer but the one it renders into is free
+    lvgl_port_lock(0);
+    for (int i = 0; i < LVGL_STRIPE_BUFFER_COUNT - 1; i++) {
+        xSemaphoreTake(flush_ctx.free_bufs, portMAX_DELAY);
+    }
+
+    // a full screen is sent from one stripe buffer, in as many stripes as it takes
+    lv_draw_buf_t *draw_buf = lv_display_get_buf_active(flush_ctx.disp);
+    int32_t w = lv_display_get_horizontal_resolution(flush_ctx.disp);
+    int32_t h = lv_display_get_vertical_resolution(flush_ctx.disp);
+    int32_t rows = LV_MIN((int32_t) (draw_buf->data_size / (w * sizeof(uint16_t))), h);
+    uint16_t *buf = (uint16_t *) flush_ctx.bufs[(flush_ctx.buf_idx + 1) % LVGL_STRIPE_BUFFER_COUNT];
+    for (int32_t i = 0; i < w * rows; i++) {
+        buf[i] = (uint16_t) (i / w * 0x0841);
+    }
+
+#if LCD_BOUNCE_BUFFER
+    uint32_t bounce_chunk = flush_ctx.bounce_chunk;
+    flush_ctx.bounce_chunk = chunk_bytes;
+#endif
+    portENTER_CRITICAL(&flush_ctx.lock);
+    uint64_t copy_start_us = flush_ctx.copy_us;
+    portEXIT_CRITICAL(&flush_ctx.lock);
+
+    esp_err_t ret = ESP_OK;
+    int64_t start_us = esp_timer_get_time();
+    for (uint32_t f = 0; f < frames && ret == ESP_OK; f++) {
+        for (int32_t y = 0; y < h && ret == ESP_OK; y += rows) {
+            lv_area_t area = {0, y, w - 1, LV_MIN(y + rows, h) - 1};
+            bool last = y + rows >= h;
+            ret = lcd_flush_send(&area, (uint8_t *) buf, last);
+            if (ret != ESP_OK && !last) {
+                lcd_flush_release(1);
+            }
+        }
+        if (xSemaphoreTake(flush_ctx.free_bufs, pdMS_TO_TICKS(1000)) != pdTRUE) {
+            ret = ESP_ERR_TIMEOUT;
+        }
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+
+    portENTER_CRITICAL(&flush_ctx.lock);
+    uint64_t copy_us = flush_ctx.copy_us - copy_start_us;
+    portEXIT_CRITICAL(&flush_ctx.lock);
+#if LCD_BOUNCE_BUFFER
+    flush_ctx.bounce_chunk = bounce_chunk;
+#endif
+
+    // the panel shows the benchmark, LVGL redraws everything
+    for (int i = 0; i < LVGL_STRIPE_BUFFER_COUNT - 1; i++) {
+        xSemaphoreGive(flush_ctx.free_bufs);
+    }
+#if LCD_ROW_HASH
+    lcd_row_hash_reset();
+#endif
+    lv_obj_invalidate(lv_display_get_screen_active(flush_ctx.disp));
+    lvgl_port_unlock();
+    ESP_RETURN_ON_ERROR(ret, TAG, "i80 transfer failed");
+
+    *result = (lcd_flush_benchmark_t) {
+            .pclk_hz = LCD_PIXEL_CLOCK_HZ,
+            .chunk_bytes = chunk_bytes,
+            .fps = (uint32_t) (frames * 1000000LL / elapsed_us),
+            .frame_us = (uint32_t) (elapsed_us / frames),
+            .copy_us = (uint32_t) (copy_us / frames),
+    };
+    return ESP_OK;
+}
+
+void lcd_flush_benchmark_sweep(void) {
+    // DMA straight from PSRAM, then bounce buffer chunks from 1 KB up
+    uint32_t chunks[8] = {0};
+    int count = 1;
+#if LCD_BOUNCE_BUFFER
+    for (uint32_t chunk = 1024; chunk < LCD_BOUNCE_BUFFER_SIZE && count < 7; chunk *= 2) {
+        chunks[count++] = chunk;
+    }
+    chunks[count++] = LCD_BOUNCE_BUFFER_SIZE;
+#endif
+
+    ESP_LOGI(TAG, "Flush benchmark, PCLK %d MHz, %d stripe buffers", LCD_PIXEL_CLOCK_HZ / 1000000, LVGL_STRIPE_BUFFER_COUNT);
+    for (int i = 0; i < count; i++) {
+        lcd_flush_benchmark_t result;
+        if (lcd_flush_benchmark(chunks[i], 30, &result) != ESP_OK) {
+            ESP_LOGE(TAG, "  chunk %5" PRIu32 " B: failed", chunks[i]);
+            continue;
+        }
+        ESP_LOGI(TAG, "  chunk %5" PRIu32 " B: %3" PRIu32 " fps, %6" PRIu32 " us/frame, copy %5" PRIu32 " us/frame",
+                 result.chunk_bytes, result.fps, result.frame_us, result.copy_us);
+    }
+}
+
+void lcd_get_flush_stats(lcd_flush_stats_t *stats) {
+    assert(stats);
+    portENTER_CRITICAL(&flush_ctx.lock);
+    *stats = flush_ctx.last_frame;
+    portEXIT_CRITICAL(&flush_ctx.lock);
+}
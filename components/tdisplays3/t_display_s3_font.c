@@ -0,0 +1,318 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Font glyph lookup tables
+//
+// lv_font_get_glyph_dsc_fmt_txt() maps every letter to its glyph id by walking the font's cmaps and binary searching
+// the sparse unicode lists, and does a binary search over the kerning pairs for every letter pair. It is wrapped at
+// link time (-Wl,--wrap, see CMakeLists.txt), so the registered fonts resolve
+//  - ASCII / Latin-1 (U+0000 - U+00FF) through a dense glyph id table,
+//  - the LV_SYMBOL_* private use range (U+F000 - U+F8FF) through a small open addressing hash of the symbols the
+//    font actually has,
+//  - kerning pairs through an open addressing hash of (left gid, right gid) (kerning classes already are a lookup).
+// The tables are built once when the font is registered, from the font's own lookup, so they give the same glyph ids.
+// Any other letter, and any font that wasn't registered, goes through LVGL's lookup.
+
+#include <string.h>
+#include <stdatomic.h>
+#include <esp_log.h>
+#include <esp_check.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include "t_display_s3.h"
+#include "t_display_s3_priv.h"
+
+static const char *TAG = "esp_idf_t_display_s3_font";
+
+bool __real_lv_font_get_glyph_dsc_fmt_txt(const lv_font_t *font, lv_font_glyph_dsc_t *dsc_out,
+                                          uint32_t unicode_letter, uint32_t unicode_letter_next);
+bool __wrap_lv_font_get_glyph_dsc_fmt_txt(const lv_font_t *font, lv_font_glyph_dsc_t *dsc_out,
+                                          uint32_t unicode_letter, uint32_t unicode_letter_next);
+
+#define LCD_FONT_LATIN1_COUNT    256
+#define LCD_FONT_SYMBOL_FIRST    0xF000
+#define LCD_FONT_SYMBOL_LAST     0xF8FF
+
+// codepoint not covered by the tables
+#define LCD_FONT_GID_UNKNOWN     UINT32_MAX
+
+typedef struct {
+    uint16_t letter;            // 0 = empty slot
+    uint16_t gid;
+} lcd_font_symbol_slot_t;
+
+typedef struct {
+    uint32_t pair;              // left gid << 16 | right gid, 0 = empty slot (gid 0 is never kerned)
+    int8_t value;
+} lcd_font_kern_slot_t;
+
+typedef struct {
+    const lv_font_t *font;
+    uint16_t latin1[LCD_FONT_LATIN1_COUNT];
+    lcd_font_symbol_slot_t symbols[LVGL_FONT_LUT_SYMBOL_SLOTS];
+    lcd_font_kern_slot_t *kern_pairs;   // NULL without kerning pairs
+    uint32_t kern_mask;
+} lcd_font_lut_t;
+
+// registered fonts, appended under lvgl_port_lock and read by the render threads without locking
+static lcd_font_lut_t *font_luts[LVGL_FONT_LUT_MAX_FONTS];
+static atomic_uint font_lut_count;
+
+static inline uint32_t lcd_font_hash(uint32_t key) {
+    // Fibonacci hashing, the callers mask the low bits
+    key *= 2654435761u;
+    return key ^ (key >> 16);
+}
+
+static const lcd_font_lut_t *lcd_font_lut_find(const lv_font_t *font) {
+    unsigned count = atomic_load_explicit(&font_lut_count, memory_order_acquire);
+    for (unsigned i = 0; i < count; i++) {
+        if (font_luts[i]->font == font) {
+            return font_luts[i];
+        }
+    }
+    return NULL;
+}
+
+static uint32_t lcd_font_lut_gid(const lcd_font_lut_t *lut, uint32_t letter) {
+    if (letter < LCD_FONT_LATIN1_COUNT) {
+        return lut->latin1[letter];
+    }
+    if (letter < LCD_FONT_SYMBOL_FIRST || letter > LCD_FONT_SYMBOL_LAST) {
+        return LCD_FONT_GID_UNKNOWN;
+    }
+    // every symbol of the font is in the table, a missing letter is not in the font
+    for (uint32_t i = lcd_font_hash(letter);; i++) {
+        const lcd_font_symbol_slot_t *slot = &lut->symbols[i & (LVGL_FONT_LUT_SYMBOL_SLOTS - 1)];
+        if (slot->letter == letter) {
+            return slot->gid;
+        }
+        if (slot->letter == 0) {
+            return 0;
+        }
+    }
+}
+
+static int8_t lcd_font_lut_kern(const lcd_font_lut_t *lut, const lv_font_fmt_txt_dsc_t *fdsc,
+                                uint32_t gid_left, uint32_t gid_right) {
+    if (fdsc->kern_classes) {
+        const lv_font_fmt_txt_kern_classes_t *kdsc = fdsc->kern_dsc;
+        uint8_t left_class = kdsc->left_class_mapping[gid_left];
+        uint8_t right_class = kdsc->right_class_mapping[gid_right];
+        if (left_class > 0 && right_class > 0) {
+            return kdsc->class_pair_values[(left_class - 1) * kdsc->right_class_cnt + (right_class - 1)];
+        }
+        return 0;
+    }
+    if (lut->kern_pairs == NULL) {
+        return 0;
+    }
+    uint32_t pair = gid_left << 16 | gid_right;
+    for (uint32_t i = lcd_font_hash(pair);; i++) {
+        const lcd_font_kern_slot_t *slot = &lut->kern_pairs[i & lut->kern_mask];
+        if (slot->pair == pair) {
+            return slot->value;
+        }
+        if (slot->pair == 0) {
+            return 0;
+        }
+    }
+}
+
+// same as lv_font_get_glyph_dsc_fmt_txt() with the glyph ids and kerning values from the tables
+bool __wrap_lv_font_get_glyph_dsc_fmt_txt(const lv_font_t *font, lv_font_glyph_dsc_t *dsc_out,
+                                          uint32_t unicode_letter, uint32_t unicode_letter_next) {
+    const lcd_font_lut_t *lut = lcd_font_lut_find(font);
+    if (lut == NULL) {
+        return __real_lv_font_get_glyph_dsc_fmt_txt(font, dsc_out, unicode_letter, unicode_letter_next);
+    }
+
+    bool is_tab = unicode_letter == '\t';
+    uint32_t gid = lcd_font_lut_gid(lut, is_tab ? ' ' : unicode_letter);
+    if (gid == LCD_FONT_GID_UNKNOWN) {
+        return __real_lv_font_get_glyph_dsc_fmt_txt(font, dsc_out, unicode_letter, unicode_letter_next);
+    }
+    if (gid == 0) {
+        return false;
+    }
+
+    const lv_font_fmt_txt_dsc_t *fdsc = font->dsc;
+    int8_t kvalue = 0;
+    if (fdsc->kern_dsc) {
+        uint32_t gid_next = lcd_font_lut_gid(lut, unicode_letter_next);
+        if (gid_next == LCD_FONT_GID_UNKNOWN) {
+            return __real_lv_font_get_glyph_dsc_fmt_txt(font, dsc_out, unicode_letter, unicode_letter_next);
+        }
+        if (gid_next != 0) {
+            kvalue = lcd_font_lut_kern(lut, fdsc, gid, gid_next);
+        }
+    }
+
+    const lv_font_fmt_txt_glyph_dsc_t *gdsc = &fdsc->glyph_dsc[gid];
+    int32_t kv = ((int32_t) kvalue * fdsc->kern_scale) >> 4;
+    uint32_t adv_w = gdsc->adv_w;
+    if (is_tab) {
+        adv_w *= 2;
+    }
+    adv_w += kv;
+    adv_w = (adv_w + (1 << 3)) >> 4;
+
+    dsc_out->adv_w = adv_w;
+    dsc_out->box_h = gdsc->box_h;
+    dsc_out->box_w = is_tab ? gdsc->box_w * 2 : gdsc->box_w;
+    dsc_out->ofs_x = gdsc->ofs_x;
+    dsc_out->ofs_y = gdsc->ofs_y;
+    dsc_out->format = (uint8_t) fdsc->bpp;
+    dsc_out->is_placeholder = false;
+    dsc_out->gid.index = gid;
+    return true;
+}
+
+// glyph id of a letter from LVGL's own lookup
+static uint32_t lcd_font_real_gid(const lv_font_t *font, uint32_t letter) {
+    lv_font_glyph_dsc_t dsc = {0};
+    if (!__real_lv_font_get_glyph_dsc_fmt_txt(font, &dsc, letter, 0)) {
+        return 0;
+    }
+    return dsc.gid.index;
+}
+
+static esp_err_t lcd_font_lut_add_symbol(lcd_font_lut_t *lut, uint32_t letter, uint32_t *count) {
+    uint32_t gid = lcd_font_real_gid(lut->font, letter);
+    if (gid == 0) {
+        return ESP_OK;
+    }
+    ESP_RETURN_ON_FALSE(*count < LVGL_FONT_LUT_SYMBOL_SLOTS / 2, ESP_ERR_NO_MEM, TAG,
+                        "more than %d symbols in the font", LVGL_FONT_LUT_SYMBOL_SLOTS / 2);
+    for (uint32_t i = lcd_font_hash(letter);; i++) {
+        lcd_font_symbol_slot_t *slot = &lut->symbols[i & (LVGL_FONT_LUT_SYMBOL_SLOTS - 1)];
+        if (slot->letter == 0) {
+            slot->letter = letter;
+            slot->gid = gid;
+            (*count)++;
+            return ESP_OK;
+        }
+    }
+}
+
+// enumerate the letters of the cmaps overlapping the symbol range
+static esp_err_t lcd_font_lut_build_symbols(lcd_font_lut_t *lut, const lv_font_fmt_txt_dsc_t *fdsc) {
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < fdsc->cmap_num; i++) {
+        const lv_font_fmt_txt_cmap_t *cmap = &fdsc->cmaps[i];
+        bool sparse = cmap->type == LV_FONT_FMT_TXT_CMAP_SPARSE_TINY || cmap->type == LV_FONT_FMT_TXT_CMAP_SPARSE_FULL;
+        uint32_t length = sparse ? cmap->list_length : cmap->range_length;
+        for (uint32_t j = 0; j < length; j++) {
+            uint32_t letter = cmap->range_start + (sparse ? cmap->unicode_list[j] : j);
+            if (letter >= LCD_FONT_SYMBOL_FIRST && letter <= LCD_FONT_SYMBOL_LAST) {
+                ESP_RETURN_ON_ERROR(lcd_font_lut_add_symbol(lut, letter, &count), TAG, "symbol table full");
+            }
+        }
+    }
+    return ESP_OK;
+}
+
+static esp_err_t lcd_font_lut_build_kern_pairs(lcd_font_lut_t *lut, const lv_font_fmt_txt_dsc_t *fdsc) {
+    if (fdsc->kern_dsc == NULL || fdsc->kern_classes) {
+        return ESP_OK;
+    }
+    const lv_font_fmt_txt_kern_pair_t *kdsc = fdsc->kern_dsc;
+    ESP_RETURN_ON_FALSE(kdsc->glyph_ids_size <= 1, ESP_ERR_NOT_SUPPORTED, TAG, "invalid kerning pair size");
+    ESP_RETURN_ON_FALSE(kdsc->pair_cnt <= LVGL_FONT_LUT_MAX_KERN_PAIRS, ESP_ERR_NOT_SUPPORTED, TAG,
+                        "%d kerning pairs, more than %d", (int) kdsc->pair_cnt, LVGL_FONT_LUT_MAX_KERN_PAIRS);
+
+    // at most half full
+    uint32_t slots = 16;
+    while (slots < kdsc->pair_cnt * 2) {
+        slots <<= 1;
+    }
+    lut->kern_pairs = heap_caps_calloc(slots, sizeof(lcd_font_kern_slot_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    ESP_RETURN_ON_FALSE(lut->kern_pairs != NULL, ESP_ERR_NO_MEM, TAG, "no memory for the kerning pairs");
+    lut->kern_mask = slots - 1;
+
+    for (uint32_t p = 0; p < kdsc->pair_cnt; p++) {
+        uint32_t left;
+        uint32_t right;
+        if (kdsc->glyph_ids_size == 0) {
+            const uint8_t *ids = kdsc->glyph_ids;
+            left = ids[p * 2];
+            right = ids[p * 2 + 1];
+        } else {
+            const uint16_t *ids = kdsc->glyph_ids;
+            left = ids[p * 2];
+            right = ids[p * 2 + 1];
+        }
+        uint32_t pair = left << 16 | right;
+        if (left == 0 || right == 0) {
+            continue;
+        }
+        for (uint32_t i = lcd_font_hash(pair);; i++) {
+            lcd_font_kern_slot_t *slot = &lut->kern_pairs[i & lut->kern_mask];
+            if (slot->pair == 0 || slot->pair == pair) {
+                slot->pair = pair;
+                slot->value = kdsc->values[p];
+                break;
+            }
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t lcd_font_lut_register(const lv_font_t *font) {
+    ESP_RETURN_ON_FALSE(font != NULL, ESP_ERR_INVALID_ARG, TAG, "font is NULL");
+    if (lcd_font_lut_find(font) != NULL) {
+        return ESP_OK;
+    }
+    // fonts pointing to lv_font_get_glyph_dsc_fmt_txt() point to the wrapper
+    ESP_RETURN_ON_FALSE(font->get_glyph_dsc == __wrap_lv_font_get_glyph_dsc_fmt_txt, ESP_ERR_NOT_SUPPORTED, TAG,
+                        "not an LVGL fmt_txt font");
+    unsigned count = atomic_load_explicit(&font_lut_count, memory_order_relaxed);
+    ESP_RETURN_ON_FALSE(count < LVGL_FONT_LUT_MAX_FONTS, ESP_ERR_NO_MEM, TAG, "more than %d fonts",
+                        LVGL_FONT_LUT_MAX_FONTS);
+
+    int64_t start = esp_timer_get_time();
+    lcd_font_lut_t *lut = heap_caps_calloc(1, sizeof(lcd_font_lut_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    ESP_RETURN_ON_FALSE(lut != NULL, ESP_ERR_NO_MEM, TAG, "no memory for the font tables");
+    lut->font = font;
+
+    const lv_font_fmt_txt_dsc_t *fdsc = font->dsc;
+    for (uint32_t letter = 0; letter < LCD_FONT_LATIN1_COUNT; letter++) {
+        lut->latin1[letter] = lcd_font_real_gid(font, letter);
+    }
+    esp_err_t ret = lcd_font_lut_build_symbols(lut, fdsc);
+    if (ret == ESP_OK) {
+        ret = lcd_font_lut_build_kern_pairs(lut, fdsc);
+    }
+    if (ret != ESP_OK) {
+        heap_caps_free(lut->kern_pairs);
+        heap_caps_free(lut);
+        return ret;
+    }
+
+    font_luts[count] = lut;
+    atomic_store_explicit(&font_lut_count, count + 1, memory_order_release);
+    ESP_LOGI(TAG, "Font %d px lookup tables built in %d us", (int) font->line_height,
+             (int) (esp_timer_get_time() - start));
+    return ESP_OK;
+}
+
+void lcd_font_lut_init(void) {
+    const lv_font_t *fonts[] = {
+#if LV_FONT_MONTSERRAT_12
+            &lv_font_montserrat_12,
+#endif
+#if LV_FONT_MONTSERRAT_14
+            &lv_font_montserrat_14,
+#endif
+#if LV_FONT_MONTSERRAT_20
+            &lv_font_montserrat_20,
+#endif
+#if LV_FONT_MONTSERRAT_24
+            &lv_font_montserrat_24,
+#endif
+            LV_FONT_DEFAULT,
+    };
+    for (size_t i = 0; i < sizeof(fonts) / sizeof(fonts[0]); i++) {
+        lcd_font_lut_register(fonts[i]);
+    }
+}
@@ -0,0 +1,155 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Glyph bitmap cache
+//
+// lv_font_get_bitmap_fmt_txt() unpacks (or decompresses) the 1/2/4 bpp glyph bitmap from the font data into LVGL's
+// A8 glyph buffer on every letter drawn. It is wrapped at link time (-Wl,--wrap, see CMakeLists.txt), so the fonts
+// referencing it go through an lv_cache LRU of ready A8 glyphs in internal SRAM, keyed by (font, glyph id, bpp).
+//
+// The built-in fonts are const and have no release_glyph callback, so a cached glyph can't be handed to the renderer
+// and released afterwards. A hit is a copy of the A8 rows into LVGL's glyph buffer instead, the font data isn't read.
+// The key is the font's address, a font freed at run time has to be dropped (lcd_glyph_cache_drop_font()) before the
+// address can be reused by another font.
+
+#include <string.h>
+#include <stdatomic.h>
+#include <esp_log.h>
+#include <esp_heap_caps.h>
+#include "t_display_s3.h"
+#include "t_display_s3_priv.h"
+#include "misc/cache/lv_cache_private.h"
+
+static const char *TAG = "esp_idf_t_display_s3_glyph";
+
+const void *__real_lv_font_get_bitmap_fmt_txt(lv_font_glyph_dsc_t *g_dsc, lv_draw_buf_t *draw_buf);
+const void *__wrap_lv_font_get_bitmap_fmt_txt(lv_font_glyph_dsc_t *g_dsc, lv_draw_buf_t *draw_buf);
+
+// cache node, slot.size (the A8 bitmap size) has to be the first member for the size based LRU
+typedef struct {
+    lv_cache_slot_size_t slot;
+    const lv_font_t *font;
+    uint32_t gid;
+    uint8_t bpp;
+    uint8_t *data;
+} lcd_glyph_t;
+
+typedef struct {
+    lv_font_glyph_dsc_t *g_dsc;
+    lv_draw_buf_t *draw_buf;
+    bool created;               // the glyph was unpacked into draw_buf by this lookup
+} lcd_glyph_create_ctx_t;
+
+static lv_cache_t *glyph_cache;
+static atomic_uint hits;
+static atomic_uint misses;
+static atomic_uint evictions;
+// largest glyph id cached so far, of any font
+static atomic_uint max_gid;
+
+static lv_cache_compare_res_t lcd_glyph_compare_cb(const lcd_glyph_t *lhs, const lcd_glyph_t *rhs) {
+    if (lhs->font != rhs->font) {
+        return lhs->font > rhs->font ? 1 : -1;
+    }
+    if (lhs->gid != rhs->gid) {
+        return lhs->gid > rhs->gid ? 1 : -1;
+    }
+    if (lhs->bpp != rhs->bpp) {
+        return lhs->bpp > rhs->bpp ? 1 : -1;
+    }
+    return 0;
+}
+
+// unpack the glyph into LVGL's glyph buffer and keep a copy, runs under the cache lock
+static bool lcd_glyph_create_cb(lcd_glyph_t *glyph, lcd_glyph_create_ctx_t *ctx) {
+    atomic_fetch_add(&misses, 1);
+
+    if (__real_lv_font_get_bitmap_fmt_txt(ctx->g_dsc, ctx->draw_buf) == NULL) {
+        return false;
+    }
+    glyph->data = heap_caps_malloc(glyph->slot.size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (glyph->data == NULL) {
+        return false;
+    }
+    memcpy(glyph->data, ctx->draw_buf->data, glyph->slot.size);
+    ctx->created = true;
+    unsigned gid = atomic_load(&max_gid);
+    while (glyph->gid > gid && !atomic_compare_exchange_weak(&max_gid, &gid, glyph->gid)) {
+    }
+    return true;
+}
+
+// glyphs are removed to make room for new ones and with their font
+static void lcd_glyph_free_cb(lcd_glyph_t *glyph, void *user_data) {
+    LV_UNUSED(user_data);
+    heap_caps_free(glyph->data);
+    glyph->data = NULL;
+    atomic_fetch_add(&evictions, 1);
+}
+
+const void *__wrap_lv_font_get_bitmap_fmt_txt(lv_font_glyph_dsc_t *g_dsc, lv_draw_buf_t *draw_buf) {
+    const lv_font_t *font = g_dsc->resolved_font;
+    if (glyph_cache == NULL || draw_buf == NULL || g_dsc->gid.index == 0) {
+        return __real_lv_font_get_bitmap_fmt_txt(g_dsc, draw_buf);
+    }
+
+    lcd_glyph_t key = {
+            .slot.size = draw_buf->header.stride * g_dsc->box_h,
+            .font = font,
+            .gid = g_dsc->gid.index,
+            .bpp = ((const lv_font_fmt_txt_dsc_t *) font->dsc)->bpp,
+    };
+    if (key.slot.size == 0 || key.slot.size > LVGL_GLYPH_CACHE_SIZE) {
+        return __real_lv_font_get_bitmap_fmt_txt(g_dsc, draw_buf);
+    }
+
+    lcd_glyph_create_ctx_t ctx = {
+            .g_dsc = g_dsc,
+            .draw_buf = draw_buf,
+    };
+    lv_cache_entry_t *entry = lv_cache_acquire_or_create(glyph_cache, &key, &ctx);
+    if (entry == NULL) {
+        return __real_lv_font_get_bitmap_fmt_txt(g_dsc, draw_buf);
+    }
+
+    if (!ctx.created) {
+        const lcd_glyph_t *glyph = lv_cache_entry_get_data(entry);
+        memcpy(draw_buf->data, glyph->data, glyph->slot.size);
+        atomic_fetch_add(&hits, 1);
+    }
+    lv_cache_release(glyph_cache, entry, NULL);
+    return draw_buf;
+}
+
+void lcd_glyph_cache_init(void) {
+    glyph_cache = lv_cache_create(&lv_cache_class_lru_rb_size, sizeof(lcd_glyph_t), LVGL_GLYPH_CACHE_SIZE,
+                                  (lv_cache_ops_t) {
+                                          .compare_cb = (lv_cache_compare_cb_t) lcd_glyph_compare_cb,
+                                          .create_cb = (lv_cache_create_cb_t) lcd_glyph_create_cb,
+                                          .free_cb = (lv_cache_free_cb_t) lcd_glyph_free_cb,
+                                  });
+    lv_cache_set_name(glyph_cache, "GLYPH");
+    ESP_LOGI(TAG, "Glyph cache %d KB (SRAM)", LVGL_GLYPH_CACHE_SIZE / 1024);
+}
+
+void lcd_glyph_cache_drop_font(const lv_font_t *font) {
+    if (glyph_cache == NULL || font == NULL || font->get_glyph_bitmap != __wrap_lv_font_get_bitmap_fmt_txt) {
+        return;
+    }
+    // lv_cache can't walk the entries of one font, drop every glyph id it could have
+    lcd_glyph_t key = {
+            .font = font,
+            .bpp = ((const lv_font_fmt_txt_dsc_t *) font->dsc)->bpp,
+    };
+    unsigned last_gid = atomic_load(&max_gid);
+    for (key.gid = 1; key.gid <= last_gid; key.gid++) {
+        lv_cache_drop(glyph_cache, &key, NULL);
+    }
+}
+
+void lcd_get_glyph_cache_stats(lcd_glyph_cache_stats_t *stats) {
+    stats->hits = atomic_load(&hits);
+    stats->misses = atomic_load(&misses);
+    stats->evictions = atomic_load(&evictions);
+    stats->cached_bytes = glyph_cache != NULL ? lv_cache_get_size(glyph_cache, NULL) : 0;
+}
@@ -0,0 +1,207 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Input event channel
+//
+// Producers (button callbacks, timers, sensor tasks) hand their input to the UI through lock-free single producer /
+// single consumer rings instead of writing shared variables the UI reads. Each producer task gets its own ring
+// (lcd_input_ring_create()), lcd_input_post() timestamps the event, copies it into the ring and notifies the
+// consumer, it never blocks and never takes a lock: a full ring drops the event and counts it. The consumer task
+// drains every ring in batches of up to LCD_INPUT_BATCH_SIZE events under a single lvgl_port_lock
+// (lcd_input_drain()), so the producers keep their latency and the handler sees a consistent order per producer.
+// Batches with button events are followed to the pixels they change by the input latency probes.
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <esp_log.h>
+#include <esp_check.h>
+#include <esp_timer.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "t_display_s3.h"
+
+static const char *TAG = "esp_idf_t_display_s3_input";
+
+struct lcd_input_ring_t {
+    // head is only written by the producer, tail by the consumer
+    atomic_uint head;
+    atomic_uint tail;
+    atomic_uint dropped;
+    uint32_t mask;
+    lcd_input_event_t *events;
+};
+
+typedef struct {
+    lcd_input_ring_handle_t rings[LCD_INPUT_MAX_RINGS];
+    atomic_uint ring_count;
+    TaskHandle_t consumer;
+    atomic_uint posted;
+    // updated by the consumer under input_lock
+    lcd_input_stats_t stats;
+    uint64_t latency_sum_us;
+} lcd_input_ctx_t;
+
+static lcd_input_ctx_t input_ctx;
+static portMUX_TYPE input_lock = portMUX_INITIALIZER_UNLOCKED;
+
+esp_err_t lcd_input_ring_create(uint32_t size, lcd_input_ring_handle_t *ret_ring) {
+    ESP_RETURN_ON_FALSE(ret_ring && size >= 2 && (size & (size - 1)) == 0, ESP_ERR_INVALID_ARG, TAG,
+                        "size must be a power of 2");
+    lcd_input_ring_handle_t ring = calloc(1, sizeof(struct lcd_input_ring_t));
+    ESP_RETURN_ON_FALSE(ring, ESP_ERR_NO_MEM, TAG, "no memory for input ring");
+    ring->events = calloc(size, sizeof(lcd_input_event_t));
+    if (ring->events == NULL) {
+        free(ring);
+        ESP_LOGE(TAG, "no memory for %" PRIu32 " input events", size);
+        return ESP_ERR_NO_MEM;
+    }
+    ring->mask = size - 1;
+
+    portENTER_CRITICAL(&input_lock);
+    uint32_t count = atomic_load(&input_ctx.ring_count);
+    if (count < LCD_INPUT_MAX_RINGS) {
+        input_ctx.rings[count] = ring;
+        atomic_store_explicit(&input_ctx.ring_count, count + 1, memory_order_release);
+    }
+    portEXIT_CRITICAL(&input_lock);
+    if (count >= LCD_INPUT_MAX_RINGS) {
+        free(ring->events);
+        free(ring);
+        ESP_LOGE(TAG, "more than %d input rings", LCD_INPUT_MAX_RINGS);
+        return ESP_ERR_NO_MEM;
+    }
+
+    *ret_ring = ring;
+    return ESP_OK;
+}
+
+bool lcd_input_post(lcd_input_ring_handle_t ring, lcd_input_type_t type, uint8_t id, int32_t value) {
+    return lcd_input_post_at(ring, type, id, value, esp_timer_get_time());
+}
+
+bool lcd_input_post_at(lcd_input_ring_handle_t ring, lcd_input_type_t type, uint8_t id, int32_t value, int64_t time_us) {
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head - tail > ring->mask) {
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+        return false;
+    }
+
+    lcd_input_event_t *event = &ring->events[head & ring->mask];
+    event->time_us = time_us;
+    event->type = type;
+    event->id = id;
+    event->value = value;
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    atomic_fetch_add_explicit(&input_ctx.posted, 1, memory_order_relaxed);
+
+    TaskHandle_t consumer = input_ctx.consumer;
+    if (consumer != NULL) {
+        xTaskNotifyGive(consumer);
+    }
+    return true;
+}
+
+static bool lcd_input_pending(uint32_t ring_count) {
+    for (uint32_t i = 0; i < ring_count; i++) {
+        lcd_input_ring_handle_t ring = input_ctx.rings[i];
+        if (atomic_load_explicit(&ring->head, memory_order_acquire) !=
+            atomic_load_explicit(&ring->tail, memory_order_relaxed)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// hand the events of one ring to the handler, in batches
+static uint32_t lcd_input_drain_ring(lcd_input_ring_handle_t ring, lcd_input_handler_t handler, void *user_data) {
+    lcd_input_event_t batch[LCD_INPUT_BATCH_SIZE];
+    uint32_t drained = 0;
+    while (1) {
+        uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        uint32_t count = head - tail;
+        if (count == 0) {
+            return drained;
+        }
+        if (count > LCD_INPUT_BATCH_SIZE) {
+            count = LCD_INPUT_BATCH_SIZE;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            batch[i] = ring->events[(tail + i) & ring->mask];
+        }
+        // the slots can be reused while the handler runs
+        atomic_store_explicit(&ring->tail, tail + count, memory_order_release);
+
+        int64_t now = esp_timer_get_time();
+        portENTER_CRITICAL(&input_lock);
+        for (uint32_t i = 0; i < count; i++) {
+            uint32_t latency_us = now - batch[i].time_us;
+            input_ctx.latency_sum_us += latency_us;
+            if (latency_us > input_ctx.stats.max_latency_us) {
+                input_ctx.stats.max_latency_us = latency_us;
+            }
+        }
+        input_ctx.stats.batches++;
+        input_ctx.stats.handled += count;
+        if (count > input_ctx.stats.max_batch) {
+            input_ctx.stats.max_batch = count;
+        }
+        portEXIT_CRITICAL(&input_lock);
+
+        // follow the oldest button event of the batch to the pixels the handler changes
+        int64_t input_us = INT64_MAX;
+        for (uint32_t i = 0; i < count; i++) {
+            if (batch[i].type == LCD_INPUT_BUTTON && batch[i].time_us < input_us) {
+                input_us = batch[i].time_us;
+            }
+        }
+        if (input_us != INT64_MAX) {
+            lcd_latency_input_begin(input_us);
+        }
+        handler(batch, count, user_data);
+        if (input_us != INT64_MAX) {
+            lcd_latency_input_end();
+        }
+        drained += count;
+    }
+}
+
+uint32_t lcd_input_drain(lcd_input_handler_t handler, void *user_data, uint32_t timeout_ms) {
+    input_ctx.consumer = xTaskGetCurrentTaskHandle();
+    uint32_t ring_count = atomic_load_explicit(&input_ctx.ring_count, memory_order_acquire);
+    if (!lcd_input_pending(ring_count)) {
+        ulTaskNotifyTake(pdTRUE, timeout_ms == portMAX_DELAY ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms));
+        ring_count = atomic_load_explicit(&input_ctx.ring_count, memory_order_acquire);
+        if (!lcd_input_pending(ring_count)) {
+            return 0;
+        }
+    }
+
+    uint32_t drained = 0;
+    if (lvgl_port_lock(0)) {
+        for (uint32_t i = 0; i < ring_count; i++) {
+            drained += lcd_input_drain_ring(input_ctx.rings[i], handler, user_data);
+        }
+        lvgl_port_unlock();
+    }
+
+    portENTER_CRITICAL(&input_lock);
+    input_ctx.stats.drains++;
+    portEXIT_CRITICAL(&input_lock);
+    return drained;
+}
+
+void lcd_input_get_stats(lcd_input_stats_t *stats) {
+    portENTER_CRITICAL(&input_lock);
+    *stats = input_ctx.stats;
+    stats->avg_latency_us = stats->handled > 0 ? input_ctx.latency_sum_us / stats->handled : 0;
+    portEXIT_CRITICAL(&input_lock);
+    stats->posted = atomic_load(&input_ctx.posted);
+    stats->dropped = 0;
+    uint32_t ring_count = atomic_load_explicit(&input_ctx.ring_count, memory_order_acquire);
+    for (uint32_t i = 0; i < ring_count; i++) {
+        stats->dropped += atomic_load(&input_ctx.rings[i]->dropped);
+    }
+}
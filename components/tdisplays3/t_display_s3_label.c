@@ -0,0 +1,182 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Label text updates
+//
+// lv_label_set_text() / lv_label_set_text_fmt() always re-measure the text and invalidate the whole label, even when
+// the text didn't change (e.g. "4123 mV" re-set by every battery update). Both are wrapped at link time (-Wl,--wrap,
+// see CMakeLists.txt):
+//  - setting the text the label already shows is a no-op,
+//  - a single line label (WRAP / CLIP) whose new text measures the same size as the old one, which is what the label
+//    keeps in its size cache (re-measured by LVGL whenever the font, width or letter / line space change), gets the
+//    text swapped in place and only the span of letters that changed is invalidated,
+//  - everything else goes through LVGL.
+// With LV_USE_BIDI or LV_USE_ARABIC_PERSIAN_CHARS the label keeps the text LVGL reordered / shaped rather than the text
+// it was given, so every update goes through LVGL.
+
+#include <stdarg.h>
+#include <string.h>
+#include "t_display_s3.h"
+#include "t_display_s3_priv.h"
+#include "widgets/label/lv_label_private.h"
+#include "core/lv_obj_private.h"
+#include "misc/lv_text_private.h"
+
+void __real_lv_label_set_text(lv_obj_t *obj, const char *text);
+void __wrap_lv_label_set_text(lv_obj_t *obj, const char *text);
+void __real_lv_label_set_text_fmt(lv_obj_t *obj, const char *fmt, ...);
+void __wrap_lv_label_set_text_fmt(lv_obj_t *obj, const char *fmt, ...);
+
+// only updated from set_text, i.e. under the LVGL lock
+static lcd_label_stats_t label_stats;
+
+#if !LV_USE_BIDI && !LV_USE_ARABIC_PERSIAN_CHARS
+// start of the UTF-8 letter the byte at pos belongs to
+static uint32_t lcd_label_letter_start(const char *text, uint32_t pos) {
+    while (pos > 0 && (text[pos] & 0xC0) == 0x80) {
+        pos--;
+    }
+    return pos;
+}
+
+// swap a same size single line text in place and invalidate the letters that changed, false if it doesn't apply
+static bool lcd_label_set_text_span(lv_obj_t *obj, const char *text) {
+    lv_label_t *label = (lv_label_t *) obj;
+
+    if (label->static_txt || label->invalid_size_cache ||
+        (label->long_mode != LV_LABEL_LONG_WRAP && label->long_mode != LV_LABEL_LONG_CLIP) ||
+        strchr(text, '\n') != NULL || strchr(label->text, '\n') != NULL) {
+        return false;
+    }
+#if LV_LABEL_TEXT_SELECTION
+    if (label->sel_start != LV_DRAW_LABEL_NO_TXT_SEL || label->sel_end != LV_DRAW_LABEL_NO_TXT_SEL) {
+        return false;
+    }
+#endif
+
+    // measure the new text the same way the label fills its size cache (LV_EVENT_GET_SELF_SIZE)
+    const lv_font_t *font = lv_obj_get_style_text_font(obj, LV_PART_MAIN);
+    int32_t letter_space = lv_obj_get_style_text_letter_space(obj, LV_PART_MAIN);
+    int32_t line_space = lv_obj_get_style_text_line_space(obj, LV_PART_MAIN);
+    int32_t font_h = lv_font_get_line_height(font);
+    lv_text_flag_t flag = label->expand ? LV_TEXT_FLAG_EXPAND : LV_TEXT_FLAG_NONE;
+    int32_t w = lv_obj_get_content_width(obj);
+    if (lv_obj_get_style_width(obj, LV_PART_MAIN) == LV_SIZE_CONTENT && !obj->w_layout) {
+        w = LV_COORD_MAX;
+    }
+    w = LV_MIN(w, lv_obj_get_style_max_width(obj, LV_PART_MAIN));
+
+    lv_point_t size;
+    lv_text_get_size(&size, text, font, letter_space, line_space, w, flag);
+    if (size.x != label->size_cache.x || size.y != label->size_cache.y || size.y > font_h) {
+        return false;
+    }
+
+    // common prefix and suffix, less one letter each as the kerning to the changed letters may differ
+    uint32_t old_len = strlen(label->text);
+    uint32_t new_len = strlen(text);
+    uint32_t prefix = 0;
+    while (prefix < old_len && prefix < new_len && label->text[prefix] == text[prefix]) {
+        prefix++;
+    }
+    prefix = lcd_label_letter_start(text, prefix);
+    prefix = prefix > 0 ? lcd_label_letter_start(text, prefix - 1) : 0;
+
+    uint32_t suffix = 0;
+    while (suffix < old_len - prefix && suffix < new_len - prefix &&
+           label->text[old_len - 1 - suffix] == text[new_len - 1 - suffix]) {
+        suffix++;
+    }
+    uint32_t suffix_start = new_len - suffix;
+    while (suffix_start < new_len && (text[suffix_start] & 0xC0) == 0x80) {
+        suffix_start++;
+    }
+    if (suffix_start < new_len) {
+        suffix_start++;
+        while (suffix_start < new_len && (text[suffix_start] & 0xC0) == 0x80) {
+            suffix_start++;
+        }
+    }
+    suffix = new_len - suffix_start;
+
+    char *new_text = lv_realloc(label->text, new_len + 1);
+    if (new_text == NULL) {
+        return false;
+    }
+    memcpy(new_text, text, new_len + 1);
+    label->text = new_text;
+#if LV_LABEL_LONG_TXT_HINT
+    label->hint.line_start = -1;
+#endif
+
+    // the text is as wide as before and the prefix / suffix didn't change, so the changed span sits at the same x
+    // in the old and new text, shifted by the alignment of the line
+    lv_area_t txt_coords;
+    lv_obj_get_content_coords(obj, &txt_coords);
+    int32_t x = txt_coords.x1 + label->offset.x;
+    lv_text_align_t align = lv_obj_calculate_style_text_align(obj, LV_PART_MAIN, text);
+    if (align == LV_TEXT_ALIGN_CENTER) {
+        x += lv_area_get_width(&txt_coords) / 2 - size.x / 2;
+    } else if (align == LV_TEXT_ALIGN_RIGHT) {
+        x += lv_area_get_width(&txt_coords) - size.x;
+    }
+
+    // font_h / 4 for italic and other letters drawn outside their advance, as LV_EVENT_REFR_EXT_DRAW_SIZE does
+    lv_area_t span = {
+            .x1 = x + lv_text_get_width(text, prefix, font, letter_space) - font_h / 4,
+            .y1 = txt_coords.y1 + label->offset.y - font_h / 4,
+            .x2 = x + size.x - lv_text_get_width(&text[suffix_start], suffix, font, letter_space) - 1 + font_h / 4,
+            .y2 = txt_coords.y1 + label->offset.y + size.y - 1 + font_h / 4,
+    };
+    lv_obj_invalidate_area(obj, &span);
+
+    label_stats.partial_updates++;
+    label_stats.invalidated_px += lv_area_get_size(&span);
+    return true;
+}
+#endif
+
+void __wrap_lv_label_set_text(lv_obj_t *obj, const char *text) {
+    label_stats.set_text_calls++;
+
+#if !LV_USE_BIDI && !LV_USE_ARABIC_PERSIAN_CHARS
+    lv_label_t *label = (lv_label_t *) obj;
+    // NULL or the label's own buffer asks LVGL to refresh the text, which may have been modified in place
+    if (text != NULL && text != label->text && label->text != NULL && !label->static_txt) {
+        if (strcmp(text, label->text) == 0) {
+            label_stats.skipped_updates++;
+            return;
+        }
+        if (lcd_label_set_text_span(obj, text)) {
+            return;
+        }
+    }
+#endif
+
+    label_stats.full_updates++;
+    label_stats.invalidated_px += lv_area_get_size(&obj->coords);
+    __real_lv_label_set_text(obj, text);
+}
+
+void __wrap_lv_label_set_text_fmt(lv_obj_t *obj, const char *fmt, ...) {
+    if (fmt == NULL) {
+        __wrap_lv_label_set_text(obj, NULL);
+        return;
+    }
+
+    va_list args;
+    va_start(args, fmt);
+    char *text = lv_text_set_text_vfmt(fmt, args);
+    va_end(args);
+    if (text == NULL) {
+        return;
+    }
+    __wrap_lv_label_set_text(obj, text);
+    lv_free(text);
+}
+
+void lcd_get_label_stats(lcd_label_stats_t *stats) {
+    lvgl_port_lock(0);
+    *stats = label_stats;
+    lvgl_port_unlock();
+}
@@ -0,0 +1,208 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Input latency probes
+//
+// An input handled between lcd_latency_input_begin() and lcd_latency_input_end() takes a probe (up to
+// LCD_LATENCY_MAX_PROBES at once) that follows it to the panel:
+//  - every area it invalidates is collected, lv_inv_area() is wrapped at link time (see CMakeLists.txt),
+//  - the next refresh renders them (LV_EVENT_REFR_START),
+//  - flush_cb numbers the stripes, the probe keeps the first and the last one that overlap its areas,
+//  - the flush pipeline reports the stripes whose i80 DMA is done (on_color_trans_done, or right away for stripes the
+//    row hashes skipped), the probe is done with its last stripe.
+// An input that invalidated nothing, or whose areas ended up hidden, is dropped. The latencies from the input
+// timestamp to each step are kept for the last LCD_LATENCY_SAMPLES inputs and reported through lcd_trace_get_stats().
+
+#include <string.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include "freertos/FreeRTOS.h"
+#include "t_display_s3.h"
+#include "t_display_s3_priv.h"
+#include "display/lv_display_private.h"
+#include "misc/lv_area_private.h"
+
+void __real_lv_inv_area(lv_display_t *disp, const lv_area_t *area_p);
+void __wrap_lv_inv_area(lv_display_t *disp, const lv_area_t *area_p);
+
+typedef enum {
+    LCD_LATENCY_PROBE_FREE,
+    LCD_LATENCY_PROBE_INPUT,        // the input is being handled
+    LCD_LATENCY_PROBE_INVALIDATED,  // waiting for the refresh
+    LCD_LATENCY_PROBE_RENDERING,
+    LCD_LATENCY_PROBE_FLUSHING,     // waiting for the DMA of the last stripe
+} lcd_latency_probe_state_t;
+
+typedef struct {
+    lcd_latency_probe_state_t state;
+    int64_t input_us;
+    int64_t invalidate_us;
+    int64_t render_us;
+    int64_t flush_us;
+    lv_area_t area;                 // bounding box of the invalidated areas
+    uint32_t last_seq;              // last stripe showing the areas, 0: none yet
+} lcd_latency_probe_t;
+
+typedef struct {
+    lcd_latency_probe_t probes[LCD_LATENCY_MAX_PROBES];
+    int open;                       // probe of the input being handled, -1: none
+    uint32_t flush_seq;             // stripes flushed
+    uint32_t done_seq;              // stripes sent
+    uint32_t samples[LCD_LATENCY_METRIC_MAX][LCD_LATENCY_SAMPLES];
+    uint32_t sample_count;          // inputs followed to the panel
+} lcd_latency_ctx_t;
+
+static lcd_latency_ctx_t latency_ctx = {
+        .open = -1,
+};
+static portMUX_TYPE latency_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// called with latency_lock held
+static void lcd_latency_probe_done(lcd_latency_probe_t *probe, int64_t now_us) {
+    uint32_t idx = latency_ctx.sample_count++ % LCD_LATENCY_SAMPLES;
+    latency_ctx.samples[LCD_LATENCY_TO_INVALIDATE][idx] = (uint32_t) (probe->invalidate_us - probe->input_us);
+    latency_ctx.samples[LCD_LATENCY_TO_RENDER][idx] = (uint32_t) (probe->render_us - probe->input_us);
+    latency_ctx.samples[LCD_LATENCY_TO_FLUSH][idx] = (uint32_t) (probe->flush_us - probe->input_us);
+    latency_ctx.samples[LCD_LATENCY_TO_PHOTON][idx] = (uint32_t) (now_us - probe->input_us);
+    probe->state = LCD_LATENCY_PROBE_FREE;
+}
+
+void lcd_latency_input_begin(int64_t input_us) {
+    portENTER_CRITICAL(&latency_lock);
+    if (latency_ctx.open < 0) {
+        for (int i = 0; i < LCD_LATENCY_MAX_PROBES; i++) {
+            if (latency_ctx.probes[i].state == LCD_LATENCY_PROBE_FREE) {
+                latency_ctx.probes[i] = (lcd_latency_probe_t) {
+                        .state = LCD_LATENCY_PROBE_INPUT,
+                        .input_us = input_us,
+                };
+                latency_ctx.open = i;
+                break;
+            }
+        }
+    }
+    portEXIT_CRITICAL(&latency_lock);
+}
+
+void lcd_latency_input_end(void) {
+    portENTER_CRITICAL(&latency_lock);
+    if (latency_ctx.open >= 0) {
+        lcd_latency_probe_t *probe = &latency_ctx.probes[latency_ctx.open];
+        if (probe->state == LCD_LATENCY_PROBE_INPUT) {
+            // nothing to show
+            probe->state = LCD_LATENCY_PROBE_FREE;
+        }
+        latency_ctx.open = -1;
+    }
+    portEXIT_CRITICAL(&latency_lock);
+}
+
+void __wrap_lv_inv_area(lv_display_t *disp, const lv_area_t *area_p) {
+    __real_lv_inv_area(disp, area_p);
+
+    // only the task handling the input holds the LVGL lock, no lock needed to check.
+    // NULL clears the invalid areas, it doesn't add any
+    if (latency_ctx.open < 0 || area_p == NULL) {
+        return;
+    }
+    if (disp == NULL) {
+        disp = lv_display_get_default();
+    }
+    if (disp == NULL || !lv_display_is_invalidation_enabled(disp) || disp->rendering_in_progress) {
+        return;
+    }
+    lv_area_t area = {0, 0, lv_display_get_horizontal_resolution(disp) - 1,
+                      lv_display_get_vertical_resolution(disp) - 1};
+    if (!lv_area_intersect(&area, &area, area_p)) {
+        return;
+    }
+
+    int64_t now_us = esp_timer_get_time();
+    portENTER_CRITICAL(&latency_lock);
+    if (latency_ctx.open >= 0) {
+        lcd_latency_probe_t *probe = &latency_ctx.probes[latency_ctx.open];
+        if (probe->state == LCD_LATENCY_PROBE_INPUT) {
+            probe->state = LCD_LATENCY_PROBE_INVALIDATED;
+            probe->invalidate_us = now_us;
+            probe->area = area;
+        } else {
+            lv_area_join(&probe->area, &probe->area, &area);
+        }
+    }
+    portEXIT_CRITICAL(&latency_lock);
+}
+
+static void lcd_latency_refr_event_callback(lv_event_t *e) {
+    int64_t now_us = esp_timer_get_time();
+    bool start = lv_event_get_code(e) == LV_EVENT_REFR_START;
+
+    portENTER_CRITICAL(&latency_lock);
+    for (int i = 0; i < LCD_LATENCY_MAX_PROBES; i++) {
+        lcd_latency_probe_t *probe = &latency_ctx.probes[i];
+        if (start && probe->state == LCD_LATENCY_PROBE_INVALIDATED) {
+            probe->state = LCD_LATENCY_PROBE_RENDERING;
+            probe->render_us = now_us;
+        } else if (!start && probe->state == LCD_LATENCY_PROBE_RENDERING) {
+            if (probe->last_seq == 0) {
+                // no stripe showed the areas
+                probe->state = LCD_LATENCY_PROBE_FREE;
+            } else if ((int32_t) (latency_ctx.done_seq - probe->last_seq) >= 0) {
+                lcd_latency_probe_done(probe, now_us);
+            } else {
+                probe->state = LCD_LATENCY_PROBE_FLUSHING;
+            }
+        }
+    }
+    portEXIT_CRITICAL(&latency_lock);
+}
+
+void lcd_latency_init(lv_display_t *disp) {
+    lv_display_add_event_cb(disp, lcd_latency_refr_event_callback, LV_EVENT_REFR_START, NULL);
+    lv_display_add_event_cb(disp, lcd_latency_refr_event_callback, LV_EVENT_REFR_READY, NULL);
+}
+
+uint32_t lcd_latency_flush(const lv_area_t *area) {
+    int64_t now_us = esp_timer_get_time();
+
+    portENTER_CRITICAL(&latency_lock);
+    uint32_t seq = ++latency_ctx.flush_seq;
+    if (seq == 0) {
+        // 0 is no stripe
+        seq = ++latency_ctx.flush_seq;
+    }
+    for (int i = 0; i < LCD_LATENCY_MAX_PROBES; i++) {
+        lcd_latency_probe_t *probe = &latency_ctx.probes[i];
+        if (probe->state == LCD_LATENCY_PROBE_RENDERING && lv_area_is_on(&probe->area, area)) {
+            if (probe->last_seq == 0) {
+                probe->flush_us = now_us;
+            }
+            probe->last_seq = seq;
+        }
+    }
+    portEXIT_CRITICAL(&latency_lock);
+    return seq;
+}
+
+void lcd_latency_stripe_done(uint32_t seq) {
+    int64_t now_us = esp_timer_get_time();
+
+    portENTER_CRITICAL_SAFE(&latency_lock);
+    if ((int32_t) (seq - latency_ctx.done_seq) > 0) {
+        latency_ctx.done_seq = seq;
+    }
+    for (int i = 0; i < LCD_LATENCY_MAX_PROBES; i++) {
+        lcd_latency_probe_t *probe = &latency_ctx.probes[i];
+        if (probe->state == LCD_LATENCY_PROBE_FLUSHING && (int32_t) (latency_ctx.done_seq - probe->last_seq) >= 0) {
+            lcd_latency_probe_done(probe, now_us);
+        }
+    }
+    portEXIT_CRITICAL_SAFE(&latency_lock);
+}
+
+size_t lcd_latency_collect(lcd_latency_metric_t metric, uint32_t *samples, size_t max_samples) {
+    portENTER_CRITICAL(&latency_lock);
+    size_t count = LV_MIN(LV_MIN(latency_ctx.sample_count, LCD_LATENCY_SAMPLES), max_samples);
+    memcpy(samples, latency_ctx.samples[metric], count * sizeof(uint32_t));
+    portEXIT_CRITICAL(&latency_lock);
+    return count;
+}
@@ -0,0 +1,273 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// SIMD blend kernel checks
+//
+// lcd_blend_check_kernels() runs a fill and an RGB565 image blend kernel and the loops LVGL 9.2 runs without them
+// (lv_draw_sw_blend_to_rgb565.c: 32-bit stores for a simple fill, a memcpy per row for an RGB565 image) on copies of
+// the same buffer, and compares every byte, the row padding the kernels must not touch included. The widths cover the
+// kernels' short (< 16 px) and 16 byte block paths, every 2 byte alignment of the destination and the source within
+// 16 bytes, with and without row padding. lcd_blend_check() checks the esp_lvgl_port kernels t_display_s3_lv_blend.h
+// maps into LVGL (CONFIG_TDISPLAYS3_BLEND_SELF_TEST), host_sim checks LVGL's own C functions, which keeps the C
+// reference here in step with LVGL. lcd_blend_benchmark() times the esp_lvgl_port kernels and the C loops on a full
+// width area in SRAM and in PSRAM, where LVGL renders.
+
+#include <string.h>
+#include <inttypes.h>
+#include <esp_log.h>
+#include <esp_check.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+#include "lvgl.h"
+#include "draw/sw/blend/lv_draw_sw_blend_private.h"
+#include "t_display_s3.h"
+#include "t_display_s3_priv.h"
+#if LCD_SIMD_BLEND
+#include "t_display_s3_lv_blend.h"
+#endif
+
+static const char *TAG = "esp_idf_t_display_s3_blend";
+
+// checked areas, at every destination / source offset in a 16 byte line, with LCD_BLEND_CHECK_PAD_PX px of row padding
+#define LCD_BLEND_CHECK_MAX_H    3
+#define LCD_BLEND_CHECK_OFFSETS  8
+#define LCD_BLEND_CHECK_PAD_PX   5
+// guard pixels before and after the checked rows
+#define LCD_BLEND_CHECK_GUARD_PX 16
+
+// full width area the benchmark fills / copies LCD_BLEND_BENCH_RUNS times
+#define LCD_BLEND_BENCH_W    LCD_H_RES
+#define LCD_BLEND_BENCH_H    40
+#define LCD_BLEND_BENCH_RUNS 50
+
+static const int32_t check_widths[] = {1, 2, 3, 7, 8, 15, 16, 17, 24, 31, 32, 33, 47, 63, 64, 65, 100};
+#define LCD_BLEND_CHECK_MAX_W 100
+
+#define LCD_BLEND_CHECK_BUF_PX (2 * LCD_BLEND_CHECK_GUARD_PX + LCD_BLEND_CHECK_OFFSETS + \
+        (LCD_BLEND_CHECK_MAX_W + LCD_BLEND_CHECK_OFFSETS + LCD_BLEND_CHECK_PAD_PX) * LCD_BLEND_CHECK_MAX_H)
+
+// LVGL's simple fill without a kernel (lv_draw_sw_blend_color_to_rgb565())
+static void lcd_blend_c_fill(lv_draw_sw_blend_fill_dsc_t *dsc) {
+    uint16_t color16 = lv_color_to_u16(dsc->color);
+    uint32_t c32 = (uint32_t) color16 + ((uint32_t) color16 << 16);
+    uint8_t *row = dsc->dest_buf;
+
+    for (int32_t y = 0; y < dsc->dest_h; y++) {
+        uint16_t *dest16 = (uint16_t *) row;
+        uint16_t *dest_end_final = dest16 + dsc->dest_w;
+        uint32_t *dest_end_mid = (uint32_t *) (dest16 + ((dsc->dest_w - 1) & ~(0xF)));
+        if ((uintptr_t) dest16 & 0x3) {
+            *dest16++ = color16;
+        }
+        uint32_t *dest32 = (uint32_t *) dest16;
+        while (dest32 < dest_end_mid) {
+            dest32[0] = c32;
+            dest32[1] = c32;
+            dest32[2] = c32;
+            dest32[3] = c32;
+            dest32[4] = c32;
+            dest32[5] = c32;
+            dest32[6] = c32;
+            dest32[7] = c32;
+            dest32 += 8;
+        }
+        dest16 = (uint16_t *) dest32;
+        while (dest16 < dest_end_final) {
+            *dest16++ = color16;
+        }
+        row += dsc->dest_stride;
+    }
+}
+
+// LVGL's RGB565 image blend without a kernel (lv_draw_sw_blend_image_to_rgb565(), normal mode, no mask, opa cover)
+static void lcd_blend_c_copy(lv_draw_sw_blend_image_dsc_t *dsc) {
+    uint8_t *dest = dsc->dest_buf;
+    const uint8_t *src = dsc->src_buf;
+
+    for (int32_t y = 0; y < dsc->dest_h; y++) {
+        memcpy(dest, src, dsc->dest_w * sizeof(uint16_t));
+        dest += dsc->dest_stride;
+        src += dsc->src_stride;
+    }
+}
+
+static uint32_t lcd_blend_random(uint32_t *state) {
+    // xorshift32
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static void lcd_blend_random_fill(uint16_t *buf, size_t px, uint32_t *state) {
+    for (size_t i = 0; i < px; i++) {
+        buf[i] = (uint16_t) lcd_blend_random(state);
+    }
+}
+
+esp_err_t lcd_blend_check_kernels(lcd_blend_fill_cb_t fill, lcd_blend_copy_cb_t copy) {
+    esp_err_t ret = ESP_OK;
+    const size_t buf_size = LCD_BLEND_CHECK_BUF_PX * sizeof(uint16_t);
+    uint16_t *simd_buf = heap_caps_aligned_alloc(16, buf_size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    uint16_t *c_buf = heap_caps_aligned_alloc(16, buf_size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    uint16_t *src_buf = heap_caps_aligned_alloc(16, buf_size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    uint32_t random_state = 0x12345678;
+    uint32_t fills = 0;
+    uint32_t copies = 0;
+    ESP_GOTO_ON_FALSE(simd_buf && c_buf && src_buf, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for the checks!");
+    lcd_blend_random_fill(src_buf, LCD_BLEND_CHECK_BUF_PX, &random_state);
+
+    for (size_t i = 0; i < sizeof(check_widths) / sizeof(check_widths[0]); i++) {
+        int32_t w = check_widths[i];
+        for (int32_t h = 1; h <= LCD_BLEND_CHECK_MAX_H; h++) {
+            for (int32_t pad = 0; pad <= LCD_BLEND_CHECK_PAD_PX; pad += LCD_BLEND_CHECK_PAD_PX) {
+                for (int32_t dest_offset = 0; dest_offset < LCD_BLEND_CHECK_OFFSETS; dest_offset++) {
+                    uint32_t dest_stride = (w + pad) * sizeof(uint16_t);
+                    uint16_t *simd_dest = simd_buf + LCD_BLEND_CHECK_GUARD_PX + dest_offset;
+                    uint16_t *c_dest = c_buf + LCD_BLEND_CHECK_GUARD_PX + dest_offset;
+
+                    lcd_blend_random_fill(simd_buf, LCD_BLEND_CHECK_BUF_PX, &random_state);
+                    memcpy(c_buf, simd_buf, buf_size);
+                    uint32_t rgb = lcd_blend_random(&random_state);
+                    lv_draw_sw_blend_fill_dsc_t fill_dsc = {
+                            .dest_w = w,
+                            .dest_h = h,
+                            .dest_stride = dest_stride,
+                            .color = lv_color_make(rgb >> 16, rgb >> 8, rgb),
+                            .opa = LV_OPA_COVER,
+                    };
+                    fill_dsc.dest_buf = simd_dest;
+                    fill(&fill_dsc);
+                    fill_dsc.dest_buf = c_dest;
+                    lcd_blend_c_fill(&fill_dsc);
+                    fills++;
+                    ESP_GOTO_ON_FALSE(memcmp(simd_buf, c_buf, buf_size) == 0, ESP_FAIL, err, TAG,
+                                      "fill differs from LVGL's C path: %" PRIi32 " x %" PRIi32 " px, stride %" PRIu32
+                                      " B, dest offset %" PRIi32 " px", w, h, dest_stride, dest_offset);
+
+                    for (int32_t src_offset = 0; src_offset < LCD_BLEND_CHECK_OFFSETS; src_offset++) {
+                        memcpy(c_buf, simd_buf, buf_size);
+                        lv_draw_sw_blend_image_dsc_t image_dsc = {
+                                .dest_w = w,
+                                .dest_h = h,
+                                .dest_stride = dest_stride,
+                                .src_buf = src_buf + LCD_BLEND_CHECK_GUARD_PX + src_offset,
+                                .src_stride = (w + LCD_BLEND_CHECK_PAD_PX - pad) * sizeof(uint16_t),
+                                .src_color_format = LV_COLOR_FORMAT_RGB565,
+                                .opa = LV_OPA_COVER,
+                                .blend_mode = LV_BLEND_MODE_NORMAL,
+                        };
+                        image_dsc.dest_buf = simd_dest;
+                        copy(&image_dsc);
+                        image_dsc.dest_buf = c_dest;
+                        lcd_blend_c_copy(&image_dsc);
+                        copies++;
+                        ESP_GOTO_ON_FALSE(memcmp(simd_buf, c_buf, buf_size) == 0, ESP_FAIL, err, TAG,
+                                          "image blend differs from LVGL's C path: %" PRIi32 " x %" PRIi32
+                                          " px, dest stride %" PRIu32 " B, dest offset %" PRIi32 " px, src offset %"
+                                          PRIi32 " px", w, h, dest_stride, dest_offset, src_offset);
+                    }
+                }
+            }
+        }
+    }
+    ESP_LOGI(TAG, "blend kernels match LVGL's C path (%" PRIu32 " fills, %" PRIu32 " image blends)", fills, copies);
+
+err:
+    heap_caps_free(simd_buf);
+    heap_caps_free(c_buf);
+    heap_caps_free(src_buf);
+    return ret;
+}
+
+#if LCD_SIMD_BLEND
+
+static void lcd_blend_simd_fill(lv_draw_sw_blend_fill_dsc_t *dsc) {
+    t_display_s3_color_blend_to_rgb565(dsc);
+}
+
+static void lcd_blend_simd_copy(lv_draw_sw_blend_image_dsc_t *dsc) {
+    t_display_s3_rgb565_blend_normal_to_rgb565(dsc);
+}
+
+esp_err_t lcd_blend_check(void) {
+    return lcd_blend_check_kernels(lcd_blend_simd_fill, lcd_blend_simd_copy);
+}
+
+// Mpix/s x 10 of LCD_BLEND_BENCH_RUNS areas
+static uint32_t lcd_blend_mpix_s_x10(int64_t start_us) {
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+    return (uint32_t) ((int64_t) LCD_BLEND_BENCH_W * LCD_BLEND_BENCH_H * LCD_BLEND_BENCH_RUNS * 10 /
+                       (elapsed_us > 0 ? elapsed_us : 1));
+}
+
+static void lcd_blend_benchmark_caps(const char *name, uint32_t caps) {
+    const size_t size = LCD_BLEND_BENCH_W * LCD_BLEND_BENCH_H * sizeof(uint16_t);
+    uint16_t *dest = heap_caps_aligned_alloc(16, size, caps);
+    uint16_t *src = heap_caps_aligned_alloc(16, size, caps);
+    if (dest == NULL || src == NULL) {
+        ESP_LOGE(TAG, "  %s: not enough memory", name);
+        heap_caps_free(dest);
+        heap_caps_free(src);
+        return;
+    }
+    memset(src, 0x5a, size);
+
+    lv_draw_sw_blend_fill_dsc_t fill_dsc = {
+            .dest_buf = dest,
+            .dest_w = LCD_BLEND_BENCH_W,
+            .dest_h = LCD_BLEND_BENCH_H,
+            .dest_stride = LCD_BLEND_BENCH_W * sizeof(uint16_t),
+            .color = lv_color_make(0x12, 0x34, 0x56),
+            .opa = LV_OPA_COVER,
+    };
+    lv_draw_sw_blend_image_dsc_t image_dsc = {
+            .dest_buf = dest,
+            .dest_w = LCD_BLEND_BENCH_W,
+            .dest_h = LCD_BLEND_BENCH_H,
+            .dest_stride = LCD_BLEND_BENCH_W * sizeof(uint16_t),
+            .src_buf = src,
+            .src_stride = LCD_BLEND_BENCH_W * sizeof(uint16_t),
+            .src_color_format = LV_COLOR_FORMAT_RGB565,
+            .opa = LV_OPA_COVER,
+            .blend_mode = LV_BLEND_MODE_NORMAL,
+    };
+
+    int64_t start_us = esp_timer_get_time();
+    for (int i = 0; i < LCD_BLEND_BENCH_RUNS; i++) {
+        t_display_s3_color_blend_to_rgb565(&fill_dsc);
+    }
+    uint32_t simd_fill = lcd_blend_mpix_s_x10(start_us);
+    start_us = esp_timer_get_time();
+    for (int i = 0; i < LCD_BLEND_BENCH_RUNS; i++) {
+        lcd_blend_c_fill(&fill_dsc);
+    }
+    uint32_t c_fill = lcd_blend_mpix_s_x10(start_us);
+    start_us = esp_timer_get_time();
+    for (int i = 0; i < LCD_BLEND_BENCH_RUNS; i++) {
+        t_display_s3_rgb565_blend_normal_to_rgb565(&image_dsc);
+    }
+    uint32_t simd_copy = lcd_blend_mpix_s_x10(start_us);
+    start_us = esp_timer_get_time();
+    for (int i = 0; i < LCD_BLEND_BENCH_RUNS; i++) {
+        lcd_blend_c_copy(&image_dsc);
+    }
+    uint32_t c_copy = lcd_blend_mpix_s_x10(start_us);
+
+    ESP_LOGI(TAG, "  %s fill: SIMD %3" PRIu32 ".%" PRIu32 " Mpix/s, C %3" PRIu32 ".%" PRIu32 " Mpix/s", name,
+             simd_fill / 10, simd_fill % 10, c_fill / 10, c_fill % 10);
+    ESP_LOGI(TAG, "  %s copy: SIMD %3" PRIu32 ".%" PRIu32 " Mpix/s, C %3" PRIu32 ".%" PRIu32 " Mpix/s", name,
+             simd_copy / 10, simd_copy % 10, c_copy / 10, c_copy % 10);
+
+    heap_caps_free(dest);
+    heap_caps_free(src);
+}
+
+void lcd_blend_benchmark(void) {
+    ESP_LOGI(TAG, "Blend benchmark, %d x %d px RGB565, %d runs", LCD_BLEND_BENCH_W, LCD_BLEND_BENCH_H,
+             LCD_BLEND_BENCH_RUNS);
+    lcd_blend_benchmark_caps("SRAM ", MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    lcd_blend_benchmark_caps("PSRAM", MALLOC_CAP_SPIRAM);
+}
+
+#endif // LCD_SIMD_BLEND
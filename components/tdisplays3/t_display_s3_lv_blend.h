@@ -0,0 +1,87 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// LVGL custom draw-sw assembly hooks for the T-Display S3.
+//
+// esp_lvgl_port only wires its ESP32-S3 SIMD blend kernels into LVGL 9.1.x, its esp_lvgl_port_lv_blend.h
+// still uses the 9.1 `_lv_draw_sw_blend_*_dsc_t` names. This header maps the RGB565 kernels onto the LVGL 9.2
+// blend descriptors. It is included by LVGL itself, enable it with:
+//   CONFIG_LV_DRAW_SW_ASM_CUSTOM=y
+//   CONFIG_LV_DRAW_SW_ASM_CUSTOM_INCLUDE="t_display_s3_lv_blend.h"
+// the tdisplays3 component then compiles the kernels and adds this directory to the lvgl include path.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "sdkconfig.h"
+
+#if !CONFIG_LV_DRAW_SW_ASM_CUSTOM
+#warning "t_display_s3_lv_blend.h included, but CONFIG_LV_DRAW_SW_ASM_CUSTOM not set. Assembly rendering not used"
+#elif CONFIG_IDF_TARGET_ESP32S3
+
+#include "draw/sw/blend/lv_draw_sw_blend_private.h"
+
+// RGB565 is the only color format the T-Display S3 renders in, the other formats keep the LVGL C implementation
+#ifndef LV_DRAW_SW_COLOR_BLEND_TO_RGB565
+#define LV_DRAW_SW_COLOR_BLEND_TO_RGB565(dsc) \
+    t_display_s3_color_blend_to_rgb565(dsc)
+#endif
+
+#ifndef LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565
+#define LV_DRAW_SW_RGB565_BLEND_NORMAL_TO_RGB565(dsc) \
+    t_display_s3_rgb565_blend_normal_to_rgb565(dsc)
+#endif
+// the RGB565 byte swap (LCD_I80_SWAP_COLOR_BYTES 0) stays LVGL's own lv_draw_sw_rgb565_swap()
+
+// argument layout expected by the esp_lvgl_port assembly kernels (src/lvgl9/simd)
+typedef struct {
+    uint32_t opa;
+    void *dst_buf;
+    uint32_t dst_w;
+    uint32_t dst_h;
+    uint32_t dst_stride;
+    const void *src_buf;
+    uint32_t src_stride;
+    const lv_opa_t *mask_buf;
+    uint32_t mask_stride;
+} t_display_s3_asm_dsc_t;
+
+// lv_color_blend_to_rgb565_esp32s3.S
+extern int lv_color_blend_to_rgb565_esp(t_display_s3_asm_dsc_t *asm_dsc);
+
+// lv_rgb565_blend_normal_to_rgb565_esp32s3.S
+extern int lv_rgb565_blend_normal_to_rgb565_esp(t_display_s3_asm_dsc_t *asm_dsc);
+
+// simple fill (no mask, opa >= LV_OPA_MAX)
+static inline lv_result_t t_display_s3_color_blend_to_rgb565(lv_draw_sw_blend_fill_dsc_t *dsc) {
+    t_display_s3_asm_dsc_t asm_dsc = {
+            .dst_buf = dsc->dest_buf,
+            .dst_w = dsc->dest_w,
+            .dst_h = dsc->dest_h,
+            .dst_stride = dsc->dest_stride,
+            .src_buf = &dsc->color,
+    };
+    return lv_color_blend_to_rgb565_esp(&asm_dsc);
+}
+
+// RGB565 image copy (normal blend mode, no mask, opa >= LV_OPA_MAX)
+static inline lv_result_t t_display_s3_rgb565_blend_normal_to_rgb565(lv_draw_sw_blend_image_dsc_t *dsc) {
+    t_display_s3_asm_dsc_t asm_dsc = {
+            .dst_buf = dsc->dest_buf,
+            .dst_w = dsc->dest_w,
+            .dst_h = dsc->dest_h,
+            .dst_stride = dsc->dest_stride,
+            .src_buf = dsc->src_buf,
+            .src_stride = dsc->src_stride,
+    };
+    return lv_rgb565_blend_normal_to_rgb565_esp(&asm_dsc);
+}
+
+#endif // CONFIG_LV_DRAW_SW_ASM_CUSTOM
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
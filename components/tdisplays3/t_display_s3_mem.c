@@ -0,0 +1,72 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// LVGL memory
+//
+// With CONFIG_LV_USE_CLIB_MALLOC every lv_malloc() ends up in the IDF heap, which (CONFIG_SPIRAM_USE_MALLOC) puts
+// anything larger than CONFIG_SPIRAM_MALLOC_ALWAYSINTERNAL bytes, or anything when internal memory is short, in PSRAM.
+// LVGL's allocations stay with it, only the buffers LVGL allocates through its draw buffer handlers are placed: layer
+// and other draw buffers in PSRAM, the font draw buffers (glyph bitmaps, written and read by the renderer for every
+// letter) in internal SRAM, each in the other memory when its own is full. lcd_get_mem_pool_stats() reports the IDF
+// heap of both memories, LVGL's allocations included.
+
+#include <esp_log.h>
+#include <esp_check.h>
+#include <esp_heap_caps.h>
+#include <stdatomic.h>
+#include "t_display_s3.h"
+#include "t_display_s3_priv.h"
+#include "draw/lv_draw_buf_private.h"
+
+static const char *TAG = "esp_idf_t_display_s3_mem";
+
+static const uint32_t mem_pool_caps[LCD_MEM_POOL_MAX] = {
+        [LCD_MEM_POOL_SRAM] = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT,
+        [LCD_MEM_POOL_PSRAM] = MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT,
+};
+
+// draw / glyph buffers that went to the other memory
+static atomic_uint mem_pool_fallbacks[LCD_MEM_POOL_MAX];
+
+// allocate a buffer in a memory, or in the other one when it is full. Freed by LVGL's lv_free(), the C library's
+// free() takes heap_caps allocations
+static void *lcd_mem_buf_alloc(lcd_mem_pool_t pool, size_t size) {
+    void *p = heap_caps_malloc(size, mem_pool_caps[pool]);
+    if (p == NULL) {
+        atomic_fetch_add(&mem_pool_fallbacks[pool], 1);
+        p = heap_caps_malloc(size, mem_pool_caps[pool == LCD_MEM_POOL_SRAM ? LCD_MEM_POOL_PSRAM : LCD_MEM_POOL_SRAM]);
+    }
+    return p;
+}
+
+// layer and other draw buffers go to PSRAM, whatever their size
+static void *lcd_mem_draw_buf_malloc(size_t size_bytes, lv_color_format_t color_format) {
+    LV_UNUSED(color_format);
+    // allocate larger memory to be sure it can be aligned as needed (same as LVGL's default handler)
+    return lcd_mem_buf_alloc(LCD_MEM_POOL_PSRAM, size_bytes + LV_DRAW_BUF_ALIGN - 1);
+}
+
+// glyph bitmaps are written and read by the renderer for every letter, keep them in SRAM
+static void *lcd_mem_font_buf_malloc(size_t size_bytes, lv_color_format_t color_format) {
+    LV_UNUSED(color_format);
+    return lcd_mem_buf_alloc(LCD_MEM_POOL_SRAM, size_bytes + LV_DRAW_BUF_ALIGN - 1);
+}
+
+void lcd_mem_draw_buf_init(void) {
+    lv_draw_buf_get_handlers()->buf_malloc_cb = lcd_mem_draw_buf_malloc;
+    lv_draw_buf_get_font_handlers()->buf_malloc_cb = lcd_mem_font_buf_malloc;
+}
+
+esp_err_t lcd_get_mem_pool_stats(lcd_mem_pool_t pool, lcd_mem_pool_stats_t *stats) {
+    ESP_RETURN_ON_FALSE(pool < LCD_MEM_POOL_MAX && stats, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    multi_heap_info_t info;
+    heap_caps_get_info(&info, mem_pool_caps[pool]);
+    stats->total_bytes = info.total_free_bytes + info.total_allocated_bytes;
+    stats->free_bytes = info.total_free_bytes;
+    stats->min_free_bytes = info.minimum_free_bytes;
+    stats->largest_free_block = info.largest_free_block;
+    stats->allocated_blocks = info.allocated_blocks;
+    stats->fallbacks = atomic_load(&mem_pool_fallbacks[pool]);
+    return ESP_OK;
+}
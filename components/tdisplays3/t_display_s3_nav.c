@@ -0,0 +1,205 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Two-button navigation profile
+//
+// lvgl_port_add_navigation_buttons() needs three buttons (prev, next, enter), the T-Display S3 has two. This is the
+// same LV_INDEV_MODE_EVENT encoder over the two existing button handles, with a long press as enter:
+//  - the button callbacks (esp_timer task) queue key transitions in a single producer / single consumer ring and wake
+//    the LVGL task (lvgl_port_task_wake(LVGL_PORT_EVENT_TOUCH)), which reads the indev before lv_timer_handler(),
+//  - the read callback hands LVGL one transition per read and wakes the task again while more are queued, so a press
+//    and release that both came before the read are not merged into nothing,
+//  - a read of a key press opens an input latency probe from the press, which a timer closes in the lv_timer_handler()
+//    right after the read, once LVGL has handled the key,
+//  - every read makes the display's refresh timer ready: it stays paused unless handling the key invalidated
+//    something, and then the lv_timer_handler() right after renders and flushes it instead of waiting for the refresh
+//    period.
+
+#include <stdatomic.h>
+#include <esp_log.h>
+#include <esp_check.h>
+#include <esp_timer.h>
+#include "freertos/FreeRTOS.h"
+#include "t_display_s3.h"
+#include "t_display_s3_button.h"
+#include "display/lv_display_private.h"
+
+#if (LCD_NAV_QUEUE_SIZE & (LCD_NAV_QUEUE_SIZE - 1)) != 0
+#error "LCD_NAV_QUEUE_SIZE must be a power of 2"
+#endif
+
+static const char *TAG = "esp_idf_t_display_s3_nav";
+
+typedef enum {
+    LCD_NAV_BTN_PREV,
+    LCD_NAV_BTN_NEXT,
+    LCD_NAV_BTN_MAX,
+} lcd_nav_btn_t;
+
+typedef struct {
+    int64_t time_us;
+    uint32_t key;
+    bool pressed;
+} lcd_nav_key_t;
+
+typedef struct {
+    lv_indev_t *indev;
+    lv_timer_t *input_end_timer;
+    button_handle_t btn[LCD_NAV_BTN_MAX];
+    // only used by the button callbacks
+    uint32_t held_key[LCD_NAV_BTN_MAX];
+    // queue written by the button callbacks, read by the LVGL task
+    lcd_nav_key_t queue[LCD_NAV_QUEUE_SIZE];
+    atomic_uint head;
+    atomic_uint tail;
+    atomic_uint keys;
+    atomic_uint dropped;
+    // only used by the LVGL task
+    lcd_nav_key_t last;
+    uint64_t read_sum_us;
+    lcd_nav_stats_t stats;
+} lcd_nav_ctx_t;
+
+static lcd_nav_ctx_t nav_ctx;
+static portMUX_TYPE nav_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void lcd_nav_queue_key(uint32_t key, bool pressed, int64_t time_us) {
+    uint32_t head = atomic_load_explicit(&nav_ctx.head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&nav_ctx.tail, memory_order_acquire);
+    if (head - tail >= LCD_NAV_QUEUE_SIZE) {
+        atomic_fetch_add_explicit(&nav_ctx.dropped, 1, memory_order_relaxed);
+        return;
+    }
+    nav_ctx.queue[head % LCD_NAV_QUEUE_SIZE] = (lcd_nav_key_t) {
+            .time_us = time_us,
+            .key = key,
+            .pressed = pressed,
+    };
+    atomic_store_explicit(&nav_ctx.head, head + 1, memory_order_release);
+    atomic_fetch_add_explicit(&nav_ctx.keys, 1, memory_order_relaxed);
+}
+
+// runs in the esp_timer task
+static void lcd_nav_button_cb(void *arg, void *usr_data) {
+    button_handle_t button = (button_handle_t) arg;
+    lcd_nav_btn_t btn = (lcd_nav_btn_t) (uintptr_t) usr_data;
+    int64_t now_us = esp_timer_get_time();
+
+    switch (iot_button_get_event(button)) {
+        case BUTTON_PRESS_DOWN:
+            nav_ctx.held_key[btn] = btn == LCD_NAV_BTN_PREV ? LV_KEY_LEFT : LV_KEY_RIGHT;
+            lcd_nav_queue_key(nav_ctx.held_key[btn], true, button_edge_take_press_time_us(button));
+            break;
+        case BUTTON_LONG_PRESS_START:
+            // the encoder only sends LV_EVENT_PRESSED for a key pressed after a release
+            lcd_nav_queue_key(nav_ctx.held_key[btn], false, now_us);
+            nav_ctx.held_key[btn] = LV_KEY_ENTER;
+            lcd_nav_queue_key(LV_KEY_ENTER, true, now_us);
+            break;
+        case BUTTON_PRESS_UP:
+            lcd_nav_queue_key(nav_ctx.held_key[btn], false, now_us);
+            break;
+        default:
+            return;
+    }
+    lvgl_port_task_wake(LVGL_PORT_EVENT_TOUCH, nav_ctx.indev);
+}
+
+// closes the input latency probe of a key press, the timer was created after the display's refresh timer and runs
+// before it
+static void lcd_nav_input_end_timer_cb(lv_timer_t *timer) {
+    lcd_latency_input_end();
+    lv_timer_pause(timer);
+}
+
+static void lcd_nav_read_cb(lv_indev_t *indev, lv_indev_data_t *data) {
+    uint32_t tail = atomic_load_explicit(&nav_ctx.tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&nav_ctx.head, memory_order_acquire);
+    if (head != tail) {
+        nav_ctx.last = nav_ctx.queue[tail % LCD_NAV_QUEUE_SIZE];
+        atomic_store_explicit(&nav_ctx.tail, tail + 1, memory_order_release);
+        if (nav_ctx.last.pressed) {
+            uint32_t read_us = (uint32_t) (esp_timer_get_time() - nav_ctx.last.time_us);
+            portENTER_CRITICAL(&nav_lock);
+            nav_ctx.stats.presses++;
+            nav_ctx.read_sum_us += read_us;
+            if (read_us > nav_ctx.stats.max_read_us) {
+                nav_ctx.stats.max_read_us = read_us;
+            }
+            portEXIT_CRITICAL(&nav_lock);
+
+            // LVGL handles the key after the read callback returns
+            lcd_latency_input_begin(nav_ctx.last.time_us);
+            lv_timer_ready(nav_ctx.input_end_timer);
+            lv_timer_resume(nav_ctx.input_end_timer);
+        }
+        if (head - tail > 1) {
+            // event mode reads once per wakeup
+            lvgl_port_task_wake(LVGL_PORT_EVENT_TOUCH, indev);
+        }
+
+        lv_display_t *disp = lv_indev_get_display(indev);
+        if (disp != NULL && disp->refr_timer != NULL) {
+            lv_timer_ready(disp->refr_timer);
+        }
+    }
+    data->key = nav_ctx.last.key;
+    data->state = nav_ctx.last.pressed ? LV_INDEV_STATE_PRESSED : LV_INDEV_STATE_RELEASED;
+}
+
+lv_indev_t *lcd_add_navigation_buttons(lv_display_t *disp, button_handle_t btn_prev, button_handle_t btn_next) {
+    ESP_RETURN_ON_FALSE(disp && btn_prev && btn_next && btn_prev != btn_next, NULL, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(nav_ctx.indev == NULL, NULL, TAG, "navigation buttons already added");
+
+    nav_ctx.btn[LCD_NAV_BTN_PREV] = btn_prev;
+    nav_ctx.btn[LCD_NAV_BTN_NEXT] = btn_next;
+    nav_ctx.last.key = LV_KEY_ENTER;
+
+    lvgl_port_lock(0);
+    lv_indev_t *indev = lv_indev_create();
+    lv_indev_set_type(indev, LV_INDEV_TYPE_ENCODER);
+    lv_indev_set_mode(indev, LV_INDEV_MODE_EVENT);
+    lv_indev_set_read_cb(indev, lcd_nav_read_cb);
+    lv_indev_set_display(indev, disp);
+    nav_ctx.indev = indev;
+    if (nav_ctx.input_end_timer == NULL) {
+        nav_ctx.input_end_timer = lv_timer_create(lcd_nav_input_end_timer_cb, 0, NULL);
+        lv_timer_pause(nav_ctx.input_end_timer);
+    }
+    lvgl_port_unlock();
+
+    button_event_args_t long_press_args = {
+            .long_press = {
+                    .press_time = LCD_NAV_LONG_PRESS_MS,
+            },
+    };
+    for (int i = 0; i < LCD_NAV_BTN_MAX; i++) {
+        void *usr_data = (void *) (uintptr_t) i;
+        esp_err_t ret = iot_button_register_cb(nav_ctx.btn[i], BUTTON_PRESS_DOWN, NULL, lcd_nav_button_cb, usr_data);
+        if (ret == ESP_OK) {
+            ret = iot_button_register_cb(nav_ctx.btn[i], BUTTON_PRESS_UP, NULL, lcd_nav_button_cb, usr_data);
+        }
+        if (ret == ESP_OK) {
+            ret = iot_button_register_cb(nav_ctx.btn[i], BUTTON_LONG_PRESS_START, &long_press_args, lcd_nav_button_cb,
+                                         usr_data);
+        }
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "register button callbacks failed: %s", esp_err_to_name(ret));
+            lvgl_port_lock(0);
+            lv_indev_delete(indev);
+            nav_ctx.indev = NULL;
+            lvgl_port_unlock();
+            return NULL;
+        }
+    }
+    return indev;
+}
+
+void lcd_get_navigation_stats(lcd_nav_stats_t *stats) {
+    portENTER_CRITICAL(&nav_lock);
+    *stats = nav_ctx.stats;
+    stats->avg_read_us = stats->presses > 0 ? nav_ctx.read_sum_us / stats->presses : 0;
+    portEXIT_CRITICAL(&nav_lock);
+    stats->keys = atomic_load(&nav_ctx.keys);
+    stats->dropped = atomic_load(&nav_ctx.dropped);
+}
@@ -0,0 +1,113 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// internal interfaces shared between the tdisplays3 source files
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_err.h"
+#include "esp_lcd_panel_io.h"
+#include "esp_lcd_panel_ops.h"
+#include "lvgl.h"
+
+// events recorded by the frame timing trace
+typedef enum {
+    LCD_TRACE_EVENT_FRAME_START,
+    LCD_TRACE_EVENT_RENDER_START,
+    LCD_TRACE_EVENT_RENDER_DONE,
+    LCD_TRACE_EVENT_FLUSH_CB,
+    LCD_TRACE_EVENT_DMA_DONE,
+    LCD_TRACE_EVENT_FRAME_END,
+} lcd_trace_event_t;
+
+// take over the flushing of a display added with lvgl_port_add_disp() (t_display_s3_flush.c)
+esp_err_t lcd_flush_init(lv_display_t *disp, esp_lcd_panel_io_handle_t io_handle, esp_lcd_panel_handle_t panel_handle);
+
+// time a 1 px and a full stripe flush on the idle pipeline, before LVGL renders anything
+esp_err_t lcd_flush_measure_cost(uint32_t *setup_ns, uint32_t *px_ns);
+
+// allocate the row hashes of the panel, nothing is known to be on it yet (t_display_s3_rowhash.c)
+esp_err_t lcd_row_hash_init(lv_display_t *disp);
+
+// wait up to timeout_ms for the stripes LVGL queued to be sent, called under lvgl_port_lock so that LVGL queues no more
+esp_err_t lcd_flush_wait_idle(uint32_t timeout_ms);
+
+// split a rendered stripe into the row ranges (up to LCD_ROW_HASH_MAX_SEGMENTS) that differ from what the panel
+// shows, unchanged gaps of up to gap_px pixels are sent along, returns the number of segments (0: nothing to send)
+uint32_t lcd_row_hash_trim(const lv_area_t *area, const uint8_t *px_map, uint32_t gap_px, lv_area_t *segments);
+
+// forget what the panel shows, after it was drawn to without lcd_row_hash_trim()
+void lcd_row_hash_reset(void);
+
+// start sampling the battery voltage, returns after the first reading was published (t_display_s3_battery.c)
+esp_err_t battery_monitor_init(void);
+
+// record the LVGL refresh events of a display in the frame timing trace (t_display_s3_trace.c)
+void lcd_trace_init(lv_display_t *disp);
+
+// record an event in the frame timing trace, safe to call from ISRs
+void lcd_trace_record(lcd_trace_event_t event);
+
+// latencies kept by the input latency probes, in the order of the LCD_TRACE_INPUT_* metrics
+typedef enum {
+    LCD_LATENCY_TO_INVALIDATE,
+    LCD_LATENCY_TO_RENDER,
+    LCD_LATENCY_TO_FLUSH,
+    LCD_LATENCY_TO_PHOTON,
+    LCD_LATENCY_METRIC_MAX,
+} lcd_latency_metric_t;
+
+// follow the inputs of lcd_latency_input_begin() through the refreshes of a display (t_display_s3_latency.c)
+void lcd_latency_init(lv_display_t *disp);
+
+// number a stripe passed to flush_cb, returns its sequence number for lcd_latency_stripe_done()
+uint32_t lcd_latency_flush(const lv_area_t *area);
+
+// the stripes up to seq are on the panel, safe to call from ISRs
+void lcd_latency_stripe_done(uint32_t seq);
+
+// copy the latest latencies of a metric, returns the number of samples
+size_t lcd_latency_collect(lcd_latency_metric_t metric, uint32_t *samples, size_t max_samples);
+
+// size the LVGL image caches and install the SRAM/PSRAM image buffer allocator (t_display_s3_cache.c)
+void lcd_image_cache_init(void);
+
+// create the box shadow corner cache behind lv_draw_sw_box_shadow() (t_display_s3_shadow.c)
+void lcd_shadow_cache_init(void);
+
+// create the glyph bitmap cache behind lv_font_get_bitmap_fmt_txt() (t_display_s3_glyph.c)
+void lcd_glyph_cache_init(void);
+
+// register the enabled built-in fonts with the glyph id tables (t_display_s3_font.c)
+void lcd_font_lut_init(void);
+
+// allocate the LVGL draw buffers in PSRAM and the glyph buffers in internal SRAM (t_display_s3_mem.c)
+void lcd_mem_draw_buf_init(void);
+
+// switch LVGL to the esp_timer clock and stop the port's tick timer when LVGL_TICKLESS is set, wake the LVGL task when
+// other tasks invalidate disp (t_display_s3_tick.c)
+esp_err_t lcd_tick_init(lv_display_t *disp);
+
+// with LCD_BK_LIGHT_RMT: pulse the AW9364 on its EN pin to its steps from the RMT (t_display_s3_aw9364.c), off until the first step is set
+esp_err_t lcd_aw9364_init(int en_gpio_num);
+
+// set the step (0: off), fading one step at a time over fade_time_ms when it is longer than AW9364_MIN_FADE_TIME_MS
+esp_err_t lcd_aw9364_set_step(uint8_t step, uint32_t fade_time_ms);
+
+// the step set last, the target of a fade
+uint8_t lcd_aw9364_get_step(void);
+
+typedef void (*lcd_blend_fill_cb_t)(lv_draw_sw_blend_fill_dsc_t *dsc);
+typedef void (*lcd_blend_copy_cb_t)(lv_draw_sw_blend_image_dsc_t *dsc);
+
+// compare an RGB565 fill and image blend kernel byte for byte with LVGL's C loops (t_display_s3_lv_blend.c),
+// ESP_FAIL at the first area that differs
+esp_err_t lcd_blend_check_kernels(lcd_blend_fill_cb_t fill, lcd_blend_copy_cb_t copy);
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
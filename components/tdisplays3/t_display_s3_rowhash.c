@@ -0,0 +1,169 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Row hashes of the panel
+//
+// LVGL often renders pixels the panel already shows: a label re-set to the same number, an object re-invalidated by a
+// style refresh, the unchanged rows around a changed letter. On the i80 bus every one of them costs the same as a
+// changed pixel. Instead of a shadow copy of the panel (108 KB), each band of LCD_ROW_HASH_ROWS rows keeps the hashes
+// of the last LCD_ROW_HASH_SPANS column spans flushed to it. Before a stripe is sent (lcd_flush_task), the bands it
+// covers are hashed and compared with the span of the same columns:
+//  - bands that hash the same are not sent, unless the rows between two changed bands are cheaper to send along than
+//    another command sequence (gap_px, from the flush cost measured at init),
+//  - a changed band replaces the spans it overlaps, the panel no longer shows them,
+//  - a band the stripe only covers partly can't be hashed, it is sent and forgets the spans it overlaps.
+// A stripe is sent as up to LCD_ROW_HASH_MAX_SEGMENTS transfers, each starting on a row of the stripe buffer that is
+// LCD_PSRAM_TRANS_ALIGN aligned. Two different spans hashing the same (32 bit FNV-1a) would leave the old pixels on the
+// panel until they change again.
+
+#include <string.h>
+#include <esp_log.h>
+#include <esp_check.h>
+#include <esp_heap_caps.h>
+#include "freertos/FreeRTOS.h"
+#include "t_display_s3.h"
+#include "t_display_s3_priv.h"
+
+static const char *TAG = "esp_idf_t_display_s3_rowhash";
+
+typedef struct {
+    int16_t x1;
+    int16_t x2;
+    uint32_t hash;              // 0: empty
+} lcd_row_hash_span_t;
+
+typedef struct {
+    lcd_row_hash_span_t *spans; // LCD_ROW_HASH_SPANS per band, most recently flushed first, only used by the flush task
+    uint32_t bands;
+    portMUX_TYPE lock;          // guards the stats
+    lcd_row_hash_stats_t stats;
+} lcd_row_hash_ctx_t;
+
+static lcd_row_hash_ctx_t row_hash_ctx = {
+        .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+static uint32_t lcd_row_hash_px(const uint16_t *px, uint32_t count) {
+    uint32_t hash = 0x811C9DC5;
+    for (uint32_t i = 0; i < count; i++) {
+        hash = (hash ^ px[i]) * 0x01000193;
+    }
+    return hash != 0 ? hash : 1;
+}
+
+// false if the band already shows the span, otherwise records it as the band's most recent span (hash 0: the band is
+// only partly covered) and returns true
+static bool lcd_row_hash_band_update(uint32_t band, int32_t x1, int32_t x2, uint32_t hash) {
+    lcd_row_hash_span_t *spans = &row_hash_ctx.spans[band * LCD_ROW_HASH_SPANS];
+
+    if (hash != 0) {
+        for (uint32_t i = 0; i < LCD_ROW_HASH_SPANS && spans[i].hash != 0; i++) {
+            if (spans[i].x1 == x1 && spans[i].x2 == x2 && spans[i].hash == hash) {
+                lcd_row_hash_span_t span = spans[i];
+                memmove(&spans[1], &spans[0], i * sizeof(lcd_row_hash_span_t));
+                spans[0] = span;
+                return false;
+            }
+        }
+    }
+
+    // the pixels under the span change, keep the spans it doesn't overlap
+    lcd_row_hash_span_t kept[LCD_ROW_HASH_SPANS] = {0};
+    uint32_t kept_count = 0;
+    if (hash != 0) {
+        kept[kept_count++] = (lcd_row_hash_span_t) {.x1 = x1, .x2 = x2, .hash = hash};
+    }
+    for (uint32_t i = 0; i < LCD_ROW_HASH_SPANS && spans[i].hash != 0 && kept_count < LCD_ROW_HASH_SPANS; i++) {
+        if (spans[i].x2 < x1 || spans[i].x1 > x2) {
+            kept[kept_count++] = spans[i];
+        }
+    }
+    memcpy(spans, kept, sizeof(kept));
+    return true;
+}
+
+uint32_t lcd_row_hash_trim(const lv_area_t *area, const uint8_t *px_map, uint32_t gap_px, lv_area_t *segments) {
+    const uint16_t *px = (const uint16_t *) px_map;
+    int32_t w = lv_area_get_width(area);
+
+    // rows a transfer can start on, the DMA reads the stripe buffer in LCD_PSRAM_TRANS_ALIGN aligned bursts
+    uint32_t row_bytes = w * sizeof(uint16_t);
+    uint32_t row_align = row_bytes & -row_bytes;
+    int32_t align_rows = row_align >= LCD_PSRAM_TRANS_ALIGN ? 1 : LCD_PSRAM_TRANS_ALIGN / row_align;
+
+    uint32_t count = 0;
+    bool open = false;
+    int32_t seg_y1 = 0;
+    int32_t seg_y2 = 0;
+    for (int32_t y = area->y1; y <= area->y2;) {
+        uint32_t band = y / LCD_ROW_HASH_ROWS;
+        int32_t band_y1 = band * LCD_ROW_HASH_ROWS;
+        int32_t band_y2 = band_y1 + LCD_ROW_HASH_ROWS - 1;
+        int32_t y2 = LV_MIN(band_y2, area->y2);
+
+        uint32_t hash = 0;
+        if (y == band_y1 && y2 == band_y2) {
+            hash = lcd_row_hash_px(&px[(y - area->y1) * w], w * LCD_ROW_HASH_ROWS);
+        }
+        if (band < row_hash_ctx.bands && !lcd_row_hash_band_update(band, area->x1, area->x2, hash)) {
+            y = y2 + 1;
+            continue;
+        }
+
+        int32_t start = area->y1 + (y - area->y1) / align_rows * align_rows;
+        if (open && (start <= seg_y2 + 1 || (uint32_t) ((y - seg_y2 - 1) * w) <= gap_px ||
+                     count == LCD_ROW_HASH_MAX_SEGMENTS - 1)) {
+            seg_y2 = y2;
+        } else {
+            if (open) {
+                lv_area_set(&segments[count++], area->x1, seg_y1, area->x2, seg_y2);
+            }
+            seg_y1 = start;
+            seg_y2 = y2;
+            open = true;
+        }
+        y = y2 + 1;
+    }
+    if (open) {
+        lv_area_set(&segments[count++], area->x1, seg_y1, area->x2, seg_y2);
+    }
+
+    uint32_t sent_px = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        sent_px += lv_area_get_size(&segments[i]);
+    }
+    portENTER_CRITICAL(&row_hash_ctx.lock);
+    row_hash_ctx.stats.stripes++;
+    row_hash_ctx.stats.stripes_skipped += count == 0;
+    row_hash_ctx.stats.segments += count;
+    row_hash_ctx.stats.bytes_rendered += lv_area_get_size(area) * sizeof(uint16_t);
+    row_hash_ctx.stats.bytes_saved += (lv_area_get_size(area) - sent_px) * sizeof(uint16_t);
+    portEXIT_CRITICAL(&row_hash_ctx.lock);
+
+    return count;
+}
+
+void lcd_row_hash_reset(void) {
+    if (row_hash_ctx.spans != NULL) {
+        memset(row_hash_ctx.spans, 0, row_hash_ctx.bands * LCD_ROW_HASH_SPANS * sizeof(lcd_row_hash_span_t));
+    }
+}
+
+esp_err_t lcd_row_hash_init(lv_display_t *disp) {
+    int32_t rows = LV_MAX(lv_display_get_horizontal_resolution(disp), lv_display_get_vertical_resolution(disp));
+    row_hash_ctx.bands = (rows + LCD_ROW_HASH_ROWS - 1) / LCD_ROW_HASH_ROWS;
+    row_hash_ctx.spans = heap_caps_calloc(row_hash_ctx.bands * LCD_ROW_HASH_SPANS, sizeof(lcd_row_hash_span_t),
+                                          MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    ESP_RETURN_ON_FALSE(row_hash_ctx.spans, ESP_ERR_NO_MEM, TAG, "Not enough memory for the row hashes!");
+
+    ESP_LOGI(TAG, "Row hashes: %d row bands, %d spans each (%d bytes SRAM)", (int) row_hash_ctx.bands,
+             LCD_ROW_HASH_SPANS, (int) (row_hash_ctx.bands * LCD_ROW_HASH_SPANS * sizeof(lcd_row_hash_span_t)));
+    return ESP_OK;
+}
+
+void lcd_get_row_hash_stats(lcd_row_hash_stats_t *stats) {
+    assert(stats);
+    portENTER_CRITICAL(&row_hash_ctx.lock);
+    *stats = row_hash_ctx.stats;
+    portEXIT_CRITICAL(&row_hash_ctx.lock);
+}
@@ -0,0 +1,175 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Box shadow corner cache
+//
+// LVGL keeps a single blurred shadow corner (LV_DRAW_SW_SHADOW_CACHE_SIZE) and recomputes the blur whenever a shadow
+// with a different width or radius is drawn, i.e. on nearly every widget when several shadowed widgets are on the
+// screen. lv_draw_sw_box_shadow() is wrapped at link time (-Wl,--wrap, see CMakeLists.txt) to back that single entry
+// with an LRU of LVGL_SHADOW_CACHE_COUNT corners in PSRAM: a hit is copied into LVGL's entry before the shadow is
+// drawn, a miss is taken from LVGL's entry after it was computed. A shadow clipped out of the draw area goes straight
+// to LVGL, which doesn't need a corner for it, and counts as neither.
+//
+// The corner only depends on the shadow width and the radius clamped to the blurred area, which is how the object
+// size, radius and spread end up in the key.
+
+#include <string.h>
+#include <esp_log.h>
+#include <esp_heap_caps.h>
+#include "t_display_s3.h"
+#include "t_display_s3_priv.h"
+#include "core/lv_global.h"
+#include "draw/sw/lv_draw_sw_private.h"
+#include "misc/lv_area_private.h"
+
+static const char *TAG = "esp_idf_t_display_s3_shadow";
+
+void __real_lv_draw_sw_box_shadow(lv_draw_unit_t *draw_unit, const lv_draw_box_shadow_dsc_t *dsc,
+                                  const lv_area_t *coords);
+void __wrap_lv_draw_sw_box_shadow(lv_draw_unit_t *draw_unit, const lv_draw_box_shadow_dsc_t *dsc,
+                                  const lv_area_t *coords);
+
+#if LV_DRAW_SW_SHADOW_CACHE_SIZE > 0 && LV_DRAW_SW_COMPLEX
+
+// cache node, the whole node is the lookup key but only corner_size and radius are compared
+typedef struct {
+    int32_t corner_size;    // shadow width + clamped radius, the corner is corner_size * corner_size opacities
+    int32_t radius;
+    lv_opa_t *buf;
+} lcd_shadow_corner_t;
+
+static lv_cache_t *shadow_cache;
+// LVGL's shadow entry is not guarded, the render threads draw shadows one at a time
+static lv_mutex_t shadow_lock;
+static uint32_t hits;
+static uint32_t misses;
+static uint32_t evictions;
+
+static lv_cache_compare_res_t lcd_shadow_compare_cb(const lcd_shadow_corner_t *lhs, const lcd_shadow_corner_t *rhs) {
+    if (lhs->corner_size != rhs->corner_size) {
+        return lhs->corner_size > rhs->corner_size ? 1 : -1;
+    }
+    if (lhs->radius != rhs->radius) {
+        return lhs->radius > rhs->radius ? 1 : -1;
+    }
+    return 0;
+}
+
+// corners are only removed to make room for a new one
+static void lcd_shadow_free_cb(lcd_shadow_corner_t *corner, void *user_data) {
+    LV_UNUSED(user_data);
+    heap_caps_free(corner->buf);
+    corner->buf = NULL;
+    evictions++;
+}
+
+void __wrap_lv_draw_sw_box_shadow(lv_draw_unit_t *draw_unit, const lv_draw_box_shadow_dsc_t *dsc,
+                                  const lv_area_t *coords) {
+    lv_draw_sw_shadow_cache_t *lv_shadow = &LV_GLOBAL_DEFAULT()->sw_shadow_cache;
+
+    // lv_draw_sw_box_shadow() returns before it needs the corner when the shadow is clipped out of the draw area
+    lv_area_t shadow_area = {
+            .x1 = coords->x1 + dsc->ofs_x - dsc->spread - dsc->width / 2 - 1,
+            .y1 = coords->y1 + dsc->ofs_y - dsc->spread - dsc->width / 2 - 1,
+            .x2 = coords->x2 + dsc->ofs_x + dsc->spread + dsc->width / 2 + 1,
+            .y2 = coords->y2 + dsc->ofs_y + dsc->spread + dsc->width / 2 + 1,
+    };
+    lv_area_t draw_area;
+    if (!lv_area_intersect(&draw_area, &shadow_area, draw_unit->clip_area)) {
+        __real_lv_draw_sw_box_shadow(draw_unit, dsc, coords);
+        return;
+    }
+
+    // the clamped radius and corner size as lv_draw_sw_box_shadow() calculates them
+    int32_t core_w = lv_area_get_width(coords) + 2 * dsc->spread;
+    int32_t core_h = lv_area_get_height(coords) + 2 * dsc->spread;
+    int32_t r_sh = dsc->radius;
+    int32_t short_side = LV_MIN(core_w, core_h);
+    if (r_sh > short_side >> 1) {
+        r_sh = short_side >> 1;
+    }
+    lcd_shadow_corner_t key = {
+            .corner_size = dsc->width + r_sh,
+            .radius = r_sh,
+    };
+    size_t corner_bytes = (size_t) key.corner_size * key.corner_size;
+
+    lv_mutex_lock(&shadow_lock);
+
+    bool in_lv_shadow = lv_shadow->cache_size == key.corner_size && lv_shadow->cache_r == key.radius;
+    if (!in_lv_shadow && corner_bytes < sizeof(lv_shadow->cache)) {
+        lv_cache_entry_t *entry = lv_cache_acquire(shadow_cache, &key, NULL);
+        if (entry != NULL) {
+            lcd_shadow_corner_t *corner = lv_cache_entry_get_data(entry);
+            memcpy(lv_shadow->cache, corner->buf, corner_bytes);
+            lv_shadow->cache_size = key.corner_size;
+            lv_shadow->cache_r = key.radius;
+            lv_cache_release(shadow_cache, entry, NULL);
+            in_lv_shadow = true;
+        }
+    }
+    if (in_lv_shadow) {
+        hits++;
+    } else {
+        misses++;
+    }
+
+    __real_lv_draw_sw_box_shadow(draw_unit, dsc, coords);
+
+    // the blur was computed and LVGL kept it, keep a copy before the next shadow overwrites it
+    if (!in_lv_shadow && lv_shadow->cache_size == key.corner_size && lv_shadow->cache_r == key.radius) {
+        lv_opa_t *buf = heap_caps_malloc(corner_bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        lv_cache_entry_t *entry = buf != NULL ? lv_cache_add(shadow_cache, &key, NULL) : NULL;
+        if (entry != NULL) {
+            lcd_shadow_corner_t *corner = lv_cache_entry_get_data(entry);
+            memcpy(buf, lv_shadow->cache, corner_bytes);
+            corner->buf = buf;
+            lv_cache_release(shadow_cache, entry, NULL);
+        } else {
+            heap_caps_free(buf);
+        }
+    }
+
+    lv_mutex_unlock(&shadow_lock);
+}
+
+void lcd_shadow_cache_init(void) {
+    lv_mutex_init(&shadow_lock);
+    shadow_cache = lv_cache_create(&lv_cache_class_lru_rb_count, sizeof(lcd_shadow_corner_t), LVGL_SHADOW_CACHE_COUNT,
+                                   (lv_cache_ops_t) {
+                                           .compare_cb = (lv_cache_compare_cb_t) lcd_shadow_compare_cb,
+                                           .create_cb = NULL,
+                                           .free_cb = (lv_cache_free_cb_t) lcd_shadow_free_cb,
+                                   });
+    lv_cache_set_name(shadow_cache, "SHADOW");
+    ESP_LOGI(TAG, "Shadow cache %d corners of up to %d x %d px", LVGL_SHADOW_CACHE_COUNT,
+             LV_DRAW_SW_SHADOW_CACHE_SIZE, LV_DRAW_SW_SHADOW_CACHE_SIZE);
+}
+
+void lcd_get_shadow_cache_stats(lcd_shadow_cache_stats_t *stats) {
+    lvgl_port_lock(0);
+    lv_mutex_lock(&shadow_lock);
+    stats->hits = hits;
+    stats->misses = misses;
+    stats->evictions = evictions;
+    stats->entries = shadow_cache != NULL ? lv_cache_get_size(shadow_cache, NULL) : 0;
+    lv_mutex_unlock(&shadow_lock);
+    lvgl_port_unlock();
+}
+
+#else
+
+void __wrap_lv_draw_sw_box_shadow(lv_draw_unit_t *draw_unit, const lv_draw_box_shadow_dsc_t *dsc,
+                                  const lv_area_t *coords) {
+    __real_lv_draw_sw_box_shadow(draw_unit, dsc, coords);
+}
+
+void lcd_shadow_cache_init(void) {
+    ESP_LOGW(TAG, "Shadow cache disabled, it needs CONFIG_LV_DRAW_SW_COMPLEX and CONFIG_LV_DRAW_SW_SHADOW_CACHE_SIZE > 0");
+}
+
+void lcd_get_shadow_cache_stats(lcd_shadow_cache_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+}
+
+#endif
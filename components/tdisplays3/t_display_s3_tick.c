@@ -0,0 +1,151 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Tickless LVGL timekeeping
+//
+// esp_lvgl_port keeps LVGL's time with a periodic esp_timer (every LVGL_TICK_PERIOD_MS) that takes the port's timer
+// mutex just to call lv_tick_inc(), and the LVGL task is capped at task_max_sleep_ms of sleep so that anything another
+// task invalidates gets drawn. With LVGL_TICKLESS set:
+//  - LVGL reads its time from esp_timer (lv_tick_set_cb()), the port's tick timer is stopped (lvgl_port_stop(), on
+//    the first run of the port task),
+//  - the port task already sleeps for what lv_timer_handler() returns, the time until the next LVGL timer is due,
+//  - other tasks wake it (lvgl_port_task_wake()) when they give LVGL something to draw: the display's
+//    LV_EVENT_REFR_REQUEST, which LVGL sends for every invalidated area and layout change, wakes it unless it is the
+//    LVGL task's own. Animations apply their start value when they start, so they invalidate too; a timer another
+//    task creates without invalidating anything runs after at most LVGL_MAX_SLEEP_MS.
+// The port task still yields for one FreeRTOS tick after every run (vTaskDelay(1) in esp_lvgl_port).
+//
+// lv_timer_handler() is wrapped to count the LVGL task wakeups and its busy time with either setting, so
+// lcd_get_tick_stats() can compare the two.
+
+#include <stdatomic.h>
+#include <esp_log.h>
+#include <esp_check.h>
+#include <esp_timer.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "t_display_s3.h"
+#include "t_display_s3_priv.h"
+
+static const char *TAG = "esp_idf_t_display_s3_tick";
+
+// length of the measurement period of the stats
+#define LCD_TICK_STATS_PERIOD_US (1000 * 1000)
+
+uint32_t __real_lv_timer_handler(void);
+uint32_t __wrap_lv_timer_handler(void);
+
+typedef struct {
+    TaskHandle_t task;          // task running lv_timer_handler()
+    int64_t offset_ms;          // esp_timer time at LVGL tick 0, LVGL's time continues where the tick timer left it
+    bool stop_port_tick;        // the port's tick timer is stopped from the port task, see lcd_tick_init()
+    // measurement period, only updated by lv_timer_handler() i.e. under the LVGL lock
+    int64_t period_start_us;
+    int64_t busy_us;
+    uint32_t wakeups;
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    configRUN_TIME_COUNTER_TYPE run_time_start;
+    configRUN_TIME_COUNTER_TYPE idle_time_start;
+#endif
+    lcd_tick_stats_t stats;
+} lcd_tick_ctx_t;
+
+static lcd_tick_ctx_t tick_ctx;
+static atomic_uint event_wakes;
+
+static uint32_t lcd_tick_get_cb(void) {
+    return (uint32_t) (esp_timer_get_time() / 1000 - tick_ctx.offset_ms);
+}
+
+// wake the LVGL task to recompute its sleep, unless it is the one calling
+static void lcd_tick_wake(void) {
+#if LVGL_TICKLESS
+    TaskHandle_t task = tick_ctx.task;
+    if (task != NULL && task != xTaskGetCurrentTaskHandle()) {
+        atomic_fetch_add(&event_wakes, 1);
+        lvgl_port_task_wake(LVGL_PORT_EVENT_USER, NULL);
+    }
+#endif
+}
+
+static void lcd_tick_stats_update(int64_t now) {
+    int64_t period_us = now - tick_ctx.period_start_us;
+    uint32_t wakes = atomic_exchange(&event_wakes, 0);
+
+    tick_ctx.stats.wakeups_per_s = tick_ctx.wakeups * 1000000LL / period_us;
+    tick_ctx.stats.event_wakes_per_s = wakes * 1000000LL / period_us;
+    // the port's tick timer (or the application's) runs every LVGL_TICK_PERIOD_MS
+    tick_ctx.stats.tick_irqs_per_s = LVGL_TICKLESS ? 0 : 1000 / LVGL_TICK_PERIOD_MS;
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    // the LVGL task is pinned, this is the idle task of its core
+    configRUN_TIME_COUNTER_TYPE run_time = portGET_RUN_TIME_COUNTER_VALUE();
+    configRUN_TIME_COUNTER_TYPE idle_time = ulTaskGetIdleRunTimeCounter();
+    configRUN_TIME_COUNTER_TYPE run_time_delta = run_time - tick_ctx.run_time_start;
+    // the counters are only read on the LVGL task, the first period has no start
+    if (tick_ctx.run_time_start != 0 && run_time_delta > 0) {
+        tick_ctx.stats.idle_pct = (uint64_t) (idle_time - tick_ctx.idle_time_start) * 100 / run_time_delta;
+    }
+    tick_ctx.run_time_start = run_time;
+    tick_ctx.idle_time_start = idle_time;
+#else
+    tick_ctx.stats.idle_pct = tick_ctx.busy_us < period_us ? 100 - tick_ctx.busy_us * 100 / period_us : 0;
+#endif
+
+    tick_ctx.period_start_us = now;
+    tick_ctx.busy_us = 0;
+    tick_ctx.wakeups = 0;
+}
+
+uint32_t __wrap_lv_timer_handler(void) {
+    int64_t start = esp_timer_get_time();
+    tick_ctx.task = xTaskGetCurrentTaskHandle();
+#if LVGL_TICKLESS
+    if (tick_ctx.stop_port_tick) {
+        tick_ctx.stop_port_tick = false;
+        // lvgl_port_stop() also disables the LVGL timers, which have to keep running
+        esp_err_t ret = lvgl_port_stop();
+        lv_timer_enable(true);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "LVGL tick timer not stopped: %s", esp_err_to_name(ret));
+        }
+    }
+#endif
+
+    uint32_t time_until_next = __real_lv_timer_handler();
+
+    int64_t end = esp_timer_get_time();
+    tick_ctx.wakeups++;
+    tick_ctx.busy_us += end - start;
+    if (tick_ctx.period_start_us != 0 && end - tick_ctx.period_start_us >= LCD_TICK_STATS_PERIOD_US) {
+        lcd_tick_stats_update(end);
+    }
+    return time_until_next;
+}
+
+static void lcd_tick_refr_request_cb(lv_event_t *e) {
+    lcd_tick_wake();
+}
+
+esp_err_t lcd_tick_init(lv_display_t *disp) {
+    ESP_RETURN_ON_FALSE(disp, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+#if LVGL_TICKLESS
+    tick_ctx.offset_ms = esp_timer_get_time() / 1000 - lv_tick_get();
+    lv_tick_set_cb(lcd_tick_get_cb);
+    // the port task creates and starts its tick timer after lvgl_port_init() has returned, lvgl_port_stop() fails with
+    // ESP_ERR_INVALID_STATE until then. It is called by the first lv_timer_handler() of the port task instead, which
+    // runs after the timer was started
+    tick_ctx.stop_port_tick = true;
+    lv_display_add_event_cb(disp, lcd_tick_refr_request_cb, LV_EVENT_REFR_REQUEST, NULL);
+    ESP_LOGI(TAG, "Tickless LVGL, max sleep %d ms", LVGL_MAX_SLEEP_MS);
+#else
+    ESP_LOGI(TAG, "LVGL tick timer every %d ms, max sleep %d ms", LVGL_TICK_PERIOD_MS, LVGL_MAX_SLEEP_MS);
+#endif
+    tick_ctx.period_start_us = esp_timer_get_time();
+    return ESP_OK;
+}
+
+void lcd_get_tick_stats(lcd_tick_stats_t *stats) {
+    lvgl_port_lock(0);
+    *stats = tick_ctx.stats;
+    lvgl_port_unlock();
+}
@@ -0,0 +1,226 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Frame timing trace
+//
+// The LVGL task, the flush task and the i80 ISR record timestamped events into a lock-free ring buffer
+// (LCD_TRACE_RING_SIZE entries). The stats are computed from the ring when they are requested, so recording
+// is only an atomic increment and a few stores. The input latencies are kept by the input latency probes
+// (t_display_s3_latency.c), their stats are computed the same way.
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <esp_log.h>
+#include <esp_check.h>
+#include <esp_timer.h>
+#include "t_display_s3.h"
+#include "t_display_s3_priv.h"
+
+#if (LCD_TRACE_RING_SIZE & (LCD_TRACE_RING_SIZE - 1)) != 0
+#error "LCD_TRACE_RING_SIZE must be a power of 2"
+#endif
+
+#if LCD_LATENCY_SAMPLES > LCD_TRACE_RING_SIZE
+#error "LCD_LATENCY_SAMPLES must not be larger than LCD_TRACE_RING_SIZE"
+#endif
+
+// flush_cb entries that can be waiting for their DMA to finish (stripe buffers + margin)
+#define LCD_TRACE_FLUSH_FIFO_SIZE 8
+
+static const char *TAG = "esp_idf_t_display_s3_trace";
+
+typedef struct {
+    atomic_uint seq;        // 0 while rewritten, then ring index + 1, checked before and after an entry is read
+    uint32_t timestamp_us;
+    lcd_trace_event_t event;
+} lcd_trace_entry_t;
+
+static lcd_trace_entry_t trace_ring[LCD_TRACE_RING_SIZE];
+static atomic_uint trace_head;
+
+static const char *metric_names[LCD_TRACE_METRIC_MAX] = {
+        [LCD_TRACE_FRAME_TIME] = "frame time",
+        [LCD_TRACE_RENDER_TIME] = "area render time",
+        [LCD_TRACE_FLUSH_LATENCY] = "flush latency",
+        [LCD_TRACE_INPUT_TO_INVALIDATE] = "input to invalidate",
+        [LCD_TRACE_INPUT_TO_RENDER] = "input to render",
+        [LCD_TRACE_INPUT_TO_FLUSH] = "input to flush",
+        [LCD_TRACE_INPUT_TO_PHOTON] = "input to photon",
+};
+
+void lcd_trace_record(lcd_trace_event_t event) {
+    unsigned int idx = atomic_fetch_add_explicit(&trace_head, 1, memory_order_relaxed);
+    lcd_trace_entry_t *entry = &trace_ring[idx & (LCD_TRACE_RING_SIZE - 1)];
+    // invalidate the slot while it's rewritten, before any of the new fields is visible
+    atomic_store_explicit(&entry->seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    entry->timestamp_us = (uint32_t) esp_timer_get_time();
+    entry->event = event;
+    atomic_store_explicit(&entry->seq, idx + 1, memory_order_release);
+}
+
+static void lcd_trace_disp_event_callback(lv_event_t *e) {
+    switch (lv_event_get_code(e)) {
+        case LV_EVENT_REFR_START:
+            lcd_trace_record(LCD_TRACE_EVENT_FRAME_START);
+            break;
+        case LV_EVENT_FLUSH_WAIT_FINISH:
+            // single buffered LVGL waits for a free buffer before rendering each area
+            lcd_trace_record(LCD_TRACE_EVENT_RENDER_START);
+            break;
+        case LV_EVENT_FLUSH_START:
+            lcd_trace_record(LCD_TRACE_EVENT_RENDER_DONE);
+            break;
+        case LV_EVENT_REFR_READY:
+            lcd_trace_record(LCD_TRACE_EVENT_FRAME_END);
+            break;
+        default:
+            break;
+    }
+}
+
+void lcd_trace_init(lv_display_t *disp) {
+    lv_display_add_event_cb(disp, lcd_trace_disp_event_callback, LV_EVENT_REFR_START, NULL);
+    lv_display_add_event_cb(disp, lcd_trace_disp_event_callback, LV_EVENT_FLUSH_WAIT_FINISH, NULL);
+    lv_display_add_event_cb(disp, lcd_trace_disp_event_callback, LV_EVENT_FLUSH_START, NULL);
+    lv_display_add_event_cb(disp, lcd_trace_disp_event_callback, LV_EVENT_REFR_READY, NULL);
+}
+
+static int compare_u32(const void *a, const void *b) {
+    uint32_t va = *(const uint32_t *) a;
+    uint32_t vb = *(const uint32_t *) b;
+    return (va > vb) - (va < vb);
+}
+
+// histogram bucket i counts durations below 2^(i + LCD_TRACE_HISTOGRAM_MIN_LOG2) us, the last bucket takes the rest
+static int histogram_bucket(uint32_t duration_us) {
+    int bucket = 0;
+    while (bucket < LCD_TRACE_HISTOGRAM_BUCKETS - 1 &&
+           duration_us >= (1UL << (bucket + LCD_TRACE_HISTOGRAM_MIN_LOG2))) {
+        bucket++;
+    }
+    return bucket;
+}
+
+// walk the ring from the oldest to the newest entry and collect the durations of a metric
+static size_t collect_samples(lcd_trace_metric_t metric, uint32_t *samples, size_t max_samples) {
+    if (metric >= LCD_TRACE_INPUT_TO_INVALIDATE) {
+        return lcd_latency_collect(LCD_LATENCY_TO_INVALIDATE + (metric - LCD_TRACE_INPUT_TO_INVALIDATE), samples,
+                                   max_samples);
+    }
+
+    size_t count = 0;
+    bool started = false;
+    uint32_t start_us = 0;
+    uint32_t flush_fifo[LCD_TRACE_FLUSH_FIFO_SIZE];
+    size_t fifo_head = 0;
+    size_t fifo_len = 0;
+
+    unsigned int head = atomic_load_explicit(&trace_head, memory_order_acquire);
+    unsigned int first = head > LCD_TRACE_RING_SIZE ? head - LCD_TRACE_RING_SIZE : 0;
+
+    for (unsigned int idx = first; idx != head && count < max_samples; idx++) {
+        lcd_trace_entry_t *entry = &trace_ring[idx & (LCD_TRACE_RING_SIZE - 1)];
+        if (atomic_load_explicit(&entry->seq, memory_order_acquire) != idx + 1) {
+            // overwritten or still being written, don't pair across the gap
+            started = false;
+            fifo_len = 0;
+            continue;
+        }
+        uint32_t ts = entry->timestamp_us;
+        lcd_trace_event_t event = entry->event;
+        // a writer that lapped the reader while it copied the entry changed seq
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&entry->seq, memory_order_relaxed) != idx + 1) {
+            started = false;
+            fifo_len = 0;
+            continue;
+        }
+
+        switch (metric) {
+            case LCD_TRACE_FRAME_TIME:
+                if (event == LCD_TRACE_EVENT_FRAME_START) {
+                    started = true;
+                    start_us = ts;
+                } else if (event == LCD_TRACE_EVENT_FRAME_END && started) {
+                    samples[count++] = ts - start_us;
+                    started = false;
+                }
+                break;
+            case LCD_TRACE_RENDER_TIME:
+                if (event == LCD_TRACE_EVENT_RENDER_START) {
+                    started = true;
+                    start_us = ts;
+                } else if (event == LCD_TRACE_EVENT_RENDER_DONE && started) {
+                    samples[count++] = ts - start_us;
+                    started = false;
+                }
+                break;
+            case LCD_TRACE_FLUSH_LATENCY:
+                // stripes are released in the order they are flushed, with one DMA_DONE each (skipped ones too)
+                if (event == LCD_TRACE_EVENT_FLUSH_CB && fifo_len < LCD_TRACE_FLUSH_FIFO_SIZE) {
+                    flush_fifo[(fifo_head + fifo_len) % LCD_TRACE_FLUSH_FIFO_SIZE] = ts;
+                    fifo_len++;
+                } else if (event == LCD_TRACE_EVENT_DMA_DONE && fifo_len > 0) {
+                    samples[count++] = ts - flush_fifo[fifo_head];
+                    fifo_head = (fifo_head + 1) % LCD_TRACE_FLUSH_FIFO_SIZE;
+                    fifo_len--;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    return count;
+}
+
+esp_err_t lcd_trace_get_stats(lcd_trace_metric_t metric, lcd_trace_stats_t *stats) {
+    ESP_RETURN_ON_FALSE(metric < LCD_TRACE_METRIC_MAX && stats, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    uint32_t *samples = malloc(LCD_TRACE_RING_SIZE * sizeof(uint32_t));
+    ESP_RETURN_ON_FALSE(samples, ESP_ERR_NO_MEM, TAG, "Not enough memory for trace samples!");
+
+    memset(stats, 0, sizeof(lcd_trace_stats_t));
+    size_t count = collect_samples(metric, samples, LCD_TRACE_RING_SIZE);
+    if (count > 0) {
+        for (size_t i = 0; i < count; i++) {
+            stats->histogram[histogram_bucket(samples[i])]++;
+        }
+        qsort(samples, count, sizeof(uint32_t), compare_u32);
+        stats->count = count;
+        stats->min_us = samples[0];
+        stats->p50_us = samples[(count - 1) * 50 / 100];
+        stats->p95_us = samples[(count - 1) * 95 / 100];
+        stats->p99_us = samples[(count - 1) * 99 / 100];
+        stats->max_us = samples[count - 1];
+    }
+
+    free(samples);
+    return ESP_OK;
+}
+
+void lcd_trace_dump(void) {
+    lcd_trace_stats_t stats;
+
+    for (int metric = 0; metric < LCD_TRACE_METRIC_MAX; metric++) {
+        if (lcd_trace_get_stats(metric, &stats) != ESP_OK) {
+            continue;
+        }
+        printf("%s: n=%" PRIu32 " min=%" PRIu32 " p50=%" PRIu32 " p95=%" PRIu32 " p99=%" PRIu32 " max=%" PRIu32 " us\n",
+               metric_names[metric],
+               stats.count, stats.min_us, stats.p50_us, stats.p95_us, stats.p99_us, stats.max_us);
+        for (int i = 0; i < LCD_TRACE_HISTOGRAM_BUCKETS; i++) {
+            if (stats.histogram[i] == 0) {
+                continue;
+            }
+            if (i < LCD_TRACE_HISTOGRAM_BUCKETS - 1) {
+                printf("  < %7lu us: %" PRIu32 "\n", 1UL << (i + LCD_TRACE_HISTOGRAM_MIN_LOG2), stats.histogram[i]);
+            } else {
+                printf("  >=%7lu us: %" PRIu32 "\n", 1UL << (i - 1 + LCD_TRACE_HISTOGRAM_MIN_LOG2), stats.histogram[i]);
+            }
+        }
+    }
+}
@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+# SPDX-License-Identifier: MIT
+
+"""Generate battery_curve_lipo_pct[] of t_display_s3_battery.c.
+
+Samples the 3.7 V LiPo / Li-ion discharge equation 123 - 123 / (1 + (V / 3.7)^80)^0.165
+(https://electronics.stackexchange.com/a/551667) every STEP_MV, clamped to 0-100 % and rounded, prints the C table
+and the largest error of millivolts_to_percentage()'s integer interpolation against the equation.
+host_sim/main/host_sim_battery.c checks the table and the interpolation against the same equation.
+"""
+
+MIN_MV = 3000
+MAX_MV = 4500
+STEP_MV = 50
+PER_LINE = 10
+
+
+def reference_pct(millivolts):
+    pct = 123 - 123 / (1 + (millivolts / 3700) ** 80) ** 0.165
+    return min(max(pct, 0.0), 100.0)
+
+
+def interpolate(table, millivolts):
+    # millivolts_to_percentage(), C integer division truncates towards zero
+    offset = millivolts - MIN_MV
+    if offset <= 0:
+        return table[0]
+    idx = offset // STEP_MV
+    if idx >= len(table) - 1:
+        return table[-1]
+    lo, hi = table[idx], table[idx + 1]
+    rem = offset - idx * STEP_MV
+    return lo + int(((hi - lo) * rem + STEP_MV // 2) / STEP_MV)
+
+
+def main():
+    table = [round(reference_pct(mv)) for mv in range(MIN_MV, MAX_MV + 1, STEP_MV)]
+
+    rows = [table[i:i + PER_LINE] for i in range(0, len(table), PER_LINE)]
+    lines = [', '.join(str(pct) for pct in row) + ',' for row in rows]
+    width = max(len(line) for line in lines) + 3
+    print('static const uint8_t battery_curve_lipo_pct[] = {')
+    for i, (row, line) in enumerate(zip(rows, lines)):
+        first = MIN_MV + i * PER_LINE * STEP_MV
+        last = first + (len(row) - 1) * STEP_MV
+        span = f'{first} - {last} mV' if len(row) > 1 else f'{first} mV'
+        print(f'        {line.ljust(width)}// {span}')
+    print('};')
+
+    error, at = max((abs(interpolate(table, mv) - reference_pct(mv)), mv) for mv in range(MIN_MV, MAX_MV + 1))
+    print(f'// interpolated: {error:.2f} % max error at {at} mV')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+# SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+# SPDX-License-Identifier: MIT
+
+"""Check the HOST_SIM line of a host_sim run against host_sim/baseline.txt.
+
+host_sim runs on a simulated clock, so the line is the same on every host: a metric that moved further than its
+tolerance in the direction it regresses fails the check (exit 1), one that improved past it is reported so the
+baseline gets refreshed. --update rewrites the baseline with the values of the log.
+
+    python3 check_baseline.py host_sim.log [--update]
+"""
+
+import argparse
+import os
+import sys
+
+BASELINE = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'baseline.txt')
+HEADER = ('# HOST_SIM line of host_sim/main for the checked-in sources, checked by check_baseline.py\n'
+          '# metric         value        regresses when   tolerance (%)\n')
+
+
+def read_baseline(path):
+    metrics = []
+    with open(path) as f:
+        for line in f:
+            line = line.split('#', 1)[0].strip()
+            if line:
+                name, value, direction, tolerance = line.split()
+                metrics.append((name, value, direction, float(tolerance)))
+    return metrics
+
+
+def read_host_sim_line(path):
+    with open(path, errors='replace') as f:
+        lines = [line for line in f if line.startswith('HOST_SIM ')]
+    if not lines:
+        sys.exit(f'{path}: no HOST_SIM line, the run failed')
+    return dict(field.split('=', 1) for field in lines[-1].split()[1:])
+
+
+def check(name, base, value, direction, tolerance):
+    """Returns 'ok', 'regressed' or 'improved'."""
+    if direction == 'exact':
+        return 'ok' if value == base else 'regressed'
+    base, value = int(base, 0), int(value, 0)
+    limit = abs(base) * tolerance / 100
+    change = value - base if direction == 'higher' else base - value
+    if change > limit:
+        return 'regressed'
+    if change < -limit:
+        return 'improved'
+    return 'ok'
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('log', help='output of t_display_s3_host_sim.elf')
+    parser.add_argument('--update', action='store_true', help='rewrite the baseline with the values of the log')
+    args = parser.parse_args()
+
+    metrics = read_baseline(BASELINE)
+    measured = read_host_sim_line(args.log)
+    regressions = 0
+    for name, base, direction, tolerance in metrics:
+        if name not in measured:
+            sys.exit(f'{name} is missing from the HOST_SIM line')
+        result = check(name, base, measured[name], direction, tolerance)
+        regressions += result == 'regressed'
+        print(f'{name:16} {base:>12} -> {measured[name]:>12}  {result}')
+
+    if args.update:
+        with open(BASELINE, 'w') as f:
+            f.write(HEADER)
+            for name, _, direction, tolerance in metrics:
+                f.write(f'{name:16} {measured[name]:12} {direction:16} {tolerance:g}\n')
+        print(f'{BASELINE} updated')
+    elif regressions:
+        sys.exit(f'{regressions} metric(s) regressed past the tolerance of {BASELINE}, '
+                 'refresh it with --update if the change is intended')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,324 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Simulated espressif/button of the host simulation (host_sim/)
+//
+// The button timer runs in the esp_timer task like iot_button.c's: every CONFIG_BUTTON_PERIOD_TIME_MS it reads the
+// level of every button from its driver, debounces it over CONFIG_BUTTON_DEBOUNCE_TICKS scans and steps the button
+// through the same states. When every button enables power save, has nothing left to debounce and is back to
+// BUTTON_NONE_PRESS, the timer stops and enter_power_save() is called for each button, iot_button_resume() starts it
+// again. BUTTON_LONG_PRESS_START callbacks fire once per press when the button was held for their press time.
+
+#include <stdlib.h>
+#include <esp_log.h>
+#include <esp_check.h>
+#include <esp_timer.h>
+#include "freertos/FreeRTOS.h"
+#include "iot_button.h"
+
+static const char *TAG = "button_sim";
+
+#define BUTTON_SIM_TICKS_MS       CONFIG_BUTTON_PERIOD_TIME_MS
+#define BUTTON_SIM_SERIAL_TICKS   (CONFIG_BUTTON_LONG_PRESS_HOLD_SERIAL_TIME_MS / BUTTON_SIM_TICKS_MS)
+// callbacks of one event of a button
+#define BUTTON_SIM_MAX_CALLBACKS  4
+
+typedef enum {
+    BUTTON_SIM_DOWN_CHECK,
+    BUTTON_SIM_UP_CHECK,
+    BUTTON_SIM_REPEAT_DOWN_CHECK,
+    BUTTON_SIM_REPEAT_UP_CHECK,
+    BUTTON_SIM_LONG_UP_CHECK,
+} button_sim_state_t;
+
+typedef struct {
+    button_cb_t cb;
+    void *usr_data;
+    uint32_t press_ticks;       // BUTTON_LONG_PRESS_START: ticks held before it fires
+    bool fired;                 // BUTTON_LONG_PRESS_START: fired during this press
+} button_sim_cb_t;
+
+struct button_dev_t {
+    button_driver_t *driver;
+    uint32_t ticks;             // scans in the current state
+    uint32_t long_press_ticks;
+    uint32_t short_press_ticks;
+    uint32_t long_press_hold_cnt;
+    uint8_t repeat;
+    uint8_t debounce_cnt;
+    uint8_t level;              // debounced
+    button_sim_state_t state;
+    button_event_t event;
+    button_sim_cb_t cbs[BUTTON_EVENT_MAX][BUTTON_SIM_MAX_CALLBACKS];
+    uint8_t cb_count[BUTTON_EVENT_MAX];
+    struct button_dev_t *next;
+};
+
+static const char *event_names[] = {
+        "BUTTON_PRESS_DOWN", "BUTTON_PRESS_UP", "BUTTON_PRESS_REPEAT", "BUTTON_PRESS_REPEAT_DONE",
+        "BUTTON_SINGLE_CLICK", "BUTTON_DOUBLE_CLICK", "BUTTON_MULTIPLE_CLICK", "BUTTON_LONG_PRESS_START",
+        "BUTTON_LONG_PRESS_HOLD", "BUTTON_LONG_PRESS_UP", "BUTTON_PRESS_END", "BUTTON_EVENT_MAX", "BUTTON_NONE_PRESS",
+};
+
+static struct button_dev_t *buttons;
+static esp_timer_handle_t button_timer;
+static bool timer_running;
+static portMUX_TYPE button_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static void button_sim_call(struct button_dev_t *btn, button_event_t event) {
+    btn->event = event;
+    for (int i = 0; i < btn->cb_count[event]; i++) {
+        btn->cbs[event][i].cb(btn, btn->cbs[event][i].usr_data);
+    }
+}
+
+static void button_sim_long_press_start(struct button_dev_t *btn) {
+    for (int i = 0; i < btn->cb_count[BUTTON_LONG_PRESS_START]; i++) {
+        button_sim_cb_t *cb = &btn->cbs[BUTTON_LONG_PRESS_START][i];
+        if (!cb->fired && btn->ticks >= cb->press_ticks) {
+            cb->fired = true;
+            btn->event = BUTTON_LONG_PRESS_START;
+            cb->cb(btn, cb->usr_data);
+        }
+    }
+}
+
+static void button_sim_press_end(struct button_dev_t *btn) {
+    for (int i = 0; i < btn->cb_count[BUTTON_LONG_PRESS_START]; i++) {
+        btn->cbs[BUTTON_LONG_PRESS_START][i].fired = false;
+    }
+    btn->state = BUTTON_SIM_DOWN_CHECK;
+    button_sim_call(btn, BUTTON_PRESS_END);
+}
+
+// one scan of a button, the states of iot_button.c's button_handler()
+static void button_sim_handler(struct button_dev_t *btn) {
+    uint8_t level = btn->driver->get_key_level(btn->driver);
+
+    if (btn->state != BUTTON_SIM_DOWN_CHECK) {
+        btn->ticks++;
+    }
+    if (level != btn->level) {
+        if (++btn->debounce_cnt >= CONFIG_BUTTON_DEBOUNCE_TICKS) {
+            btn->level = level;
+            btn->debounce_cnt = 0;
+        }
+    } else {
+        btn->debounce_cnt = 0;
+    }
+
+    switch (btn->state) {
+        case BUTTON_SIM_DOWN_CHECK:
+            if (btn->level == BUTTON_ACTIVE) {
+                button_sim_call(btn, BUTTON_PRESS_DOWN);
+                btn->ticks = 0;
+                btn->repeat = 1;
+                btn->state = BUTTON_SIM_UP_CHECK;
+            } else {
+                btn->event = BUTTON_NONE_PRESS;
+            }
+            break;
+        case BUTTON_SIM_UP_CHECK:
+            if (btn->level != BUTTON_ACTIVE) {
+                button_sim_call(btn, BUTTON_PRESS_UP);
+                btn->ticks = 0;
+                btn->state = BUTTON_SIM_REPEAT_DOWN_CHECK;
+            } else {
+                button_sim_long_press_start(btn);
+                if (btn->ticks >= btn->long_press_ticks) {
+                    btn->event = BUTTON_LONG_PRESS_START;
+                    btn->state = BUTTON_SIM_LONG_UP_CHECK;
+                }
+            }
+            break;
+        case BUTTON_SIM_REPEAT_DOWN_CHECK:
+            if (btn->level == BUTTON_ACTIVE) {
+                button_sim_call(btn, BUTTON_PRESS_DOWN);
+                btn->repeat++;
+                button_sim_call(btn, BUTTON_PRESS_REPEAT);
+                btn->ticks = 0;
+                btn->state = BUTTON_SIM_REPEAT_UP_CHECK;
+            } else if (btn->ticks > btn->short_press_ticks) {
+                if (btn->repeat == 1) {
+                    button_sim_call(btn, BUTTON_SINGLE_CLICK);
+                } else if (btn->repeat == 2) {
+                    button_sim_call(btn, BUTTON_DOUBLE_CLICK);
+                }
+                button_sim_call(btn, BUTTON_PRESS_REPEAT_DONE);
+                btn->repeat = 0;
+                button_sim_press_end(btn);
+            }
+            break;
+        case BUTTON_SIM_REPEAT_UP_CHECK:
+            if (btn->level != BUTTON_ACTIVE) {
+                button_sim_call(btn, BUTTON_PRESS_UP);
+                if (btn->ticks < btn->short_press_ticks) {
+                    btn->ticks = 0;
+                    btn->state = BUTTON_SIM_REPEAT_DOWN_CHECK;
+                } else {
+                    button_sim_press_end(btn);
+                }
+            }
+            break;
+        case BUTTON_SIM_LONG_UP_CHECK:
+            if (btn->level == BUTTON_ACTIVE) {
+                button_sim_long_press_start(btn);
+                if (btn->ticks >= (btn->long_press_hold_cnt + 1) * BUTTON_SIM_SERIAL_TICKS + btn->long_press_ticks) {
+                    btn->long_press_hold_cnt++;
+                    button_sim_call(btn, BUTTON_LONG_PRESS_HOLD);
+                }
+            } else {
+                button_sim_call(btn, BUTTON_LONG_PRESS_UP);
+                button_sim_call(btn, BUTTON_PRESS_UP);
+                btn->long_press_hold_cnt = 0;
+                button_sim_press_end(btn);
+            }
+            break;
+    }
+}
+
+static void button_sim_timer_cb(void *arg) {
+    bool power_save = true;
+    for (struct button_dev_t *btn = buttons; btn != NULL; btn = btn->next) {
+        button_sim_handler(btn);
+        if (!(btn->driver->enable_power_save && btn->debounce_cnt == 0 && btn->event == BUTTON_NONE_PRESS)) {
+            power_save = false;
+        }
+    }
+    if (!power_save) {
+        return;
+    }
+
+    portENTER_CRITICAL(&button_lock);
+    bool stop = timer_running;
+    timer_running = false;
+    portEXIT_CRITICAL(&button_lock);
+    if (stop) {
+        esp_timer_stop(button_timer);
+    }
+    for (struct button_dev_t *btn = buttons; btn != NULL; btn = btn->next) {
+        if (btn->driver->enter_power_save) {
+            btn->driver->enter_power_save(btn->driver);
+        }
+    }
+}
+
+static uint32_t button_sim_time_to_ticks(uint32_t time_ms, uint32_t default_ms) {
+    uint32_t ticks = (time_ms != 0 ? time_ms : default_ms) / BUTTON_SIM_TICKS_MS;
+    return ticks > 0 ? ticks : 1;
+}
+
+esp_err_t iot_button_create(const button_config_t *config, const button_driver_t *driver, button_handle_t *ret_button) {
+    ESP_RETURN_ON_FALSE(config && driver && ret_button, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    if (button_timer == NULL) {
+        const esp_timer_create_args_t timer_args = {
+                .callback = button_sim_timer_cb,
+                .dispatch_method = ESP_TIMER_TASK,
+                .name = "button_timer",
+        };
+        ESP_RETURN_ON_ERROR(esp_timer_create(&timer_args, &button_timer), TAG, "create button timer failed");
+    }
+    struct button_dev_t *btn = calloc(1, sizeof(struct button_dev_t));
+    ESP_RETURN_ON_FALSE(btn, ESP_ERR_NO_MEM, TAG, "no memory for button");
+    btn->driver = (button_driver_t *) driver;
+    btn->long_press_ticks = button_sim_time_to_ticks(config->long_press_time, CONFIG_BUTTON_LONG_PRESS_TIME_MS);
+    btn->short_press_ticks = button_sim_time_to_ticks(config->short_press_time, CONFIG_BUTTON_SHORT_PRESS_TIME_MS);
+    btn->event = BUTTON_NONE_PRESS;
+    btn->level = BUTTON_INACTIVE;
+
+    portENTER_CRITICAL(&button_lock);
+    btn->next = buttons;
+    buttons = btn;
+    portEXIT_CRITICAL(&button_lock);
+
+    if (!driver->enable_power_save) {
+        iot_button_resume();
+    }
+    *ret_button = btn;
+    return ESP_OK;
+}
+
+esp_err_t iot_button_delete(button_handle_t btn_handle) {
+    ESP_RETURN_ON_FALSE(btn_handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_ERROR(btn_handle->driver->del(btn_handle->driver), TAG, "delete button driver failed");
+
+    portENTER_CRITICAL(&button_lock);
+    for (struct button_dev_t **btn = &buttons; *btn != NULL; btn = &(*btn)->next) {
+        if (*btn == btn_handle) {
+            *btn = btn_handle->next;
+            break;
+        }
+    }
+    bool stop = buttons == NULL && timer_running;
+    if (stop) {
+        timer_running = false;
+    }
+    portEXIT_CRITICAL(&button_lock);
+    if (stop) {
+        esp_timer_stop(button_timer);
+    }
+    free(btn_handle);
+    return ESP_OK;
+}
+
+esp_err_t iot_button_register_cb(button_handle_t btn_handle, button_event_t event, button_event_args_t *event_args,
+                                 button_cb_t cb, void *usr_data) {
+    ESP_RETURN_ON_FALSE(btn_handle && event < BUTTON_EVENT_MAX && cb, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(event != BUTTON_MULTIPLE_CLICK, ESP_ERR_NOT_SUPPORTED, TAG,
+                        "BUTTON_MULTIPLE_CLICK is not simulated");
+    ESP_RETURN_ON_FALSE(btn_handle->cb_count[event] < BUTTON_SIM_MAX_CALLBACKS, ESP_ERR_NO_MEM, TAG,
+                        "no room for another callback");
+
+    uint32_t press_ticks = btn_handle->long_press_ticks;
+    if (event == BUTTON_LONG_PRESS_START && event_args != NULL) {
+        ESP_RETURN_ON_FALSE(event_args->long_press.press_time > btn_handle->short_press_ticks * BUTTON_SIM_TICKS_MS,
+                            ESP_ERR_INVALID_ARG, TAG, "long press time shorter than a short press");
+        press_ticks = event_args->long_press.press_time / BUTTON_SIM_TICKS_MS;
+    }
+    portENTER_CRITICAL(&button_lock);
+    btn_handle->cbs[event][btn_handle->cb_count[event]++] = (button_sim_cb_t) {
+            .cb = cb,
+            .usr_data = usr_data,
+            .press_ticks = press_ticks,
+    };
+    portEXIT_CRITICAL(&button_lock);
+    return ESP_OK;
+}
+
+button_event_t iot_button_get_event(button_handle_t btn_handle) {
+    return btn_handle != NULL ? btn_handle->event : BUTTON_NONE_PRESS;
+}
+
+const char *iot_button_get_event_str(button_event_t event) {
+    return event <= BUTTON_NONE_PRESS ? event_names[event] : "event value is invalid";
+}
+
+uint8_t iot_button_get_repeat(button_handle_t btn_handle) {
+    return btn_handle != NULL ? btn_handle->repeat : 0;
+}
+
+uint32_t iot_button_get_ticks_time(button_handle_t btn_handle) {
+    return btn_handle != NULL ? btn_handle->ticks * BUTTON_SIM_TICKS_MS : 0;
+}
+
+esp_err_t iot_button_resume(void) {
+    ESP_RETURN_ON_FALSE(button_timer, ESP_ERR_INVALID_STATE, TAG, "no button created");
+    portENTER_CRITICAL(&button_lock);
+    bool start = !timer_running;
+    timer_running = true;
+    portEXIT_CRITICAL(&button_lock);
+    if (start) {
+        esp_timer_start_periodic(button_timer, BUTTON_SIM_TICKS_MS * 1000U);
+    }
+    return ESP_OK;
+}
+
+esp_err_t iot_button_stop(void) {
+    ESP_RETURN_ON_FALSE(button_timer, ESP_ERR_INVALID_STATE, TAG, "no button created");
+    portENTER_CRITICAL(&button_lock);
+    bool stop = timer_running;
+    timer_running = false;
+    portEXIT_CRITICAL(&button_lock);
+    ESP_RETURN_ON_FALSE(stop, ESP_ERR_INVALID_STATE, TAG, "button timer is not running");
+    return esp_timer_stop(button_timer);
+}
@@ -0,0 +1,26 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// GPIO button configuration of espressif/button 4.x, host simulation (host_sim/). Only the edge mode buttons of
+// t_display_s3_button.c are simulated, iot_button_new_gpio_device() isn't.
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "button_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int32_t gpio_num;
+    uint8_t active_level;       // level while pressed
+    bool enable_power_save;
+    bool disable_pull;
+} button_gpio_config_t;
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,29 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Button driver interface of espressif/button 4.x, host simulation (host_sim/)
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct button_driver_t button_driver_t;
+
+struct button_driver_t {
+    // the button timer stops once all buttons are idle and calls enter_power_save for each
+    bool enable_power_save;
+    // 1 while pressed
+    uint8_t (*get_key_level)(button_driver_t *button_driver);
+    esp_err_t (*enter_power_save)(button_driver_t *button_driver);
+    esp_err_t (*del)(button_driver_t *button_driver);
+};
+
+#ifdef __cplusplus
+}
+#endif
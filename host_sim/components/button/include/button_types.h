@@ -0,0 +1,33 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Button types of espressif/button 4.x, host simulation (host_sim/)
+
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "button_interface.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum {
+    BUTTON_INACTIVE = 0,
+    BUTTON_ACTIVE,
+};
+
+typedef struct button_dev_t *button_handle_t;
+
+typedef struct {
+    uint16_t long_press_time;   // ms, 0: CONFIG_BUTTON_LONG_PRESS_TIME_MS
+    uint16_t short_press_time;  // ms, 0: CONFIG_BUTTON_SHORT_PRESS_TIME_MS
+} button_config_t;
+
+// a button on a driver, the button timer is started unless the driver enables power save
+esp_err_t iot_button_create(const button_config_t *config, const button_driver_t *driver, button_handle_t *ret_button);
+
+#ifdef __cplusplus
+}
+#endif
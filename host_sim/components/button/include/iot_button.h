@@ -0,0 +1,68 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// espressif/button 4.x of the host simulation (host_sim/), the subset of iot_button.h the project uses. The button
+// timer scans every button each CONFIG_BUTTON_PERIOD_TIME_MS with the debounce and the press / release / click / long
+// press states of iot_button.c, and stops the same way once all power save buttons are idle. BUTTON_MULTIPLE_CLICK
+// and the per callback press times of BUTTON_LONG_PRESS_UP are not simulated.
+
+#pragma once
+
+#include "sdkconfig.h"
+#include "esp_err.h"
+#include "button_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*button_cb_t)(void *button_handle, void *usr_data);
+
+typedef enum {
+    BUTTON_PRESS_DOWN = 0,
+    BUTTON_PRESS_UP,
+    BUTTON_PRESS_REPEAT,
+    BUTTON_PRESS_REPEAT_DONE,
+    BUTTON_SINGLE_CLICK,
+    BUTTON_DOUBLE_CLICK,
+    BUTTON_MULTIPLE_CLICK,
+    BUTTON_LONG_PRESS_START,
+    BUTTON_LONG_PRESS_HOLD,
+    BUTTON_LONG_PRESS_UP,
+    BUTTON_PRESS_END,
+    BUTTON_EVENT_MAX,
+    BUTTON_NONE_PRESS,
+} button_event_t;
+
+typedef union {
+    struct long_press_t {
+        uint16_t press_time;    // ms held, for BUTTON_LONG_PRESS_START
+    } long_press;
+    struct multiple_clicks_t {
+        uint16_t clicks;
+    } multiple_clicks;
+} button_event_args_t;
+
+esp_err_t iot_button_delete(button_handle_t btn_handle);
+
+// event_args: the press time of a BUTTON_LONG_PRESS_START callback, NULL: the button's long press time
+esp_err_t iot_button_register_cb(button_handle_t btn_handle, button_event_t event, button_event_args_t *event_args,
+                                 button_cb_t cb, void *usr_data);
+
+button_event_t iot_button_get_event(button_handle_t btn_handle);
+
+const char *iot_button_get_event_str(button_event_t event);
+
+uint8_t iot_button_get_repeat(button_handle_t btn_handle);
+
+// ms since the last state change
+uint32_t iot_button_get_ticks_time(button_handle_t btn_handle);
+
+// start the button timer if it stopped
+esp_err_t iot_button_resume(void);
+
+esp_err_t iot_button_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,290 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Simulated ADC continuous driver of the host simulation (host_sim/)
+//
+// A conversion task fills one frame of conv_frame_size bytes every (samples per frame / sample_freq_hz), stores it
+// in a pool of max_store_buf_size bytes (the oldest frame is dropped when full, on_pool_ovf) and calls on_conv_done
+// like the driver's DMA interrupt. The samples don't depend on when the task runs: sample n is the scripted voltage
+// at n / sample_freq_hz seconds after adc_continuous_start(), plus the noise of a fixed seed LCG, so a script always
+// produces the same readings.
+
+#include <stdlib.h>
+#include <string.h>
+#include <esp_log.h>
+#include <esp_check.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_adc/adc_continuous.h"
+#include "esp_adc/adc_cali_scheme.h"
+
+static const char *TAG = "adc_sim";
+
+#define ADC_SIM_UNITS     2
+#define ADC_SIM_CHANNELS  10
+#define ADC_SIM_MAX_RAW   ((1 << SOC_ADC_DIGI_MAX_BITWIDTH) - 1)
+#define ADC_SIM_PATTERNS  8
+
+typedef struct {
+    adc_sim_point_t *points;
+    size_t count;
+    int noise_mv;
+} adc_sim_script_t;
+
+struct adc_continuous_ctx_t {
+    uint32_t frame_size;
+    uint32_t pool_frames;
+    uint8_t *pool;
+    uint32_t pool_head;
+    uint32_t pool_count;
+    SemaphoreHandle_t lock;     // guards the pool
+    adc_digi_pattern_config_t patterns[ADC_SIM_PATTERNS];
+    uint32_t pattern_num;
+    uint32_t sample_freq_hz;
+    adc_continuous_evt_cbs_t cbs;
+    void *user_data;
+    TaskHandle_t task;
+    volatile bool running;
+    uint64_t sample;            // samples since adc_continuous_start()
+    uint32_t lcg;
+};
+
+struct adc_cali_scheme_t {
+    adc_atten_t atten;
+};
+
+static adc_sim_script_t scripts[ADC_SIM_UNITS][ADC_SIM_CHANNELS];
+static portMUX_TYPE scripts_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static int adc_sim_script_mv(const adc_sim_script_t *script, uint32_t time_ms) {
+    if (script->count == 0) {
+        return 0;
+    }
+    const adc_sim_point_t *p = script->points;
+    if (time_ms <= p[0].time_ms) {
+        return p[0].millivolts;
+    }
+    for (size_t i = 1; i < script->count; i++) {
+        if (time_ms < p[i].time_ms) {
+            int64_t dv = p[i].millivolts - p[i - 1].millivolts;
+            return p[i - 1].millivolts + dv * (time_ms - p[i - 1].time_ms) / (p[i].time_ms - p[i - 1].time_ms);
+        }
+    }
+    return p[script->count - 1].millivolts;
+}
+
+static uint32_t adc_sim_convert(adc_continuous_handle_t handle, const adc_digi_pattern_config_t *pattern) {
+    uint32_t time_ms = handle->sample * 1000 / handle->sample_freq_hz;
+    handle->lcg = handle->lcg * 1664525 + 1013904223;
+
+    portENTER_CRITICAL(&scripts_lock);
+    const adc_sim_script_t *script = &scripts[pattern->unit][pattern->channel];
+    int mv = adc_sim_script_mv(script, time_ms);
+    int noise_mv = script->noise_mv;
+    portEXIT_CRITICAL(&scripts_lock);
+
+    if (noise_mv > 0) {
+        mv += (int) ((handle->lcg >> 16) % (2 * noise_mv + 1)) - noise_mv;
+    }
+    int raw = mv * ADC_SIM_MAX_RAW / ADC_SIM_FULL_SCALE_MV;
+    return raw < 0 ? 0 : raw > ADC_SIM_MAX_RAW ? ADC_SIM_MAX_RAW : raw;
+}
+
+static void adc_sim_task(void *arg) {
+    adc_continuous_handle_t handle = arg;
+    uint32_t samples = handle->frame_size / SOC_ADC_DIGI_RESULT_BYTES;
+    TickType_t period = pdMS_TO_TICKS(samples * 1000 / handle->sample_freq_hz);
+    if (period == 0) {
+        period = 1;
+    }
+    TickType_t last_wake = xTaskGetTickCount();
+
+    while (1) {
+        if (!handle->running) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            last_wake = xTaskGetTickCount();
+            continue;
+        }
+        vTaskDelayUntil(&last_wake, period);
+
+        xSemaphoreTake(handle->lock, portMAX_DELAY);
+        bool overflow = handle->pool_count == handle->pool_frames;
+        if (overflow) {
+            handle->pool_head = (handle->pool_head + 1) % handle->pool_frames;
+            handle->pool_count--;
+        }
+        uint32_t idx = (handle->pool_head + handle->pool_count) % handle->pool_frames;
+        uint8_t *frame = &handle->pool[idx * handle->frame_size];
+        for (uint32_t i = 0; i < samples; i++) {
+            const adc_digi_pattern_config_t *pattern = &handle->patterns[handle->sample % handle->pattern_num];
+            adc_digi_output_data_t result = {
+                    .type2 = {
+                            .data = adc_sim_convert(handle, pattern),
+                            .channel = pattern->channel,
+                            .unit = pattern->unit,
+                    },
+            };
+            memcpy(&frame[i * SOC_ADC_DIGI_RESULT_BYTES], &result, SOC_ADC_DIGI_RESULT_BYTES);
+            handle->sample++;
+        }
+        handle->pool_count++;
+        xSemaphoreGive(handle->lock);
+
+        adc_continuous_evt_data_t edata = {
+                .conv_frame_buffer = frame,
+                .size = handle->frame_size,
+        };
+        if (overflow && handle->cbs.on_pool_ovf) {
+            handle->cbs.on_pool_ovf(handle, &edata, handle->user_data);
+        }
+        if (handle->cbs.on_conv_done) {
+            handle->cbs.on_conv_done(handle, &edata, handle->user_data);
+        }
+    }
+}
+
+esp_err_t adc_continuous_new_handle(const adc_continuous_handle_cfg_t *hdl_config, adc_continuous_handle_t *ret_handle) {
+    ESP_RETURN_ON_FALSE(hdl_config && ret_handle && hdl_config->conv_frame_size % SOC_ADC_DIGI_RESULT_BYTES == 0 &&
+                        hdl_config->conv_frame_size > 0 && hdl_config->max_store_buf_size >= hdl_config->conv_frame_size,
+                        ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    adc_continuous_handle_t handle = calloc(1, sizeof(struct adc_continuous_ctx_t));
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_NO_MEM, TAG, "no memory for the adc");
+    handle->frame_size = hdl_config->conv_frame_size;
+    handle->pool_frames = hdl_config->max_store_buf_size / hdl_config->conv_frame_size;
+    handle->pool = calloc(handle->pool_frames, handle->frame_size);
+    handle->lock = xSemaphoreCreateMutex();
+    handle->lcg = 1;
+    if (handle->pool == NULL || handle->lock == NULL) {
+        adc_continuous_deinit(handle);
+        ESP_RETURN_ON_FALSE(false, ESP_ERR_NO_MEM, TAG, "no memory for the adc pool");
+    }
+    *ret_handle = handle;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_config(adc_continuous_handle_t handle, const adc_continuous_config_t *config) {
+    ESP_RETURN_ON_FALSE(handle && config && config->pattern_num > 0 && config->pattern_num <= ADC_SIM_PATTERNS &&
+                        config->sample_freq_hz > 0, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    for (uint32_t i = 0; i < config->pattern_num; i++) {
+        ESP_RETURN_ON_FALSE(config->adc_pattern[i].unit < ADC_SIM_UNITS &&
+                            config->adc_pattern[i].channel < ADC_SIM_CHANNELS, ESP_ERR_INVALID_ARG, TAG,
+                            "invalid pattern %d", (int) i);
+        handle->patterns[i] = config->adc_pattern[i];
+    }
+    handle->pattern_num = config->pattern_num;
+    handle->sample_freq_hz = config->sample_freq_hz;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_register_event_callbacks(adc_continuous_handle_t handle, const adc_continuous_evt_cbs_t *cbs,
+                                                  void *user_data) {
+    ESP_RETURN_ON_FALSE(handle && cbs, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(!handle->running, ESP_ERR_INVALID_STATE, TAG, "adc is running");
+    handle->cbs = *cbs;
+    handle->user_data = user_data;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_start(adc_continuous_handle_t handle) {
+    ESP_RETURN_ON_FALSE(handle && handle->pattern_num > 0, ESP_ERR_INVALID_STATE, TAG, "adc not configured");
+    ESP_RETURN_ON_FALSE(!handle->running, ESP_ERR_INVALID_STATE, TAG, "adc already running");
+    handle->sample = 0;
+    handle->running = true;
+    if (handle->task == NULL) {
+        BaseType_t res = xTaskCreate(adc_sim_task, "adc_sim", 4096, handle, configMAX_PRIORITIES - 2, &handle->task);
+        ESP_RETURN_ON_FALSE(res == pdPASS, ESP_ERR_NO_MEM, TAG, "create adc task failed");
+    } else {
+        xTaskNotifyGive(handle->task);
+    }
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_stop(adc_continuous_handle_t handle) {
+    ESP_RETURN_ON_FALSE(handle && handle->running, ESP_ERR_INVALID_STATE, TAG, "adc not running");
+    handle->running = false;
+    return ESP_OK;
+}
+
+esp_err_t adc_continuous_read(adc_continuous_handle_t handle, uint8_t *buf, uint32_t length_max, uint32_t *out_length,
+                              uint32_t timeout_ms) {
+    ESP_RETURN_ON_FALSE(handle && buf && out_length, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    TickType_t start = xTaskGetTickCount();
+    while (1) {
+        xSemaphoreTake(handle->lock, portMAX_DELAY);
+        if (handle->pool_count > 0) {
+            uint32_t len = length_max < handle->frame_size ? length_max : handle->frame_size;
+            memcpy(buf, &handle->pool[handle->pool_head * handle->frame_size], len);
+            handle->pool_head = (handle->pool_head + 1) % handle->pool_frames;
+            handle->pool_count--;
+            xSemaphoreGive(handle->lock);
+            *out_length = len;
+            return ESP_OK;
+        }
+        xSemaphoreGive(handle->lock);
+
+        if (timeout_ms == 0 || xTaskGetTickCount() - start >= pdMS_TO_TICKS(timeout_ms)) {
+            *out_length = 0;
+            return ESP_ERR_TIMEOUT;
+        }
+        vTaskDelay(1);
+    }
+}
+
+esp_err_t adc_continuous_deinit(adc_continuous_handle_t handle) {
+    ESP_RETURN_ON_FALSE(handle && !handle->running, ESP_ERR_INVALID_STATE, TAG, "adc is running");
+    if (handle->task) {
+        vTaskDelete(handle->task);
+    }
+    if (handle->lock) {
+        vSemaphoreDelete(handle->lock);
+    }
+    free(handle->pool);
+    free(handle);
+    return ESP_OK;
+}
+
+esp_err_t adc_sim_set_script(adc_unit_t unit, adc_channel_t channel, const adc_sim_point_t *points, size_t count,
+                             int noise_mv) {
+    ESP_RETURN_ON_FALSE(unit < ADC_SIM_UNITS && channel < ADC_SIM_CHANNELS && (points || count == 0),
+                        ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    adc_sim_point_t *copy = NULL;
+    if (count > 0) {
+        copy = malloc(count * sizeof(adc_sim_point_t));
+        ESP_RETURN_ON_FALSE(copy, ESP_ERR_NO_MEM, TAG, "no memory for the script");
+        memcpy(copy, points, count * sizeof(adc_sim_point_t));
+    }
+
+    portENTER_CRITICAL(&scripts_lock);
+    adc_sim_point_t *old = scripts[unit][channel].points;
+    scripts[unit][channel] = (adc_sim_script_t) {
+            .points = copy,
+            .count = count,
+            .noise_mv = noise_mv,
+    };
+    portEXIT_CRITICAL(&scripts_lock);
+    free(old);
+    return ESP_OK;
+}
+
+esp_err_t adc_cali_create_scheme_curve_fitting(const adc_cali_curve_fitting_config_t *config,
+                                               adc_cali_handle_t *ret_handle) {
+    ESP_RETURN_ON_FALSE(config && ret_handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    adc_cali_handle_t handle = calloc(1, sizeof(struct adc_cali_scheme_t));
+    ESP_RETURN_ON_FALSE(handle, ESP_ERR_NO_MEM, TAG, "no memory for the calibration");
+    handle->atten = config->atten;
+    *ret_handle = handle;
+    return ESP_OK;
+}
+
+esp_err_t adc_cali_delete_scheme_curve_fitting(adc_cali_handle_t handle) {
+    free(handle);
+    return ESP_OK;
+}
+
+esp_err_t adc_cali_raw_to_voltage(adc_cali_handle_t handle, int raw, int *voltage) {
+    ESP_RETURN_ON_FALSE(handle && voltage, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    *voltage = (raw * ADC_SIM_FULL_SCALE_MV + ADC_SIM_MAX_RAW / 2) / ADC_SIM_MAX_RAW;
+    return ESP_OK;
+}
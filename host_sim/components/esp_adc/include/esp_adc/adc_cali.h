@@ -0,0 +1,21 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// ADC calibration of the host simulation, same API as ESP-IDF's esp_adc/adc_cali.h
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_err.h"
+#include "esp_adc/adc_types.h"
+
+typedef struct adc_cali_scheme_t *adc_cali_handle_t;
+
+esp_err_t adc_cali_raw_to_voltage(adc_cali_handle_t handle, int raw, int *voltage);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,32 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// ADC calibration schemes of the host simulation, same API as ESP-IDF's esp_adc/adc_cali_scheme.h. The simulated
+// ADC is linear over ADC_SIM_FULL_SCALE_MV, its calibration is exact.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_adc/adc_cali.h"
+
+// input voltage of the largest raw value at ADC_ATTEN_DB_12
+#define ADC_SIM_FULL_SCALE_MV 3100
+
+typedef struct {
+    adc_unit_t unit_id;
+    adc_channel_t chan;
+    adc_atten_t atten;
+    adc_bitwidth_t bitwidth;
+} adc_cali_curve_fitting_config_t;
+
+esp_err_t adc_cali_create_scheme_curve_fitting(const adc_cali_curve_fitting_config_t *config,
+                                               adc_cali_handle_t *ret_handle);
+
+esp_err_t adc_cali_delete_scheme_curve_fitting(adc_cali_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,77 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// ADC continuous driver of the host simulation, same API as ESP-IDF's esp_adc/adc_continuous.h. The conversions
+// read the pin voltage scripted with adc_sim_set_script().
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_adc/adc_types.h"
+
+typedef struct adc_continuous_ctx_t *adc_continuous_handle_t;
+
+typedef struct {
+    uint32_t max_store_buf_size;
+    uint32_t conv_frame_size;
+    struct {
+        uint32_t flush_pool: 1;
+    } flags;
+} adc_continuous_handle_cfg_t;
+
+typedef struct {
+    uint32_t pattern_num;
+    adc_digi_pattern_config_t *adc_pattern;
+    uint32_t sample_freq_hz;
+    adc_digi_convert_mode_t conv_mode;
+    adc_digi_output_format_t format;
+} adc_continuous_config_t;
+
+typedef struct {
+    uint8_t *conv_frame_buffer;
+    uint32_t size;
+} adc_continuous_evt_data_t;
+
+typedef bool (*adc_continuous_callback_t)(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata,
+                                          void *user_data);
+
+typedef struct {
+    adc_continuous_callback_t on_conv_done;
+    adc_continuous_callback_t on_pool_ovf;
+} adc_continuous_evt_cbs_t;
+
+// pin voltage at a time since adc_continuous_start(), linear in between, the last one holds
+typedef struct {
+    uint32_t time_ms;
+    int millivolts;
+} adc_sim_point_t;
+
+esp_err_t adc_continuous_new_handle(const adc_continuous_handle_cfg_t *hdl_config, adc_continuous_handle_t *ret_handle);
+
+esp_err_t adc_continuous_config(adc_continuous_handle_t handle, const adc_continuous_config_t *config);
+
+esp_err_t adc_continuous_register_event_callbacks(adc_continuous_handle_t handle, const adc_continuous_evt_cbs_t *cbs,
+                                                  void *user_data);
+
+esp_err_t adc_continuous_start(adc_continuous_handle_t handle);
+
+esp_err_t adc_continuous_stop(adc_continuous_handle_t handle);
+
+esp_err_t adc_continuous_read(adc_continuous_handle_t handle, uint8_t *buf, uint32_t length_max, uint32_t *out_length,
+                              uint32_t timeout_ms);
+
+esp_err_t adc_continuous_deinit(adc_continuous_handle_t handle);
+
+// script the voltage of a channel's pin, with +-noise_mv of deterministic noise per sample (points are copied)
+esp_err_t adc_sim_set_script(adc_unit_t unit, adc_channel_t channel, const adc_sim_point_t *points, size_t count,
+                             int noise_mv);
+
+#ifdef __cplusplus
+}
+#endif
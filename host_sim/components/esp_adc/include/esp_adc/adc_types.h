@@ -0,0 +1,91 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// ADC types of the host simulation, the subset of ESP-IDF's hal/adc_types.h and the ESP32-S3 ADC caps the battery
+// monitor uses
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#ifndef SOC_ADC_DIGI_RESULT_BYTES
+#define SOC_ADC_DIGI_RESULT_BYTES  4
+#endif
+#ifndef SOC_ADC_DIGI_MAX_BITWIDTH
+#define SOC_ADC_DIGI_MAX_BITWIDTH  12
+#endif
+
+typedef enum {
+    ADC_UNIT_1,
+    ADC_UNIT_2,
+} adc_unit_t;
+
+typedef enum {
+    ADC_CHANNEL_0,
+    ADC_CHANNEL_1,
+    ADC_CHANNEL_2,
+    ADC_CHANNEL_3,
+    ADC_CHANNEL_4,
+    ADC_CHANNEL_5,
+    ADC_CHANNEL_6,
+    ADC_CHANNEL_7,
+    ADC_CHANNEL_8,
+    ADC_CHANNEL_9,
+} adc_channel_t;
+
+typedef enum {
+    ADC_ATTEN_DB_0,
+    ADC_ATTEN_DB_2_5,
+    ADC_ATTEN_DB_6,
+    ADC_ATTEN_DB_12,
+} adc_atten_t;
+
+typedef enum {
+    ADC_BITWIDTH_DEFAULT = 0,
+    ADC_BITWIDTH_9 = 9,
+    ADC_BITWIDTH_10 = 10,
+    ADC_BITWIDTH_11 = 11,
+    ADC_BITWIDTH_12 = 12,
+    ADC_BITWIDTH_13 = 13,
+} adc_bitwidth_t;
+
+typedef enum {
+    ADC_CONV_SINGLE_UNIT_1 = 1,
+    ADC_CONV_SINGLE_UNIT_2 = 2,
+    ADC_CONV_BOTH_UNIT = 3,
+    ADC_CONV_ALTER_UNIT = 7,
+} adc_digi_convert_mode_t;
+
+typedef enum {
+    ADC_DIGI_OUTPUT_FORMAT_TYPE1,
+    ADC_DIGI_OUTPUT_FORMAT_TYPE2,
+} adc_digi_output_format_t;
+
+typedef struct {
+    uint8_t atten;
+    uint8_t channel;
+    uint8_t unit;
+    uint8_t bit_width;
+} adc_digi_pattern_config_t;
+
+// ESP32-S3 conversion result
+typedef struct {
+    union {
+        struct {
+            uint32_t data: 12;
+            uint32_t reserved12: 1;
+            uint32_t channel: 4;
+            uint32_t unit: 1;
+            uint32_t reserved17_31: 14;
+        } type2;
+        uint32_t val;
+    };
+} adc_digi_output_data_t;
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,194 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Simulated GPIO pins of the host simulation (host_sim/)
+
+#include <esp_log.h>
+#include <esp_check.h>
+#include "freertos/FreeRTOS.h"
+#include "driver/gpio.h"
+
+static const char *TAG = "gpio_sim";
+
+typedef struct {
+    gpio_mode_t mode;
+    uint8_t out_level;
+    uint8_t in_level;
+    bool in_driven;             // set by gpio_sim_set_input(), kept by gpio_config(), else the pin reads its pull
+    bool pull_up;
+    gpio_int_type_t intr_type;
+    bool intr_enabled;
+    gpio_isr_t isr;
+    void *isr_arg;
+} gpio_sim_pin_t;
+
+static gpio_sim_pin_t pins[GPIO_NUM_MAX];
+static bool isr_service_installed;
+static portMUX_TYPE pins_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static bool gpio_sim_valid(gpio_num_t gpio_num) {
+    return gpio_num >= 0 && gpio_num < GPIO_NUM_MAX;
+}
+
+// called with pins_lock held
+static int gpio_sim_level(const gpio_sim_pin_t *pin) {
+    if (pin->mode & GPIO_MODE_INPUT) {
+        return pin->in_driven ? pin->in_level : pin->pull_up;
+    }
+    return pin->out_level;
+}
+
+// runs the handler of a pin if its interrupt is enabled and fires for the level it went from (-1: none) to its
+// current one, the handler runs without pins_lock held
+static void gpio_sim_check_intr(gpio_num_t gpio_num, int from_level) {
+    portENTER_CRITICAL(&pins_lock);
+    gpio_sim_pin_t pin = pins[gpio_num];
+    portEXIT_CRITICAL(&pins_lock);
+
+    int level = gpio_sim_level(&pin);
+    bool fire = false;
+    switch (pin.intr_type) {
+        case GPIO_INTR_POSEDGE:
+            fire = from_level == 0 && level == 1;
+            break;
+        case GPIO_INTR_NEGEDGE:
+            fire = from_level == 1 && level == 0;
+            break;
+        case GPIO_INTR_ANYEDGE:
+            fire = from_level >= 0 && from_level != level;
+            break;
+        case GPIO_INTR_LOW_LEVEL:
+            fire = level == 0;
+            break;
+        case GPIO_INTR_HIGH_LEVEL:
+            fire = level == 1;
+            break;
+        default:
+            break;
+    }
+    if (fire && pin.intr_enabled && pin.isr != NULL && isr_service_installed) {
+        pin.isr(pin.isr_arg);
+    }
+}
+
+esp_err_t gpio_config(const gpio_config_t *pGPIOConfig) {
+    ESP_RETURN_ON_FALSE(pGPIOConfig && pGPIOConfig->pin_bit_mask != 0 &&
+                        pGPIOConfig->pin_bit_mask < (1ULL << GPIO_NUM_MAX), ESP_ERR_INVALID_ARG, TAG,
+                        "invalid argument");
+    portENTER_CRITICAL(&pins_lock);
+    for (int i = 0; i < GPIO_NUM_MAX; i++) {
+        if (pGPIOConfig->pin_bit_mask & (1ULL << i)) {
+            pins[i].mode = pGPIOConfig->mode;
+            pins[i].pull_up = pGPIOConfig->pull_up_en == GPIO_PULLUP_ENABLE;
+            pins[i].intr_type = pGPIOConfig->intr_type;
+            pins[i].intr_enabled = pGPIOConfig->intr_type != GPIO_INTR_DISABLE;
+        }
+    }
+    portEXIT_CRITICAL(&pins_lock);
+    return ESP_OK;
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio_num) {
+    ESP_RETURN_ON_FALSE(gpio_sim_valid(gpio_num), ESP_ERR_INVALID_ARG, TAG, "invalid gpio %d", gpio_num);
+    portENTER_CRITICAL(&pins_lock);
+    pins[gpio_num] = (gpio_sim_pin_t) {
+            .mode = GPIO_MODE_INPUT, .pull_up = true,
+            .in_level = pins[gpio_num].in_level, .in_driven = pins[gpio_num].in_driven,
+            .isr = pins[gpio_num].isr, .isr_arg = pins[gpio_num].isr_arg
+    };
+    portEXIT_CRITICAL(&pins_lock);
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level) {
+    ESP_RETURN_ON_FALSE(gpio_sim_valid(gpio_num), ESP_ERR_INVALID_ARG, TAG, "invalid gpio %d", gpio_num);
+    portENTER_CRITICAL(&pins_lock);
+    pins[gpio_num].out_level = level != 0;
+    portEXIT_CRITICAL(&pins_lock);
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num) {
+    if (!gpio_sim_valid(gpio_num)) {
+        return 0;
+    }
+    portENTER_CRITICAL(&pins_lock);
+    int level = gpio_sim_level(&pins[gpio_num]);
+    portEXIT_CRITICAL(&pins_lock);
+    return level;
+}
+
+esp_err_t gpio_set_intr_type(gpio_num_t gpio_num, gpio_int_type_t intr_type) {
+    ESP_RETURN_ON_FALSE(gpio_sim_valid(gpio_num), ESP_ERR_INVALID_ARG, TAG, "invalid gpio %d", gpio_num);
+    portENTER_CRITICAL(&pins_lock);
+    pins[gpio_num].intr_type = intr_type;
+    portEXIT_CRITICAL(&pins_lock);
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_enable(gpio_num_t gpio_num) {
+    ESP_RETURN_ON_FALSE(gpio_sim_valid(gpio_num), ESP_ERR_INVALID_ARG, TAG, "invalid gpio %d", gpio_num);
+    portENTER_CRITICAL(&pins_lock);
+    pins[gpio_num].intr_enabled = true;
+    portEXIT_CRITICAL(&pins_lock);
+    // a level interrupt fires right away when the pin is already at its level
+    gpio_sim_check_intr(gpio_num, -1);
+    return ESP_OK;
+}
+
+esp_err_t gpio_intr_disable(gpio_num_t gpio_num) {
+    ESP_RETURN_ON_FALSE(gpio_sim_valid(gpio_num), ESP_ERR_INVALID_ARG, TAG, "invalid gpio %d", gpio_num);
+    portENTER_CRITICAL(&pins_lock);
+    pins[gpio_num].intr_enabled = false;
+    portEXIT_CRITICAL(&pins_lock);
+    return ESP_OK;
+}
+
+esp_err_t gpio_install_isr_service(int intr_alloc_flags) {
+    portENTER_CRITICAL(&pins_lock);
+    bool installed = isr_service_installed;
+    isr_service_installed = true;
+    portEXIT_CRITICAL(&pins_lock);
+    ESP_RETURN_ON_FALSE(!installed, ESP_ERR_INVALID_STATE, TAG, "GPIO isr service already installed");
+    return ESP_OK;
+}
+
+void gpio_uninstall_isr_service(void) {
+    portENTER_CRITICAL(&pins_lock);
+    isr_service_installed = false;
+    for (int i = 0; i < GPIO_NUM_MAX; i++) {
+        pins[i].isr = NULL;
+        pins[i].isr_arg = NULL;
+    }
+    portEXIT_CRITICAL(&pins_lock);
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void *args) {
+    ESP_RETURN_ON_FALSE(gpio_sim_valid(gpio_num), ESP_ERR_INVALID_ARG, TAG, "invalid gpio %d", gpio_num);
+    ESP_RETURN_ON_FALSE(isr_service_installed, ESP_ERR_INVALID_STATE, TAG, "GPIO isr service is not installed");
+    portENTER_CRITICAL(&pins_lock);
+    pins[gpio_num].isr = isr_handler;
+    pins[gpio_num].isr_arg = args;
+    portEXIT_CRITICAL(&pins_lock);
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio_num) {
+    ESP_RETURN_ON_FALSE(gpio_sim_valid(gpio_num), ESP_ERR_INVALID_ARG, TAG, "invalid gpio %d", gpio_num);
+    portENTER_CRITICAL(&pins_lock);
+    pins[gpio_num].isr = NULL;
+    pins[gpio_num].isr_arg = NULL;
+    portEXIT_CRITICAL(&pins_lock);
+    return ESP_OK;
+}
+
+esp_err_t gpio_sim_set_input(gpio_num_t gpio_num, uint32_t level) {
+    ESP_RETURN_ON_FALSE(gpio_sim_valid(gpio_num), ESP_ERR_INVALID_ARG, TAG, "invalid gpio %d", gpio_num);
+    portENTER_CRITICAL(&pins_lock);
+    int from_level = gpio_sim_level(&pins[gpio_num]);
+    pins[gpio_num].in_level = level != 0;
+    pins[gpio_num].in_driven = true;
+    portEXIT_CRITICAL(&pins_lock);
+    gpio_sim_check_intr(gpio_num, from_level);
+    return ESP_OK;
+}
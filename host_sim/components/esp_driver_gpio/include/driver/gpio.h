@@ -0,0 +1,137 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// GPIO driver of the host simulation, the subset of ESP-IDF's driver/gpio.h the project uses. Outputs keep the
+// level they were set to, inputs read the level set with gpio_sim_set_input() (or their pull). The interrupt handler
+// of a pin runs in the task that changes its input level or enables its interrupt.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+typedef enum {
+    GPIO_NUM_NC = -1,
+    GPIO_NUM_0 = 0,
+    GPIO_NUM_1,
+    GPIO_NUM_2,
+    GPIO_NUM_3,
+    GPIO_NUM_4,
+    GPIO_NUM_5,
+    GPIO_NUM_6,
+    GPIO_NUM_7,
+    GPIO_NUM_8,
+    GPIO_NUM_9,
+    GPIO_NUM_10,
+    GPIO_NUM_11,
+    GPIO_NUM_12,
+    GPIO_NUM_13,
+    GPIO_NUM_14,
+    GPIO_NUM_15,
+    GPIO_NUM_16,
+    GPIO_NUM_17,
+    GPIO_NUM_18,
+    GPIO_NUM_19,
+    GPIO_NUM_20,
+    GPIO_NUM_21,
+    GPIO_NUM_26 = 26,
+    GPIO_NUM_27,
+    GPIO_NUM_28,
+    GPIO_NUM_29,
+    GPIO_NUM_30,
+    GPIO_NUM_31,
+    GPIO_NUM_32,
+    GPIO_NUM_33,
+    GPIO_NUM_34,
+    GPIO_NUM_35,
+    GPIO_NUM_36,
+    GPIO_NUM_37,
+    GPIO_NUM_38,
+    GPIO_NUM_39,
+    GPIO_NUM_40,
+    GPIO_NUM_41,
+    GPIO_NUM_42,
+    GPIO_NUM_43,
+    GPIO_NUM_44,
+    GPIO_NUM_45,
+    GPIO_NUM_46,
+    GPIO_NUM_47,
+    GPIO_NUM_48,
+    GPIO_NUM_MAX,
+} gpio_num_t;
+
+#define GPIO_IS_VALID_GPIO(gpio_num) ((gpio_num) >= 0 && (gpio_num) < GPIO_NUM_MAX)
+
+typedef void (*gpio_isr_t)(void *arg);
+
+typedef enum {
+    GPIO_MODE_DISABLE = 0,
+    GPIO_MODE_INPUT = 1,
+    GPIO_MODE_OUTPUT = 2,
+    GPIO_MODE_OUTPUT_OD = 6,
+    GPIO_MODE_INPUT_OUTPUT_OD = 7,
+    GPIO_MODE_INPUT_OUTPUT = 3,
+} gpio_mode_t;
+
+typedef enum {
+    GPIO_PULLUP_DISABLE = 0,
+    GPIO_PULLUP_ENABLE = 1,
+} gpio_pullup_t;
+
+typedef enum {
+    GPIO_PULLDOWN_DISABLE = 0,
+    GPIO_PULLDOWN_ENABLE = 1,
+} gpio_pulldown_t;
+
+typedef enum {
+    GPIO_INTR_DISABLE = 0,
+    GPIO_INTR_POSEDGE = 1,
+    GPIO_INTR_NEGEDGE = 2,
+    GPIO_INTR_ANYEDGE = 3,
+    GPIO_INTR_LOW_LEVEL = 4,
+    GPIO_INTR_HIGH_LEVEL = 5,
+} gpio_int_type_t;
+
+typedef struct {
+    uint64_t pin_bit_mask;
+    gpio_mode_t mode;
+    gpio_pullup_t pull_up_en;
+    gpio_pulldown_t pull_down_en;
+    gpio_int_type_t intr_type;
+} gpio_config_t;
+
+esp_err_t gpio_config(const gpio_config_t *pGPIOConfig);
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio_num);
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level);
+
+int gpio_get_level(gpio_num_t gpio_num);
+
+esp_err_t gpio_set_intr_type(gpio_num_t gpio_num, gpio_int_type_t intr_type);
+
+esp_err_t gpio_intr_enable(gpio_num_t gpio_num);
+
+esp_err_t gpio_intr_disable(gpio_num_t gpio_num);
+
+// ESP_ERR_INVALID_STATE if already installed
+esp_err_t gpio_install_isr_service(int intr_alloc_flags);
+
+void gpio_uninstall_isr_service(void);
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void *args);
+
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio_num);
+
+// drive the level an input pin reads, as the outside world would. An enabled interrupt of the pin fires on the edge
+// or level of its type before this returns
+esp_err_t gpio_sim_set_input(gpio_num_t gpio_num, uint32_t level);
+
+#ifdef __cplusplus
+}
+#endif
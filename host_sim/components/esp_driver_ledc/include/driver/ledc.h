@@ -0,0 +1,144 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// LEDC driver of the host simulation, the subset of ESP-IDF's driver/ledc.h the AW9364 driver uses. The duty of a
+// channel, fades included, is evaluated against esp_timer when it is read (ledc_get_duty(), ledc_sim_get_channel()).
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+// the aw9364 driver gets malloc() / free() through driver/ledc.h, as with ESP-IDF's headers
+#include <stdlib.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+
+typedef enum {
+    LEDC_LOW_SPEED_MODE,
+    LEDC_SPEED_MODE_MAX,
+} ledc_mode_t;
+
+typedef enum {
+    LEDC_CHANNEL_0,
+    LEDC_CHANNEL_1,
+    LEDC_CHANNEL_2,
+    LEDC_CHANNEL_3,
+    LEDC_CHANNEL_4,
+    LEDC_CHANNEL_5,
+    LEDC_CHANNEL_6,
+    LEDC_CHANNEL_7,
+    LEDC_CHANNEL_MAX,
+} ledc_channel_t;
+
+typedef enum {
+    LEDC_TIMER_0,
+    LEDC_TIMER_1,
+    LEDC_TIMER_2,
+    LEDC_TIMER_3,
+    LEDC_TIMER_MAX,
+} ledc_timer_t;
+
+typedef enum {
+    LEDC_TIMER_1_BIT = 1,
+    LEDC_TIMER_2_BIT,
+    LEDC_TIMER_3_BIT,
+    LEDC_TIMER_4_BIT,
+    LEDC_TIMER_5_BIT,
+    LEDC_TIMER_6_BIT,
+    LEDC_TIMER_7_BIT,
+    LEDC_TIMER_8_BIT,
+    LEDC_TIMER_9_BIT,
+    LEDC_TIMER_10_BIT,
+    LEDC_TIMER_11_BIT,
+    LEDC_TIMER_12_BIT,
+    LEDC_TIMER_13_BIT,
+    LEDC_TIMER_14_BIT,
+    LEDC_TIMER_BIT_MAX,
+} ledc_timer_bit_t;
+
+typedef enum {
+    LEDC_INTR_DISABLE,
+    LEDC_INTR_FADE_END,
+    LEDC_INTR_MAX,
+} ledc_intr_type_t;
+
+typedef enum {
+    LEDC_AUTO_CLK,
+    LEDC_USE_APB_CLK,
+    LEDC_USE_RC_FAST_CLK,
+    LEDC_USE_XTAL_CLK,
+} ledc_clk_cfg_t;
+
+typedef enum {
+    LEDC_FADE_NO_WAIT,
+    LEDC_FADE_WAIT_DONE,
+    LEDC_FADE_MAX,
+} ledc_fade_mode_t;
+
+typedef struct {
+    int gpio_num;
+    ledc_mode_t speed_mode;
+    ledc_channel_t channel;
+    ledc_intr_type_t intr_type;
+    ledc_timer_t timer_sel;
+    uint32_t duty;
+    int hpoint;
+    struct {
+        unsigned int output_invert: 1;
+    } flags;
+} ledc_channel_config_t;
+
+typedef struct {
+    ledc_mode_t speed_mode;
+    ledc_timer_bit_t duty_resolution;
+    ledc_timer_t timer_num;
+    uint32_t freq_hz;
+    ledc_clk_cfg_t clk_cfg;
+    bool deconfigure;
+} ledc_timer_config_t;
+
+// state of a simulated channel
+typedef struct {
+    int gpio_num;               // -1: not configured
+    uint32_t freq_hz;
+    uint32_t max_duty;          // (1 << duty_resolution) - 1
+    uint32_t duty;              // output duty now
+    uint32_t target_duty;       // duty at the end of the fade
+    bool paused;
+    uint32_t updates;           // duty updates and fades started
+} ledc_sim_channel_t;
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t *timer_conf);
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t *ledc_conf);
+
+esp_err_t ledc_fade_func_install(int intr_alloc_flags);
+
+void ledc_fade_func_uninstall(void);
+
+esp_err_t ledc_set_fade_time_and_start(ledc_mode_t speed_mode, ledc_channel_t channel, uint32_t target_duty,
+                                       uint32_t max_fade_time_ms, ledc_fade_mode_t fade_mode);
+
+esp_err_t ledc_set_duty(ledc_mode_t speed_mode, ledc_channel_t channel, uint32_t duty);
+
+esp_err_t ledc_update_duty(ledc_mode_t speed_mode, ledc_channel_t channel);
+
+uint32_t ledc_get_duty(ledc_mode_t speed_mode, ledc_channel_t channel);
+
+esp_err_t ledc_fade_stop(ledc_mode_t speed_mode, ledc_channel_t channel);
+
+esp_err_t ledc_timer_pause(ledc_mode_t speed_mode, ledc_timer_t timer_sel);
+
+esp_err_t ledc_timer_resume(ledc_mode_t speed_mode, ledc_timer_t timer_sel);
+
+esp_err_t ledc_stop(ledc_mode_t speed_mode, ledc_channel_t channel, uint32_t idle_level);
+
+esp_err_t ledc_sim_get_channel(ledc_channel_t channel, ledc_sim_channel_t *state);
+
+#ifdef __cplusplus
+}
+#endif
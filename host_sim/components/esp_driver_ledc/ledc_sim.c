@@ -0,0 +1,204 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Simulated LEDC channels of the host simulation (host_sim/)
+//
+// A channel keeps the duty it was updated to, a fade is kept as its start and end (duty and esp_timer time) and the
+// output duty is interpolated linearly whenever it is read, like the hardware stepping the duty on its own.
+
+#include <esp_log.h>
+#include <esp_check.h>
+#include <esp_timer.h>
+#include "freertos/FreeRTOS.h"
+#include "driver/ledc.h"
+
+static const char *TAG = "ledc_sim";
+
+typedef struct {
+    uint32_t freq_hz;
+    uint32_t max_duty;
+    bool paused;
+} ledc_sim_timer_t;
+
+typedef struct {
+    int gpio_num;
+    ledc_timer_t timer;
+    uint32_t duty;              // set by ledc_set_duty(), output from ledc_update_duty()
+    uint32_t start_duty;
+    uint32_t target_duty;
+    int64_t fade_start_us;
+    int64_t fade_end_us;
+    uint32_t updates;
+} ledc_sim_chan_t;
+
+static ledc_sim_timer_t timers[LEDC_TIMER_MAX];
+static ledc_sim_chan_t channels[LEDC_CHANNEL_MAX] = {
+        [0 ... LEDC_CHANNEL_MAX - 1] = {.gpio_num = -1},
+};
+static bool fade_installed;
+static portMUX_TYPE ledc_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t ledc_sim_output_duty(const ledc_sim_chan_t *chan, int64_t now) {
+    if (now >= chan->fade_end_us) {
+        return chan->target_duty;
+    }
+    int64_t elapsed = now - chan->fade_start_us;
+    int64_t span = chan->fade_end_us - chan->fade_start_us;
+    return chan->start_duty + ((int64_t) chan->target_duty - chan->start_duty) * elapsed / span;
+}
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t *timer_conf) {
+    ESP_RETURN_ON_FALSE(timer_conf && timer_conf->timer_num < LEDC_TIMER_MAX, ESP_ERR_INVALID_ARG, TAG,
+                        "invalid argument");
+    ledc_sim_timer_t timer = {0};
+    if (!timer_conf->deconfigure) {
+        ESP_RETURN_ON_FALSE(timer_conf->duty_resolution > 0 && timer_conf->duty_resolution < LEDC_TIMER_BIT_MAX,
+                            ESP_ERR_INVALID_ARG, TAG, "invalid duty resolution");
+        timer.freq_hz = timer_conf->freq_hz;
+        timer.max_duty = (1 << timer_conf->duty_resolution) - 1;
+    }
+    portENTER_CRITICAL(&ledc_lock);
+    timers[timer_conf->timer_num] = timer;
+    portEXIT_CRITICAL(&ledc_lock);
+    return ESP_OK;
+}
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t *ledc_conf) {
+    ESP_RETURN_ON_FALSE(ledc_conf && ledc_conf->channel < LEDC_CHANNEL_MAX && ledc_conf->timer_sel < LEDC_TIMER_MAX,
+                        ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    portENTER_CRITICAL(&ledc_lock);
+    channels[ledc_conf->channel] = (ledc_sim_chan_t) {
+            .gpio_num = ledc_conf->gpio_num,
+            .timer = ledc_conf->timer_sel,
+            .duty = ledc_conf->duty,
+            .start_duty = ledc_conf->duty,
+            .target_duty = ledc_conf->duty,
+    };
+    portEXIT_CRITICAL(&ledc_lock);
+    return ESP_OK;
+}
+
+esp_err_t ledc_fade_func_install(int intr_alloc_flags) {
+    ESP_RETURN_ON_FALSE(!fade_installed, ESP_ERR_INVALID_STATE, TAG, "fade function already installed");
+    fade_installed = true;
+    return ESP_OK;
+}
+
+void ledc_fade_func_uninstall(void) {
+    fade_installed = false;
+}
+
+esp_err_t ledc_set_fade_time_and_start(ledc_mode_t speed_mode, ledc_channel_t channel, uint32_t target_duty,
+                                       uint32_t max_fade_time_ms, ledc_fade_mode_t fade_mode) {
+    ESP_RETURN_ON_FALSE(channel < LEDC_CHANNEL_MAX, ESP_ERR_INVALID_ARG, TAG, "invalid channel");
+    ESP_RETURN_ON_FALSE(fade_installed, ESP_ERR_INVALID_STATE, TAG, "fade function not installed");
+
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&ledc_lock);
+    ledc_sim_chan_t *chan = &channels[channel];
+    chan->start_duty = ledc_sim_output_duty(chan, now);
+    chan->target_duty = target_duty;
+    chan->duty = target_duty;
+    chan->fade_start_us = now;
+    chan->fade_end_us = now + max_fade_time_ms * 1000LL;
+    chan->updates++;
+    portEXIT_CRITICAL(&ledc_lock);
+
+    if (fade_mode == LEDC_FADE_WAIT_DONE) {
+        // the fade only progresses with the simulated clock, the caller's wait is what moves it
+        esp_timer_sim_advance((uint64_t) max_fade_time_ms * 1000);
+    }
+    return ESP_OK;
+}
+
+esp_err_t ledc_set_duty(ledc_mode_t speed_mode, ledc_channel_t channel, uint32_t duty) {
+    ESP_RETURN_ON_FALSE(channel < LEDC_CHANNEL_MAX, ESP_ERR_INVALID_ARG, TAG, "invalid channel");
+    portENTER_CRITICAL(&ledc_lock);
+    channels[channel].duty = duty;
+    portEXIT_CRITICAL(&ledc_lock);
+    return ESP_OK;
+}
+
+esp_err_t ledc_update_duty(ledc_mode_t speed_mode, ledc_channel_t channel) {
+    ESP_RETURN_ON_FALSE(channel < LEDC_CHANNEL_MAX, ESP_ERR_INVALID_ARG, TAG, "invalid channel");
+    portENTER_CRITICAL(&ledc_lock);
+    ledc_sim_chan_t *chan = &channels[channel];
+    chan->start_duty = chan->duty;
+    chan->target_duty = chan->duty;
+    chan->fade_end_us = 0;
+    chan->updates++;
+    portEXIT_CRITICAL(&ledc_lock);
+    return ESP_OK;
+}
+
+uint32_t ledc_get_duty(ledc_mode_t speed_mode, ledc_channel_t channel) {
+    if (channel >= LEDC_CHANNEL_MAX) {
+        return 0;
+    }
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&ledc_lock);
+    uint32_t duty = ledc_sim_output_duty(&channels[channel], now);
+    portEXIT_CRITICAL(&ledc_lock);
+    return duty;
+}
+
+esp_err_t ledc_fade_stop(ledc_mode_t speed_mode, ledc_channel_t channel) {
+    ESP_RETURN_ON_FALSE(channel < LEDC_CHANNEL_MAX, ESP_ERR_INVALID_ARG, TAG, "invalid channel");
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&ledc_lock);
+    ledc_sim_chan_t *chan = &channels[channel];
+    chan->duty = ledc_sim_output_duty(chan, now);
+    chan->start_duty = chan->duty;
+    chan->target_duty = chan->duty;
+    chan->fade_end_us = 0;
+    portEXIT_CRITICAL(&ledc_lock);
+    return ESP_OK;
+}
+
+static esp_err_t ledc_sim_timer_set_paused(ledc_timer_t timer_sel, bool paused) {
+    ESP_RETURN_ON_FALSE(timer_sel < LEDC_TIMER_MAX, ESP_ERR_INVALID_ARG, TAG, "invalid timer");
+    portENTER_CRITICAL(&ledc_lock);
+    timers[timer_sel].paused = paused;
+    portEXIT_CRITICAL(&ledc_lock);
+    return ESP_OK;
+}
+
+esp_err_t ledc_timer_pause(ledc_mode_t speed_mode, ledc_timer_t timer_sel) {
+    return ledc_sim_timer_set_paused(timer_sel, true);
+}
+
+esp_err_t ledc_timer_resume(ledc_mode_t speed_mode, ledc_timer_t timer_sel) {
+    return ledc_sim_timer_set_paused(timer_sel, false);
+}
+
+esp_err_t ledc_stop(ledc_mode_t speed_mode, ledc_channel_t channel, uint32_t idle_level) {
+    ESP_RETURN_ON_FALSE(channel < LEDC_CHANNEL_MAX, ESP_ERR_INVALID_ARG, TAG, "invalid channel");
+    portENTER_CRITICAL(&ledc_lock);
+    ledc_sim_chan_t *chan = &channels[channel];
+    uint32_t duty = idle_level ? timers[chan->timer].max_duty : 0;
+    chan->duty = duty;
+    chan->start_duty = duty;
+    chan->target_duty = duty;
+    chan->fade_end_us = 0;
+    portEXIT_CRITICAL(&ledc_lock);
+    return ESP_OK;
+}
+
+esp_err_t ledc_sim_get_channel(ledc_channel_t channel, ledc_sim_channel_t *state) {
+    ESP_RETURN_ON_FALSE(channel < LEDC_CHANNEL_MAX && state, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL(&ledc_lock);
+    const ledc_sim_chan_t *chan = &channels[channel];
+    const ledc_sim_timer_t *timer = &timers[chan->timer];
+    *state = (ledc_sim_channel_t) {
+            .gpio_num = chan->gpio_num,
+            .freq_hz = timer->freq_hz,
+            .max_duty = timer->max_duty,
+            .duty = ledc_sim_output_duty(chan, now),
+            .target_duty = chan->target_duty,
+            .paused = timer->paused,
+            .updates = chan->updates,
+    };
+    portEXIT_CRITICAL(&ledc_lock);
+    return ESP_OK;
+}
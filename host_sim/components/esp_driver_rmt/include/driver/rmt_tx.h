@@ -0,0 +1,106 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// RMT TX driver of the host simulation, the subset of ESP-IDF's driver/rmt_tx.h (and the RMT types it pulls in) the
+// AW9364 pulse dimming uses. A transmission is handed to the callback set with rmt_sim_set_tx_callback() right away,
+// the GPIO is left at the end of transmission level and the channel's on_trans_done callback is called.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+
+typedef struct rmt_channel_t *rmt_channel_handle_t;
+typedef struct rmt_encoder_t *rmt_encoder_handle_t;
+
+typedef union {
+    struct {
+        uint16_t duration0: 15;
+        uint16_t level0: 1;
+        uint16_t duration1: 15;
+        uint16_t level1: 1;
+    };
+    uint32_t val;
+} rmt_symbol_word_t;
+
+typedef enum {
+    RMT_CLK_SRC_APB,
+    RMT_CLK_SRC_RC_FAST,
+    RMT_CLK_SRC_XTAL,
+    RMT_CLK_SRC_DEFAULT = RMT_CLK_SRC_APB,
+} rmt_clock_source_t;
+
+typedef struct {
+    gpio_num_t gpio_num;
+    rmt_clock_source_t clk_src;
+    uint32_t resolution_hz;
+    size_t mem_block_symbols;
+    size_t trans_queue_depth;
+    int intr_priority;
+    struct {
+        uint32_t invert_out: 1;
+        uint32_t with_dma: 1;
+        uint32_t io_loop_back: 1;
+        uint32_t io_od_mode: 1;
+        uint32_t allow_pd: 1;
+    } flags;
+} rmt_tx_channel_config_t;
+
+typedef struct {
+} rmt_copy_encoder_config_t;
+
+typedef struct {
+    int loop_count;
+    struct {
+        uint32_t eot_level: 1;
+        uint32_t queue_nonblocking: 1;
+    } flags;
+} rmt_transmit_config_t;
+
+typedef struct {
+    size_t num_symbols;
+} rmt_tx_done_event_data_t;
+
+typedef bool (*rmt_tx_done_callback_t)(rmt_channel_handle_t tx_chan, const rmt_tx_done_event_data_t *edata,
+                                       void *user_ctx);
+
+typedef struct {
+    rmt_tx_done_callback_t on_trans_done;
+} rmt_tx_event_callbacks_t;
+
+// called by rmt_transmit() with the symbols of a transmission
+typedef void (*rmt_sim_tx_cb_t)(gpio_num_t gpio_num, uint32_t resolution_hz, const rmt_symbol_word_t *symbols,
+                                size_t num_symbols, uint32_t eot_level, void *user_ctx);
+
+esp_err_t rmt_new_tx_channel(const rmt_tx_channel_config_t *config, rmt_channel_handle_t *ret_chan);
+
+esp_err_t rmt_new_copy_encoder(const rmt_copy_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder);
+
+esp_err_t rmt_enable(rmt_channel_handle_t channel);
+
+esp_err_t rmt_disable(rmt_channel_handle_t channel);
+
+esp_err_t rmt_transmit(rmt_channel_handle_t tx_channel, rmt_encoder_handle_t encoder, const void *payload,
+                       size_t payload_bytes, const rmt_transmit_config_t *config);
+
+esp_err_t rmt_tx_register_event_callbacks(rmt_channel_handle_t tx_channel, const rmt_tx_event_callbacks_t *cbs,
+                                          void *user_data);
+
+esp_err_t rmt_tx_wait_all_done(rmt_channel_handle_t tx_channel, int timeout_ms);
+
+esp_err_t rmt_del_channel(rmt_channel_handle_t channel);
+
+esp_err_t rmt_del_encoder(rmt_encoder_handle_t encoder);
+
+void rmt_sim_set_tx_callback(rmt_sim_tx_cb_t callback, void *user_ctx);
+
+#ifdef __cplusplus
+}
+#endif
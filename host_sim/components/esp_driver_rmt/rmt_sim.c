@@ -0,0 +1,131 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Simulated RMT TX channels of the host simulation (host_sim/)
+//
+// Only copy encoders are supported. rmt_transmit() hands the symbols to the TX callback in the calling task and calls
+// on_trans_done from there, so a transmission is done when it returns and rmt_tx_wait_all_done() has nothing to wait
+// for. The symbols are not
+// played back in time, the callback gets their durations in ticks of the channel resolution.
+
+#include <stdlib.h>
+#include <esp_log.h>
+#include <esp_check.h>
+#include "freertos/FreeRTOS.h"
+#include "driver/gpio.h"
+#include "driver/rmt_tx.h"
+
+static const char *TAG = "rmt_sim";
+
+struct rmt_channel_t {
+    gpio_num_t gpio_num;
+    uint32_t resolution_hz;
+    bool enabled;
+    rmt_tx_done_callback_t on_trans_done;
+    void *user_data;
+};
+
+struct rmt_encoder_t {
+    uint32_t encodes;
+};
+
+static rmt_sim_tx_cb_t tx_callback;
+static void *tx_callback_ctx;
+static portMUX_TYPE rmt_lock = portMUX_INITIALIZER_UNLOCKED;
+
+esp_err_t rmt_new_tx_channel(const rmt_tx_channel_config_t *config, rmt_channel_handle_t *ret_chan) {
+    ESP_RETURN_ON_FALSE(config && ret_chan && config->gpio_num >= 0 && config->resolution_hz > 0, ESP_ERR_INVALID_ARG,
+                        TAG, "invalid argument");
+    rmt_channel_handle_t chan = calloc(1, sizeof(struct rmt_channel_t));
+    ESP_RETURN_ON_FALSE(chan, ESP_ERR_NO_MEM, TAG, "no memory for rmt channel");
+    chan->gpio_num = config->gpio_num;
+    chan->resolution_hz = config->resolution_hz;
+    // the TX pin idles low
+    gpio_set_level(chan->gpio_num, 0);
+    *ret_chan = chan;
+    return ESP_OK;
+}
+
+esp_err_t rmt_new_copy_encoder(const rmt_copy_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder) {
+    ESP_RETURN_ON_FALSE(config && ret_encoder, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    rmt_encoder_handle_t encoder = calloc(1, sizeof(struct rmt_encoder_t));
+    ESP_RETURN_ON_FALSE(encoder, ESP_ERR_NO_MEM, TAG, "no memory for rmt encoder");
+    *ret_encoder = encoder;
+    return ESP_OK;
+}
+
+esp_err_t rmt_enable(rmt_channel_handle_t channel) {
+    ESP_RETURN_ON_FALSE(channel, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(!channel->enabled, ESP_ERR_INVALID_STATE, TAG, "channel already enabled");
+    channel->enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t rmt_disable(rmt_channel_handle_t channel) {
+    ESP_RETURN_ON_FALSE(channel, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(channel->enabled, ESP_ERR_INVALID_STATE, TAG, "channel not enabled");
+    channel->enabled = false;
+    return ESP_OK;
+}
+
+esp_err_t rmt_transmit(rmt_channel_handle_t tx_channel, rmt_encoder_handle_t encoder, const void *payload,
+                       size_t payload_bytes, const rmt_transmit_config_t *config) {
+    ESP_RETURN_ON_FALSE(tx_channel && encoder && payload && payload_bytes > 0 && config, ESP_ERR_INVALID_ARG, TAG,
+                        "invalid argument");
+    ESP_RETURN_ON_FALSE(payload_bytes % sizeof(rmt_symbol_word_t) == 0, ESP_ERR_INVALID_ARG, TAG,
+                        "copy encoder payload must be whole symbols");
+    ESP_RETURN_ON_FALSE(config->loop_count == 0, ESP_ERR_NOT_SUPPORTED, TAG, "loop transmission not supported");
+    ESP_RETURN_ON_FALSE(tx_channel->enabled, ESP_ERR_INVALID_STATE, TAG, "channel not enabled");
+
+    encoder->encodes++;
+    portENTER_CRITICAL(&rmt_lock);
+    rmt_sim_tx_cb_t callback = tx_callback;
+    void *user_ctx = tx_callback_ctx;
+    portEXIT_CRITICAL(&rmt_lock);
+    if (callback) {
+        callback(tx_channel->gpio_num, tx_channel->resolution_hz, payload, payload_bytes / sizeof(rmt_symbol_word_t),
+                 config->flags.eot_level, user_ctx);
+    }
+    gpio_set_level(tx_channel->gpio_num, config->flags.eot_level);
+    if (tx_channel->on_trans_done) {
+        const rmt_tx_done_event_data_t edata = {
+                .num_symbols = payload_bytes / sizeof(rmt_symbol_word_t),
+        };
+        tx_channel->on_trans_done(tx_channel, &edata, tx_channel->user_data);
+    }
+    return ESP_OK;
+}
+
+esp_err_t rmt_tx_register_event_callbacks(rmt_channel_handle_t tx_channel, const rmt_tx_event_callbacks_t *cbs,
+                                          void *user_data) {
+    ESP_RETURN_ON_FALSE(tx_channel && cbs, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(!tx_channel->enabled, ESP_ERR_INVALID_STATE, TAG, "channel not in init state");
+    tx_channel->on_trans_done = cbs->on_trans_done;
+    tx_channel->user_data = user_data;
+    return ESP_OK;
+}
+
+esp_err_t rmt_tx_wait_all_done(rmt_channel_handle_t tx_channel, int timeout_ms) {
+    ESP_RETURN_ON_FALSE(tx_channel, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    return ESP_OK;
+}
+
+esp_err_t rmt_del_channel(rmt_channel_handle_t channel) {
+    ESP_RETURN_ON_FALSE(channel, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(!channel->enabled, ESP_ERR_INVALID_STATE, TAG, "channel not disabled");
+    free(channel);
+    return ESP_OK;
+}
+
+esp_err_t rmt_del_encoder(rmt_encoder_handle_t encoder) {
+    ESP_RETURN_ON_FALSE(encoder, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    free(encoder);
+    return ESP_OK;
+}
+
+void rmt_sim_set_tx_callback(rmt_sim_tx_cb_t callback, void *user_ctx) {
+    portENTER_CRITICAL(&rmt_lock);
+    tx_callback = callback;
+    tx_callback_ctx = user_ctx;
+    portEXIT_CRITICAL(&rmt_lock);
+}
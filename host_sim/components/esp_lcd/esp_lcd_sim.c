@@ -0,0 +1,375 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Simulated i80 bus, panel IO and ST7789 panel
+//
+// Replaces ESP-IDF's esp_lcd on the linux target (host_sim/). The panel IO doesn't queue: a transaction is timed on
+// the simulated bus (esp_lcd_sim.h), applied to the simulated frame memory and recorded when it is called, the
+// calling task spends its bus time on the simulated esp_timer clock, then on_color_trans_done is called from the
+// calling task the way the i80 driver calls it from its DMA interrupt. The
+// ST7789 panel sends the command sequences of ESP-IDF's driver through the panel IO, so a draw_bitmap is recorded
+// like any other transfer: CASET / RASET parameters, then RAMWR with the pixels.
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <esp_log.h>
+#include <esp_check.h>
+#include <esp_timer.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_lcd_panel_io.h"
+#include "esp_lcd_panel_ops.h"
+#include "esp_lcd_panel_st7789.h"
+#include "esp_lcd_panel_commands.h"
+#include "esp_lcd_sim.h"
+
+static const char *TAG = "esp_lcd_sim";
+
+struct esp_lcd_i80_bus_t {
+    size_t bus_width;
+    size_t max_transfer_bytes;
+};
+
+struct esp_lcd_panel_io_t {
+    esp_lcd_i80_bus_handle_t bus;
+    uint32_t pclk_hz;
+    int cmd_bits;
+    int param_bits;
+    bool swap_color_bytes;
+    esp_lcd_panel_io_color_trans_done_cb_t on_color_trans_done;
+    void *user_ctx;
+};
+
+struct esp_lcd_panel_t {
+    esp_lcd_panel_io_handle_t io;
+    int x_gap;
+    int y_gap;
+    uint8_t madctl;
+    uint32_t bits_per_pixel;
+};
+
+typedef struct {
+    SemaphoreHandle_t lock;     // guards everything below, taken by the transactions and the getters
+    uint64_t bus_ns;
+    esp_lcd_sim_stats_t stats;
+    esp_lcd_sim_transfer_t log[ESP_LCD_SIM_LOG_SIZE];
+    // frame memory write window (CASET / RASET) and position, a pixel can be split over two color transfers
+    uint16_t x1;
+    uint16_t y1;
+    uint16_t x2;
+    uint16_t y2;
+    uint16_t x;
+    uint16_t y;
+    bool half;
+    uint8_t half_byte;
+    uint16_t gram[ESP_LCD_SIM_GRAM_SIZE * ESP_LCD_SIM_GRAM_SIZE];
+} esp_lcd_sim_ctx_t;
+
+static esp_lcd_sim_ctx_t sim_ctx;
+
+// simulated bus time of one transaction: command, bytes of parameters / color, driver and DMA setup
+static uint32_t esp_lcd_sim_trans_ns(esp_lcd_panel_io_handle_t io, int lcd_cmd, size_t bytes) {
+    size_t width = io->bus->bus_width;
+    uint64_t cycles = (bytes * 8 + width - 1) / width;
+    if (lcd_cmd >= 0) {
+        cycles += (io->cmd_bits + width - 1) / width;
+    }
+    return ESP_LCD_SIM_TRANS_SETUP_NS + (uint32_t) (cycles * 1000000000ULL / io->pclk_hz);
+}
+
+static void esp_lcd_sim_write_px(uint16_t px) {
+    if (sim_ctx.x < ESP_LCD_SIM_GRAM_SIZE && sim_ctx.y < ESP_LCD_SIM_GRAM_SIZE) {
+        sim_ctx.gram[sim_ctx.y * ESP_LCD_SIM_GRAM_SIZE + sim_ctx.x] = px;
+    }
+    // the ST7789 wraps to the start of the window
+    if (++sim_ctx.x > sim_ctx.x2) {
+        sim_ctx.x = sim_ctx.x1;
+        if (++sim_ctx.y > sim_ctx.y2) {
+            sim_ctx.y = sim_ctx.y1;
+        }
+    }
+}
+
+static void esp_lcd_sim_write_color(esp_lcd_panel_io_handle_t io, const uint8_t *color, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        // with swap_color_bytes the i80 peripheral sends the two bytes of every pixel in reverse
+        uint8_t byte = io->swap_color_bytes ? color[i ^ 1] : color[i];
+        if (!sim_ctx.half) {
+            sim_ctx.half_byte = byte;
+            sim_ctx.half = true;
+        } else {
+            esp_lcd_sim_write_px((uint16_t) (sim_ctx.half_byte << 8 | byte));
+            sim_ctx.half = false;
+        }
+    }
+}
+
+esp_err_t esp_lcd_new_i80_bus(const esp_lcd_i80_bus_config_t *bus_config, esp_lcd_i80_bus_handle_t *ret_bus) {
+    ESP_RETURN_ON_FALSE(bus_config && ret_bus, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(bus_config->bus_width == 8 || bus_config->bus_width == 16, ESP_ERR_INVALID_ARG, TAG,
+                        "invalid bus width %d", (int) bus_config->bus_width);
+    if (sim_ctx.lock == NULL) {
+        sim_ctx.lock = xSemaphoreCreateMutex();
+        ESP_RETURN_ON_FALSE(sim_ctx.lock, ESP_ERR_NO_MEM, TAG, "no memory for the lock");
+    }
+
+    esp_lcd_i80_bus_handle_t bus = calloc(1, sizeof(struct esp_lcd_i80_bus_t));
+    ESP_RETURN_ON_FALSE(bus, ESP_ERR_NO_MEM, TAG, "no memory for the i80 bus");
+    bus->bus_width = bus_config->bus_width;
+    bus->max_transfer_bytes = bus_config->max_transfer_bytes;
+    *ret_bus = bus;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_del_i80_bus(esp_lcd_i80_bus_handle_t bus) {
+    free(bus);
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_new_panel_io_i80(esp_lcd_i80_bus_handle_t bus, const esp_lcd_panel_io_i80_config_t *io_config,
+                                   esp_lcd_panel_io_handle_t *ret_io) {
+    ESP_RETURN_ON_FALSE(bus && io_config && ret_io && io_config->pclk_hz > 0, ESP_ERR_INVALID_ARG, TAG,
+                        "invalid argument");
+
+    esp_lcd_panel_io_handle_t io = calloc(1, sizeof(struct esp_lcd_panel_io_t));
+    ESP_RETURN_ON_FALSE(io, ESP_ERR_NO_MEM, TAG, "no memory for the panel IO");
+    io->bus = bus;
+    io->pclk_hz = io_config->pclk_hz;
+    io->cmd_bits = io_config->lcd_cmd_bits;
+    io->param_bits = io_config->lcd_param_bits;
+    io->swap_color_bytes = io_config->flags.swap_color_bytes;
+    io->on_color_trans_done = io_config->on_color_trans_done;
+    io->user_ctx = io_config->user_ctx;
+    ESP_LOGI(TAG, "i80 panel IO: %d bit bus, PCLK %" PRIu32 " Hz, %d ns setup per transaction",
+             (int) bus->bus_width, io->pclk_hz, ESP_LCD_SIM_TRANS_SETUP_NS);
+    *ret_io = io;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_io_rx_param(esp_lcd_panel_io_handle_t io, int lcd_cmd, void *param, size_t param_size) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_lcd_panel_io_tx_param(esp_lcd_panel_io_handle_t io, int lcd_cmd, const void *param, size_t param_size) {
+    ESP_RETURN_ON_FALSE(io, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    const uint8_t *p = param;
+
+    xSemaphoreTake(sim_ctx.lock, portMAX_DELAY);
+    if (param_size == 4 && (lcd_cmd == LCD_CMD_CASET || lcd_cmd == LCD_CMD_RASET)) {
+        uint16_t start = p[0] << 8 | p[1];
+        uint16_t end = p[2] << 8 | p[3];
+        if (lcd_cmd == LCD_CMD_CASET) {
+            sim_ctx.x1 = start;
+            sim_ctx.x2 = end;
+        } else {
+            sim_ctx.y1 = start;
+            sim_ctx.y2 = end;
+        }
+    }
+    uint32_t ns = esp_lcd_sim_trans_ns(io, lcd_cmd, param_size);
+    esp_timer_sim_spend_ns(ns);
+    sim_ctx.bus_ns += ns;
+    sim_ctx.stats.bus_ns += ns;
+    sim_ctx.stats.param_transfers++;
+    xSemaphoreGive(sim_ctx.lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_io_tx_color(esp_lcd_panel_io_handle_t io, int lcd_cmd, const void *color, size_t color_size) {
+    ESP_RETURN_ON_FALSE(io && color, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    xSemaphoreTake(sim_ctx.lock, portMAX_DELAY);
+    if (lcd_cmd == LCD_CMD_RAMWR) {
+        sim_ctx.x = sim_ctx.x1;
+        sim_ctx.y = sim_ctx.y1;
+        sim_ctx.half = false;
+    }
+    esp_lcd_sim_write_color(io, color, color_size);
+
+    uint32_t ns = esp_lcd_sim_trans_ns(io, lcd_cmd, color_size);
+    esp_lcd_sim_transfer_t *transfer = &sim_ctx.log[sim_ctx.stats.color_transfers % ESP_LCD_SIM_LOG_SIZE];
+    *transfer = (esp_lcd_sim_transfer_t) {
+            .index = sim_ctx.stats.color_transfers,
+            .cmd = (uint8_t) lcd_cmd,
+            .x1 = sim_ctx.x1,
+            .y1 = sim_ctx.y1,
+            .x2 = sim_ctx.x2,
+            .y2 = sim_ctx.y2,
+            .bytes = color_size,
+            .start_ns = esp_timer_sim_get_time_ns(),
+            .bus_ns = ns,
+    };
+    esp_timer_sim_spend_ns(ns);
+    sim_ctx.bus_ns += ns;
+    sim_ctx.stats.bus_ns += ns;
+    sim_ctx.stats.color_transfers++;
+    sim_ctx.stats.color_bytes += color_size;
+    xSemaphoreGive(sim_ctx.lock);
+
+    if (io->on_color_trans_done) {
+        esp_lcd_panel_io_event_data_t edata = {};
+        io->on_color_trans_done(io, &edata, io->user_ctx);
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_io_del(esp_lcd_panel_io_handle_t io) {
+    free(io);
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_io_register_event_callbacks(esp_lcd_panel_io_handle_t io,
+                                                    const esp_lcd_panel_io_callbacks_t *cbs, void *user_ctx) {
+    ESP_RETURN_ON_FALSE(io && cbs, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    io->on_color_trans_done = cbs->on_color_trans_done;
+    io->user_ctx = user_ctx;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_new_panel_st7789(const esp_lcd_panel_io_handle_t io, const esp_lcd_panel_dev_config_t *panel_dev_config,
+                                   esp_lcd_panel_handle_t *ret_panel) {
+    ESP_RETURN_ON_FALSE(io && panel_dev_config && ret_panel, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(panel_dev_config->bits_per_pixel == 16, ESP_ERR_NOT_SUPPORTED, TAG,
+                        "only RGB565 is simulated");
+
+    esp_lcd_panel_handle_t panel = calloc(1, sizeof(struct esp_lcd_panel_t));
+    ESP_RETURN_ON_FALSE(panel, ESP_ERR_NO_MEM, TAG, "no memory for the panel");
+    panel->io = io;
+    panel->bits_per_pixel = panel_dev_config->bits_per_pixel;
+    panel->madctl = panel_dev_config->rgb_ele_order == LCD_RGB_ELEMENT_ORDER_BGR ? LCD_CMD_BGR_BIT : 0;
+    *ret_panel = panel;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_reset(esp_lcd_panel_handle_t panel) {
+    return esp_lcd_panel_io_tx_param(panel->io, LCD_CMD_SWRESET, NULL, 0);
+}
+
+esp_err_t esp_lcd_panel_init(esp_lcd_panel_handle_t panel) {
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(panel->io, LCD_CMD_SLPOUT, NULL, 0), TAG, "SLPOUT failed");
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(panel->io, LCD_CMD_MADCTL, &panel->madctl, 1), TAG,
+                        "MADCTL failed");
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_io_tx_param(panel->io, LCD_CMD_COLMOD, (uint8_t[]) {0x55}, 1), TAG,
+                        "COLMOD failed");
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_del(esp_lcd_panel_handle_t panel) {
+    free(panel);
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_draw_bitmap(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end,
+                                    const void *color_data) {
+    ESP_RETURN_ON_FALSE(panel && x_start < x_end && y_start < y_end, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    x_start += panel->x_gap;
+    x_end += panel->x_gap;
+    y_start += panel->y_gap;
+    y_end += panel->y_gap;
+
+    xSemaphoreTake(sim_ctx.lock, portMAX_DELAY);
+    sim_ctx.stats.draw_bitmaps++;
+    xSemaphoreGive(sim_ctx.lock);
+
+    esp_lcd_panel_io_tx_param(panel->io, LCD_CMD_CASET, (uint8_t[]) {
+            (x_start >> 8) & 0xFF, x_start & 0xFF, ((x_end - 1) >> 8) & 0xFF, (x_end - 1) & 0xFF,
+    }, 4);
+    esp_lcd_panel_io_tx_param(panel->io, LCD_CMD_RASET, (uint8_t[]) {
+            (y_start >> 8) & 0xFF, y_start & 0xFF, ((y_end - 1) >> 8) & 0xFF, (y_end - 1) & 0xFF,
+    }, 4);
+    size_t len = (x_end - x_start) * (y_end - y_start) * panel->bits_per_pixel / 8;
+    return esp_lcd_panel_io_tx_color(panel->io, LCD_CMD_RAMWR, color_data, len);
+}
+
+static esp_err_t esp_lcd_sim_send_madctl(esp_lcd_panel_handle_t panel, uint8_t set, uint8_t clear) {
+    panel->madctl = (panel->madctl & ~clear) | set;
+    return esp_lcd_panel_io_tx_param(panel->io, LCD_CMD_MADCTL, &panel->madctl, 1);
+}
+
+esp_err_t esp_lcd_panel_mirror(esp_lcd_panel_handle_t panel, bool mirror_x, bool mirror_y) {
+    uint8_t set = (mirror_x ? LCD_CMD_MX_BIT : 0) | (mirror_y ? LCD_CMD_MY_BIT : 0);
+    return esp_lcd_sim_send_madctl(panel, set, LCD_CMD_MX_BIT | LCD_CMD_MY_BIT);
+}
+
+esp_err_t esp_lcd_panel_swap_xy(esp_lcd_panel_handle_t panel, bool swap_axes) {
+    return esp_lcd_sim_send_madctl(panel, swap_axes ? LCD_CMD_MV_BIT : 0, LCD_CMD_MV_BIT);
+}
+
+esp_err_t esp_lcd_panel_set_gap(esp_lcd_panel_handle_t panel, int x_gap, int y_gap) {
+    panel->x_gap = x_gap;
+    panel->y_gap = y_gap;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_invert_color(esp_lcd_panel_handle_t panel, bool invert_color_data) {
+    return esp_lcd_panel_io_tx_param(panel->io, invert_color_data ? LCD_CMD_INVON : LCD_CMD_INVOFF, NULL, 0);
+}
+
+esp_err_t esp_lcd_panel_disp_on_off(esp_lcd_panel_handle_t panel, bool on_off) {
+    return esp_lcd_panel_io_tx_param(panel->io, on_off ? LCD_CMD_DISPON : LCD_CMD_DISPOFF, NULL, 0);
+}
+
+esp_err_t esp_lcd_panel_disp_sleep(esp_lcd_panel_handle_t panel, bool sleep) {
+    return esp_lcd_panel_io_tx_param(panel->io, sleep ? LCD_CMD_SLPIN : LCD_CMD_SLPOUT, NULL, 0);
+}
+
+uint64_t esp_lcd_sim_get_bus_time_ns(void) {
+    xSemaphoreTake(sim_ctx.lock, portMAX_DELAY);
+    uint64_t bus_ns = sim_ctx.bus_ns;
+    xSemaphoreGive(sim_ctx.lock);
+    return bus_ns;
+}
+
+void esp_lcd_sim_get_stats(esp_lcd_sim_stats_t *stats) {
+    assert(stats);
+    xSemaphoreTake(sim_ctx.lock, portMAX_DELAY);
+    *stats = sim_ctx.stats;
+    xSemaphoreGive(sim_ctx.lock);
+}
+
+bool esp_lcd_sim_get_transfer(uint32_t index, esp_lcd_sim_transfer_t *transfer) {
+    assert(transfer);
+    xSemaphoreTake(sim_ctx.lock, portMAX_DELAY);
+    uint32_t count = sim_ctx.stats.color_transfers;
+    bool recorded = index < count && count - index <= ESP_LCD_SIM_LOG_SIZE;
+    if (recorded) {
+        *transfer = sim_ctx.log[index % ESP_LCD_SIM_LOG_SIZE];
+    }
+    xSemaphoreGive(sim_ctx.lock);
+    return recorded;
+}
+
+void esp_lcd_sim_write_csv(FILE *f) {
+    esp_lcd_sim_stats_t stats;
+    esp_lcd_sim_get_stats(&stats);
+    uint32_t first = stats.color_transfers > ESP_LCD_SIM_LOG_SIZE ? stats.color_transfers - ESP_LCD_SIM_LOG_SIZE : 0;
+
+    fprintf(f, "index,cmd,x1,y1,x2,y2,bytes,start_ns,bus_ns\n");
+    esp_lcd_sim_transfer_t t;
+    for (uint32_t i = first; i < stats.color_transfers && esp_lcd_sim_get_transfer(i, &t); i++) {
+        fprintf(f, "%" PRIu32 ",%s,%u,%u,%u,%u,%" PRIu32 ",%" PRIu64 ",%" PRIu32 "\n", t.index,
+                t.cmd == LCD_CMD_RAMWR ? "RAMWR" : "WRMEMC", t.x1, t.y1, t.x2, t.y2, t.bytes, t.start_ns, t.bus_ns);
+    }
+}
+
+uint32_t esp_lcd_sim_hash_gram(int x, int y, int w, int h) {
+    uint32_t hash = 0x811C9DC5;
+    xSemaphoreTake(sim_ctx.lock, portMAX_DELAY);
+    for (int row = y; row < y + h && row < ESP_LCD_SIM_GRAM_SIZE; row++) {
+        for (int col = x; col < x + w && col < ESP_LCD_SIM_GRAM_SIZE; col++) {
+            hash = (hash ^ sim_ctx.gram[row * ESP_LCD_SIM_GRAM_SIZE + col]) * 0x01000193;
+        }
+    }
+    xSemaphoreGive(sim_ctx.lock);
+    return hash;
+}
+
+uint16_t esp_lcd_sim_get_gram_px(int x, int y) {
+    assert(x >= 0 && x < ESP_LCD_SIM_GRAM_SIZE && y >= 0 && y < ESP_LCD_SIM_GRAM_SIZE);
+    xSemaphoreTake(sim_ctx.lock, portMAX_DELAY);
+    uint16_t px = sim_ctx.gram[y * ESP_LCD_SIM_GRAM_SIZE + x];
+    xSemaphoreGive(sim_ctx.lock);
+    return px;
+}
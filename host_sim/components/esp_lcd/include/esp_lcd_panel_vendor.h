@@ -0,0 +1,27 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// esp_lcd panel device config of the host simulation, same as ESP-IDF's esp_lcd_panel_dev.h
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "esp_lcd_types.h"
+
+typedef struct {
+    int reset_gpio_num;
+    lcd_rgb_element_order_t rgb_ele_order;
+    lcd_rgb_data_endian_t data_endian;
+    uint32_t bits_per_pixel;
+    struct {
+        uint32_t reset_active_high: 1;
+    } flags;
+    void *vendor_config;
+} esp_lcd_panel_dev_config_t;
+
+#ifdef __cplusplus
+}
+#endif
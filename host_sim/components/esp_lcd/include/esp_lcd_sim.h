@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Recorder of the simulated i80 panel IO
+//
+// Every transaction on the simulated bus is timed from the PCLK and bus width of the panel IO: the command and each
+// parameter / color byte take (bits / bus_width) PCLK cycles, plus ESP_LCD_SIM_TRANS_SETUP_NS of driver and DMA
+// setup per transaction. The simulated bus time only advances with the transactions, it doesn't depend on the host.
+// The task sending a transaction is blocked for its bus time on the simulated esp_timer clock (esp_timer.h), so the
+// transfers and the esp_timer times of the flush pipeline are on one timeline.
+// Every color transfer (RAMWR / WRMEMC, e.g. one draw_bitmap) is written into the simulated ST7789 frame memory and
+// recorded with its CASET / RASET window, size and bus time.
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include "esp_lcd_types.h"
+
+// driver and DMA setup of one i80 transaction
+#ifndef ESP_LCD_SIM_TRANS_SETUP_NS
+#define ESP_LCD_SIM_TRANS_SETUP_NS 2000
+#endif
+// color transfers kept by the recorder, older ones are dropped (still counted in the stats)
+#define ESP_LCD_SIM_LOG_SIZE       4096
+// ST7789 frame memory, columns x rows as addressed by CASET / RASET in either orientation
+#define ESP_LCD_SIM_GRAM_SIZE      320
+
+typedef struct {
+    uint32_t index;             // color transfers since start
+    uint8_t cmd;                // LCD_CMD_RAMWR or LCD_CMD_WRMEMC
+    uint16_t x1;                // CASET / RASET window (inclusive)
+    uint16_t y1;
+    uint16_t x2;
+    uint16_t y2;
+    uint32_t bytes;
+    uint64_t start_ns;          // esp_timer_sim_get_time_ns() the transfer started at
+    uint32_t bus_ns;            // simulated bus time of the transfer
+} esp_lcd_sim_transfer_t;
+
+typedef struct {
+    uint32_t draw_bitmaps;
+    uint32_t color_transfers;
+    uint32_t param_transfers;
+    uint64_t color_bytes;
+    uint64_t bus_ns;            // simulated bus time of all transactions
+} esp_lcd_sim_stats_t;
+
+// simulated bus time of all transactions so far
+uint64_t esp_lcd_sim_get_bus_time_ns(void);
+
+void esp_lcd_sim_get_stats(esp_lcd_sim_stats_t *stats);
+
+// copy color transfer index, false when it was not recorded yet or already dropped
+bool esp_lcd_sim_get_transfer(uint32_t index, esp_lcd_sim_transfer_t *transfer);
+
+// write the recorded color transfers as CSV
+void esp_lcd_sim_write_csv(FILE *f);
+
+// FNV-1a hash of the visible frame memory window (x, y, w, h in frame memory coordinates)
+uint32_t esp_lcd_sim_hash_gram(int x, int y, int w, int h);
+
+// frame memory pixel (frame memory coordinates) as the ST7789 received it, the first byte on the bus in the high byte
+uint16_t esp_lcd_sim_get_gram_px(int x, int y);
+
+#ifdef __cplusplus
+}
+#endif
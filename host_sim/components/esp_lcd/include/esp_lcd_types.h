@@ -0,0 +1,37 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// esp_lcd types of the host simulation, the subset of ESP-IDF's esp_lcd_types.h the project uses
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+typedef struct esp_lcd_panel_io_t *esp_lcd_panel_io_handle_t;
+typedef struct esp_lcd_panel_t *esp_lcd_panel_handle_t;
+typedef struct esp_lcd_i80_bus_t *esp_lcd_i80_bus_handle_t;
+
+typedef enum {
+    LCD_RGB_ELEMENT_ORDER_RGB,
+    LCD_RGB_ELEMENT_ORDER_BGR,
+} lcd_rgb_element_order_t;
+
+typedef enum {
+    LCD_RGB_DATA_ENDIAN_BIG,
+    LCD_RGB_DATA_ENDIAN_LITTLE,
+} lcd_rgb_data_endian_t;
+
+typedef enum {
+    LCD_CLK_SRC_DEFAULT,
+} lcd_clock_source_t;
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,252 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Simulated esp_timer of the host simulation (host_sim/)
+//
+// Replaces ESP-IDF's esp_timer on the linux target, whose time and timer task follow the host's clock. Here the
+// clock is a counter: nothing is dispatched on its own, esp_timer_sim_advance() steps the clock from alarm to alarm
+// and calls each callback from the calling task, so a run of host_sim is the same on every host. Timers with the same
+// alarm fire in the order they were created.
+
+#include <stdlib.h>
+#include <time.h>
+#include <inttypes.h>
+#include <esp_log.h>
+#include <esp_check.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+
+static const char *TAG = "esp_timer_sim";
+
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void *arg;
+    const char *name;
+    bool skip_unhandled_events;
+    bool armed;
+    int64_t alarm_ns;
+    int64_t period_ns;          // 0: one shot
+    struct esp_timer *next;     // in creation order
+};
+
+static struct esp_timer *timers;
+static int64_t now_ns;
+static portMUX_TYPE timer_lock = portMUX_INITIALIZER_UNLOCKED;
+
+esp_err_t esp_timer_early_init(void) {
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_init(void) {
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_deinit(void) {
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle) {
+    ESP_RETURN_ON_FALSE(create_args && create_args->callback && out_handle, ESP_ERR_INVALID_ARG, TAG,
+                        "invalid argument");
+    esp_timer_handle_t timer = calloc(1, sizeof(struct esp_timer));
+    ESP_RETURN_ON_FALSE(timer, ESP_ERR_NO_MEM, TAG, "no memory for the timer");
+    timer->callback = create_args->callback;
+    timer->arg = create_args->arg;
+    timer->name = create_args->name;
+    timer->skip_unhandled_events = create_args->skip_unhandled_events;
+
+    portENTER_CRITICAL(&timer_lock);
+    esp_timer_handle_t *last = &timers;
+    while (*last != NULL) {
+        last = &(*last)->next;
+    }
+    *last = timer;
+    portEXIT_CRITICAL(&timer_lock);
+    *out_handle = timer;
+    return ESP_OK;
+}
+
+static esp_err_t esp_timer_sim_arm(esp_timer_handle_t timer, uint64_t timeout_us, uint64_t period_us, bool restart) {
+    ESP_RETURN_ON_FALSE(timer, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    esp_err_t ret = ESP_OK;
+    portENTER_CRITICAL(&timer_lock);
+    if (timer->armed != restart) {
+        ret = ESP_ERR_INVALID_STATE;
+    } else {
+        timer->armed = true;
+        timer->alarm_ns = now_ns + (int64_t) timeout_us * 1000;
+        timer->period_ns = (int64_t) period_us * 1000;
+    }
+    portEXIT_CRITICAL(&timer_lock);
+    return ret;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    return esp_timer_sim_arm(timer, timeout_us, 0, false);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period) {
+    ESP_RETURN_ON_FALSE(period > 0, ESP_ERR_INVALID_ARG, TAG, "invalid period");
+    return esp_timer_sim_arm(timer, period, period, false);
+}
+
+esp_err_t esp_timer_restart(esp_timer_handle_t timer, uint64_t timeout_us) {
+    ESP_RETURN_ON_FALSE(timer, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    portENTER_CRITICAL(&timer_lock);
+    bool periodic = timer->period_ns > 0;
+    portEXIT_CRITICAL(&timer_lock);
+    // a periodic timer keeps running with timeout_us as its new period
+    return esp_timer_sim_arm(timer, timeout_us, periodic ? timeout_us : 0, true);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    ESP_RETURN_ON_FALSE(timer, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    esp_err_t ret = ESP_OK;
+    portENTER_CRITICAL(&timer_lock);
+    if (!timer->armed) {
+        ret = ESP_ERR_INVALID_STATE;
+    }
+    timer->armed = false;
+    portEXIT_CRITICAL(&timer_lock);
+    return ret;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    ESP_RETURN_ON_FALSE(timer, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    portENTER_CRITICAL(&timer_lock);
+    if (timer->armed) {
+        portEXIT_CRITICAL(&timer_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    for (esp_timer_handle_t *t = &timers; *t != NULL; t = &(*t)->next) {
+        if (*t == timer) {
+            *t = timer->next;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&timer_lock);
+    free(timer);
+    return ESP_OK;
+}
+
+int64_t esp_timer_get_time(void) {
+    return esp_timer_sim_get_time_ns() / 1000;
+}
+
+int64_t esp_timer_get_next_alarm(void) {
+    int64_t next_ns = INT64_MAX;
+    portENTER_CRITICAL(&timer_lock);
+    for (esp_timer_handle_t t = timers; t != NULL; t = t->next) {
+        if (t->armed && t->alarm_ns < next_ns) {
+            next_ns = t->alarm_ns;
+        }
+    }
+    portEXIT_CRITICAL(&timer_lock);
+    return next_ns == INT64_MAX ? INT64_MAX : next_ns / 1000;
+}
+
+int64_t esp_timer_get_next_alarm_for_wake_up(void) {
+    return esp_timer_get_next_alarm();
+}
+
+esp_err_t esp_timer_get_period(esp_timer_handle_t timer, uint64_t *period) {
+    ESP_RETURN_ON_FALSE(timer && period, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    portENTER_CRITICAL(&timer_lock);
+    *period = timer->period_ns / 1000;
+    portEXIT_CRITICAL(&timer_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_get_expiry_time(esp_timer_handle_t timer, uint64_t *expiry) {
+    ESP_RETURN_ON_FALSE(timer && expiry, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    esp_err_t ret = ESP_OK;
+    portENTER_CRITICAL(&timer_lock);
+    if (timer->period_ns > 0) {
+        ret = ESP_ERR_NOT_SUPPORTED;
+    } else if (!timer->armed) {
+        ret = ESP_ERR_INVALID_STATE;
+    } else {
+        *expiry = timer->alarm_ns / 1000;
+    }
+    portEXIT_CRITICAL(&timer_lock);
+    return ret;
+}
+
+esp_err_t esp_timer_dump(FILE *stream) {
+    ESP_RETURN_ON_FALSE(stream, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    fprintf(stream, "Timer stats:\nName                  Period      Alarm\n");
+    portENTER_CRITICAL(&timer_lock);
+    for (esp_timer_handle_t t = timers; t != NULL; t = t->next) {
+        fprintf(stream, "%-20s  %-10" PRId64 "  %-10" PRId64 "\n", t->name ? t->name : "NULL", t->period_ns / 1000,
+                t->armed ? t->alarm_ns / 1000 : 0);
+    }
+    portEXIT_CRITICAL(&timer_lock);
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer) {
+    if (timer == NULL) {
+        return false;
+    }
+    portENTER_CRITICAL(&timer_lock);
+    bool armed = timer->armed;
+    portEXIT_CRITICAL(&timer_lock);
+    return armed;
+}
+
+void esp_timer_sim_advance(uint64_t us) {
+    portENTER_CRITICAL(&timer_lock);
+    int64_t target_ns = now_ns + (int64_t) us * 1000;
+    while (1) {
+        esp_timer_handle_t due = NULL;
+        for (esp_timer_handle_t t = timers; t != NULL; t = t->next) {
+            if (t->armed && t->alarm_ns <= target_ns && (due == NULL || t->alarm_ns < due->alarm_ns)) {
+                due = t;
+            }
+        }
+        if (due == NULL) {
+            break;
+        }
+        // an alarm that passed while a task spent time on the bus fires late, at the current time
+        if (due->alarm_ns > now_ns) {
+            now_ns = due->alarm_ns;
+        }
+        if (due->period_ns > 0) {
+            due->alarm_ns += due->period_ns;
+            if (due->skip_unhandled_events && due->alarm_ns <= now_ns) {
+                due->alarm_ns = now_ns + due->period_ns;
+            }
+        } else {
+            due->armed = false;
+        }
+        esp_timer_cb_t callback = due->callback;
+        void *arg = due->arg;
+        portEXIT_CRITICAL(&timer_lock);
+        // may start, stop or delete any timer, this one included
+        callback(arg);
+        portENTER_CRITICAL(&timer_lock);
+    }
+    if (now_ns < target_ns) {
+        now_ns = target_ns;
+    }
+    portEXIT_CRITICAL(&timer_lock);
+}
+
+void esp_timer_sim_spend_ns(uint64_t ns) {
+    portENTER_CRITICAL(&timer_lock);
+    now_ns += (int64_t) ns;
+    portEXIT_CRITICAL(&timer_lock);
+}
+
+int64_t esp_timer_sim_get_time_ns(void) {
+    portENTER_CRITICAL(&timer_lock);
+    int64_t ns = now_ns;
+    portEXIT_CRITICAL(&timer_lock);
+    return ns;
+}
+
+int64_t esp_timer_sim_get_host_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
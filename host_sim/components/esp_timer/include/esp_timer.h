@@ -0,0 +1,87 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// esp_timer of the host simulation, ESP-IDF's esp_timer.h API on a simulated clock. The time starts at 0 and doesn't
+// follow the host: it only moves with esp_timer_sim_advance(), which runs the callbacks that fall due on the way in
+// the calling task, and esp_timer_sim_spend_ns(), time a task spent blocked on the simulated hardware (the i80 bus).
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+typedef struct esp_timer *esp_timer_handle_t;
+
+typedef void (*esp_timer_cb_t)(void *arg);
+
+// both run from esp_timer_sim_advance()
+typedef enum {
+    ESP_TIMER_TASK,
+    ESP_TIMER_ISR,
+    ESP_TIMER_MAX,
+} esp_timer_dispatch_t;
+
+typedef struct {
+    esp_timer_cb_t callback;
+    void *arg;
+    esp_timer_dispatch_t dispatch_method;
+    const char *name;
+    bool skip_unhandled_events;     // a periodic timer that fell behind fires once, not once per missed period
+} esp_timer_create_args_t;
+
+esp_err_t esp_timer_early_init(void);
+
+esp_err_t esp_timer_init(void);
+
+esp_err_t esp_timer_deinit(void);
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle);
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us);
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period);
+
+esp_err_t esp_timer_restart(esp_timer_handle_t timer, uint64_t timeout_us);
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer);
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer);
+
+int64_t esp_timer_get_time(void);
+
+// INT64_MAX when no timer is armed
+int64_t esp_timer_get_next_alarm(void);
+
+int64_t esp_timer_get_next_alarm_for_wake_up(void);
+
+esp_err_t esp_timer_get_period(esp_timer_handle_t timer, uint64_t *period);
+
+esp_err_t esp_timer_get_expiry_time(esp_timer_handle_t timer, uint64_t *expiry);
+
+esp_err_t esp_timer_dump(FILE *stream);
+
+bool esp_timer_is_active(esp_timer_handle_t timer);
+
+// move the clock by us, running the callbacks due on the way (in alarm order, the clock at each alarm) in the calling
+// task. Called by one task only, the one driving the simulation
+void esp_timer_sim_advance(uint64_t us);
+
+// the calling task was blocked for ns, e.g. on a bus transfer: the clock moves without running callbacks, the ones
+// that fell due run late on the next esp_timer_sim_advance()
+void esp_timer_sim_spend_ns(uint64_t ns);
+
+// simulated time in ns, esp_timer_get_time() truncates it
+int64_t esp_timer_sim_get_time_ns(void);
+
+// the host's monotonic clock in us, for timing host code
+int64_t esp_timer_sim_get_host_time(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,229 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Emulated AW9364 backlight driver
+//
+// The AW9364 drives the backlight LEDs with one of 16 current steps (up to HOST_SIM_AW9364_MAX_CURRENT_UA).
+//  - the aw9364 component drives its EN pin with an LEDC PWM, the emulation takes the step the duty averages to. A
+//    periodic esp_timer polls the simulated LEDC channel (fades included) and logs every step change.
+//  - with LCD_BK_LIGHT_RMT, EN is pulsed from the RMT (t_display_s3_aw9364.c) and the emulation decodes every
+//    transmission the way the AW9364 counts pulses: EN low for more than 2.5 ms is off, a rising edge from off is step
+//    16, a rising edge after a 0.5 - 500 us low is one step down (1 wraps around to 16). The time EN stays low between
+//    two transmissions is taken from esp_timer.
+
+#include <inttypes.h>
+#include <esp_log.h>
+#include <esp_check.h>
+#include <esp_timer.h>
+#include "freertos/FreeRTOS.h"
+#include "driver/ledc.h"
+#include "driver/rmt_tx.h"
+#include "aw9364.h"
+#include "t_display_s3.h"
+#include "host_sim_clock.h"
+#include "host_sim_aw9364.h"
+
+static const char *TAG = "host_sim_aw9364";
+
+#define HOST_SIM_AW9364_MAX_CURRENT_UA 20000
+
+static host_sim_aw9364_state_t aw9364_state;
+static portMUX_TYPE aw9364_lock = portMUX_INITIALIZER_UNLOCKED;
+
+#if LCD_BK_LIGHT_RMT
+
+#define HOST_SIM_AW9364_MIN_PULSE_NS 500
+#define HOST_SIM_AW9364_MAX_PULSE_NS (500 * 1000)
+#define HOST_SIM_AW9364_OFF_NS       (2500 * 1000)
+// fade time of the fades host_sim_aw9364_check() runs
+#define HOST_SIM_AW9364_FADE_MS      200
+
+// EN as the AW9364 sees it, only used by the RMT callback (the aw9364 driver serializes the transmissions)
+typedef struct {
+    uint8_t step;
+    uint32_t level;
+    int64_t low_ns;             // since the last falling edge
+    int64_t high_ns;            // since the last rising edge
+    int64_t left_low_us;        // esp_timer time the last transmission left EN low, 0: it left EN high
+    uint32_t pulses;
+    uint32_t bad_pulses;
+} host_sim_aw9364_en_t;
+
+static host_sim_aw9364_en_t aw9364_en;
+
+// EN at level for ns, edges are counted with ns = 0 too
+static void host_sim_aw9364_en_level(uint32_t level, int64_t ns) {
+    host_sim_aw9364_en_t *en = &aw9364_en;
+    if (level == 0) {
+        if (en->level != 0) {
+            if (en->step > 0 && en->high_ns < HOST_SIM_AW9364_MIN_PULSE_NS) {
+                en->bad_pulses++;
+            }
+            en->low_ns = 0;
+        }
+        en->low_ns += ns;
+        if (en->step > 0 && en->low_ns > HOST_SIM_AW9364_OFF_NS) {
+            en->step = 0;
+        }
+    } else {
+        if (en->level == 0) {
+            if (en->step == 0) {
+                en->step = AW9364_MAX_BRIGHTNESS_STEPS;
+            } else if (en->low_ns >= HOST_SIM_AW9364_MIN_PULSE_NS && en->low_ns <= HOST_SIM_AW9364_MAX_PULSE_NS) {
+                en->step = en->step == 1 ? AW9364_MAX_BRIGHTNESS_STEPS : en->step - 1;
+                en->pulses++;
+            } else {
+                // a glitch, or a low between a step and shutting down
+                en->bad_pulses++;
+            }
+            en->high_ns = 0;
+        }
+        en->high_ns += ns;
+    }
+    en->level = level;
+}
+
+static void host_sim_aw9364_rmt_tx_cb(gpio_num_t gpio_num, uint32_t resolution_hz, const rmt_symbol_word_t *symbols,
+                                      size_t num_symbols, uint32_t eot_level, void *user_ctx) {
+    if (gpio_num != LCD_PIN_NUM_BK_LIGHT) {
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+    if (aw9364_en.left_low_us > 0) {
+        host_sim_aw9364_en_level(0, (now - aw9364_en.left_low_us) * 1000);
+    }
+    for (size_t i = 0; i < num_symbols; i++) {
+        // a zero duration ends the transmission
+        if (symbols[i].duration0 == 0) {
+            break;
+        }
+        host_sim_aw9364_en_level(symbols[i].level0, symbols[i].duration0 * 1000000000LL / resolution_hz);
+        if (symbols[i].duration1 == 0) {
+            break;
+        }
+        host_sim_aw9364_en_level(symbols[i].level1, symbols[i].duration1 * 1000000000LL / resolution_hz);
+    }
+    host_sim_aw9364_en_level(eot_level, 0);
+    aw9364_en.left_low_us = eot_level ? 0 : now;
+
+    uint8_t step = aw9364_en.step;
+    portENTER_CRITICAL(&aw9364_lock);
+    bool changed = step != aw9364_state.step;
+    aw9364_state.step = step;
+    aw9364_state.led_current_ua = step * HOST_SIM_AW9364_MAX_CURRENT_UA / AW9364_MAX_BRIGHTNESS_STEPS;
+    aw9364_state.step_changes += changed;
+    aw9364_state.pulses = aw9364_en.pulses;
+    aw9364_state.bad_pulses = aw9364_en.bad_pulses;
+    portEXIT_CRITICAL(&aw9364_lock);
+
+    if (changed) {
+        ESP_LOGI(TAG, "backlight step %d (%d uA)", step,
+                 step * HOST_SIM_AW9364_MAX_CURRENT_UA / AW9364_MAX_BRIGHTNESS_STEPS);
+    }
+}
+
+esp_err_t host_sim_aw9364_start(uint32_t poll_ms) {
+    rmt_sim_set_tx_callback(host_sim_aw9364_rmt_tx_cb, NULL);
+    return ESP_OK;
+}
+
+esp_err_t host_sim_aw9364_check(void) {
+    uint32_t transitions = 0;
+    uint32_t failed = 0;
+    // one step change log per transition otherwise
+    esp_log_level_set(TAG, ESP_LOG_WARN);
+    for (int from = 0; from <= AW9364_MAX_BRIGHTNESS_STEPS; from++) {
+        for (int to = 0; to <= AW9364_MAX_BRIGHTNESS_STEPS; to++) {
+            host_sim_aw9364_state_t before;
+            host_sim_aw9364_state_t after;
+            lcd_set_brightness_step(from);
+            host_sim_aw9364_get_state(&before);
+            lcd_set_brightness_step(to);
+            host_sim_aw9364_get_state(&after);
+
+            // turning on starts at the highest step
+            int start = from == 0 ? AW9364_MAX_BRIGHTNESS_STEPS : from;
+            uint32_t expected_pulses = to == 0 || to == from ? 0 :
+                    (start - to + AW9364_MAX_BRIGHTNESS_STEPS) % AW9364_MAX_BRIGHTNESS_STEPS;
+            uint32_t pulses = after.pulses - before.pulses;
+            transitions++;
+            if (before.step != from || after.step != to || pulses != expected_pulses ||
+                after.bad_pulses != before.bad_pulses) {
+                failed++;
+                ESP_LOGE(TAG, "step %d -> %d: got step %d -> %d, %" PRIu32 " pulses (expected %" PRIu32 "), %"
+                         PRIu32 " bad pulses", from, to, before.step, after.step, pulses, expected_pulses,
+                         after.bad_pulses - before.bad_pulses);
+            }
+        }
+    }
+
+    // fades step from the esp_timer callback, which must end on the target without a bad pulse
+    static const uint8_t fades[][2] = {{16, 1}, {1, 16}, {0, 12}, {12, 0}};
+    for (size_t i = 0; i < sizeof(fades) / sizeof(fades[0]); i++) {
+        host_sim_aw9364_state_t before;
+        host_sim_aw9364_state_t after;
+        lcd_set_brightness_step(fades[i][0]);
+        host_sim_aw9364_get_state(&before);
+        lcd_set_brightness_step_fade(fades[i][1], HOST_SIM_AW9364_FADE_MS);
+        host_sim_clock_run_ms(HOST_SIM_AW9364_FADE_MS * 2);
+        host_sim_aw9364_get_state(&after);
+        transitions++;
+        if (after.step != fades[i][1] || after.bad_pulses != before.bad_pulses) {
+            failed++;
+            ESP_LOGE(TAG, "fade %d -> %d: got step %d, %" PRIu32 " bad pulses", fades[i][0], fades[i][1],
+                     after.step, after.bad_pulses - before.bad_pulses);
+        }
+    }
+    lcd_set_brightness_step(0);
+    esp_log_level_set(TAG, ESP_LOG_INFO);
+
+    ESP_LOGI(TAG, "pulse trains: %" PRIu32 " transitions, %" PRIu32 " failed", transitions, failed);
+    return failed == 0 ? ESP_OK : ESP_FAIL;
+}
+
+#else
+
+static void host_sim_aw9364_poll_cb(void *arg) {
+    ledc_sim_channel_t chan;
+    ledc_sim_get_channel(LCD_BK_LIGHT_LEDC_CH, &chan);
+    uint8_t step = 0;
+    if (!chan.paused && chan.max_duty > 0) {
+        step = (chan.duty * AW9364_MAX_BRIGHTNESS_STEPS + chan.max_duty / 2) / chan.max_duty;
+    }
+
+    portENTER_CRITICAL(&aw9364_lock);
+    bool changed = step != aw9364_state.step;
+    aw9364_state.duty = chan.duty;
+    aw9364_state.max_duty = chan.max_duty;
+    aw9364_state.step = step;
+    aw9364_state.led_current_ua = step * HOST_SIM_AW9364_MAX_CURRENT_UA / AW9364_MAX_BRIGHTNESS_STEPS;
+    aw9364_state.step_changes += changed;
+    portEXIT_CRITICAL(&aw9364_lock);
+
+    if (changed) {
+        ESP_LOGI(TAG, "backlight step %d (%d uA)", step,
+                 step * HOST_SIM_AW9364_MAX_CURRENT_UA / AW9364_MAX_BRIGHTNESS_STEPS);
+    }
+}
+
+esp_err_t host_sim_aw9364_start(uint32_t poll_ms) {
+    const esp_timer_create_args_t poll_timer_args = {
+            .callback = host_sim_aw9364_poll_cb,
+            .name = "aw9364_sim",
+    };
+    esp_timer_handle_t poll_timer;
+    ESP_RETURN_ON_ERROR(esp_timer_create(&poll_timer_args, &poll_timer), TAG, "create aw9364 poll timer failed");
+    return esp_timer_start_periodic(poll_timer, (uint64_t) (poll_ms > 0 ? poll_ms : 1) * 1000);
+}
+
+esp_err_t host_sim_aw9364_check(void) {
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif
+
+void host_sim_aw9364_get_state(host_sim_aw9364_state_t *state) {
+    portENTER_CRITICAL(&aw9364_lock);
+    *state = aw9364_state;
+    portEXIT_CRITICAL(&aw9364_lock);
+}
@@ -0,0 +1,29 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// AW9364 LED driver as seen by the backlight LEDs
+typedef struct {
+    uint32_t duty;              // PWM duty on the AW9364 EN pin (LEDC backend)
+    uint32_t max_duty;
+    uint8_t step;               // current step (0-16) the AW9364 drives the LEDs with
+    uint32_t led_current_ua;
+    uint32_t step_changes;      // since host_sim_aw9364_start
+    uint32_t pulses;            // step down pulses on EN (RMT backend)
+    uint32_t bad_pulses;        // EN lows or highs out of the AW9364 timings (RMT backend)
+} host_sim_aw9364_state_t;
+
+// watch the backlight channel every poll_ms with the LEDC backend, decode every RMT transmission on EN with
+// LCD_BK_LIGHT_RMT (poll_ms unused)
+esp_err_t host_sim_aw9364_start(uint32_t poll_ms);
+
+void host_sim_aw9364_get_state(host_sim_aw9364_state_t *state);
+
+// LCD_BK_LIGHT_RMT only: sets every step from every step (0-16) through lcd_set_brightness_step(), checks the step
+// and the pulses the emulated AW9364 decoded, then runs a few fades up and down and checks where they end. Logs the
+// failures and leaves the backlight off. ESP_FAIL if any failed
+esp_err_t host_sim_aw9364_check(void);
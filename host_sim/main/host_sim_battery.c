@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Battery curve check
+//
+// battery_curve_lipo is sampled from 123 - 123 / (1 + (V / 3.7)^80)^0.165, clamped to 0-100 %, by
+// components/tdisplays3/tools/gen_battery_curve.py. The table points have to be the rounded equation, and the
+// interpolation of millivolts_to_percentage() has to stay within the error bound stated in t_display_s3_battery.c.
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <math.h>
+#include <esp_log.h>
+#include "t_display_s3.h"
+#include "host_sim_battery.h"
+
+static const char *TAG = "host_sim_battery";
+
+#define HOST_SIM_BATTERY_MAX_ERROR_PCT 1.1
+// checked below and above the table too, where the percentage is clamped
+#define HOST_SIM_BATTERY_MARGIN_MV     500
+
+static double host_sim_battery_reference_pct(int millivolts) {
+    double pct = 123.0 - 123.0 / pow(1.0 + pow(millivolts / 3700.0, 80.0), 0.165);
+    return fmin(fmax(pct, 0.0), 100.0);
+}
+
+esp_err_t host_sim_battery_check(void) {
+    esp_err_t ret = ESP_OK;
+    const battery_discharge_curve_t *curve = &battery_curve_lipo;
+    battery_set_discharge_curve(curve);
+
+    for (uint32_t i = 0; i < curve->count; i++) {
+        int millivolts = curve->min_millivolts + (int) i * curve->step_millivolts;
+        int expected = (int) lround(host_sim_battery_reference_pct(millivolts));
+        int pct = millivolts_to_percentage(millivolts);
+        if (curve->percentage[i] != expected || pct != expected) {
+            ESP_LOGE(TAG, "%d mV: table %d %%, millivolts_to_percentage() %d %%, equation %d %%", millivolts,
+                     curve->percentage[i], pct, expected);
+            ret = ESP_FAIL;
+            break;
+        }
+    }
+
+    int max_millivolts = curve->min_millivolts + (int) (curve->count - 1) * curve->step_millivolts;
+    double max_error = 0;
+    int max_error_millivolts = 0;
+    int last_pct = 0;
+    for (int millivolts = curve->min_millivolts - HOST_SIM_BATTERY_MARGIN_MV;
+         millivolts <= max_millivolts + HOST_SIM_BATTERY_MARGIN_MV; millivolts++) {
+        int pct = millivolts_to_percentage(millivolts);
+        double error = fabs(pct - host_sim_battery_reference_pct(millivolts));
+        if (error > max_error) {
+            max_error = error;
+            max_error_millivolts = millivolts;
+        }
+        if (pct < last_pct) {
+            ESP_LOGE(TAG, "%d mV: %d %%, %d %% at 1 mV less", millivolts, pct, last_pct);
+            ret = ESP_FAIL;
+        }
+        last_pct = pct;
+    }
+    if (max_error > HOST_SIM_BATTERY_MAX_ERROR_PCT) {
+        ESP_LOGE(TAG, "%d mV: interpolated %.2f %% off the equation, more than %.1f %%", max_error_millivolts,
+                 max_error, HOST_SIM_BATTERY_MAX_ERROR_PCT);
+        ret = ESP_FAIL;
+    }
+    printf("battery curve (%s): %" PRIu32 " points, interpolated within %.2f %% of the equation (at %d mV)\n",
+           curve->name, curve->count, max_error, max_error_millivolts);
+    return ret;
+}
@@ -0,0 +1,11 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "esp_err.h"
+
+// checks millivolts_to_percentage() with the LiPo curve against its discharge equation: every table point exactly,
+// every mV in between within HOST_SIM_BATTERY_MAX_ERROR_PCT, never decreasing. Logs the first failure of each check
+// and prints the largest interpolation error. ESP_FAIL if any check failed
+esp_err_t host_sim_battery_check(void);
@@ -0,0 +1,17 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Blend kernel check parity
+//
+// The board's SIMD kernels are checked against a copy of the loops LVGL runs without them (t_display_s3_lv_blend.c).
+// They don't run on the host, but LVGL's C functions do: checking those against the copy keeps it in step with LVGL,
+// and the areas, offsets and guard pixels of the check are the board's.
+
+#include "lvgl.h"
+#include "draw/sw/blend/lv_draw_sw_blend_to_rgb565.h"
+#include "t_display_s3_priv.h"
+#include "host_sim_blend.h"
+
+esp_err_t host_sim_blend_check(void) {
+    return lcd_blend_check_kernels(lv_draw_sw_blend_color_to_rgb565, lv_draw_sw_blend_image_to_rgb565);
+}
@@ -0,0 +1,11 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "esp_err.h"
+
+// runs LVGL's own RGB565 fill and image blend through lcd_blend_check_kernels(), the check the board's SIMD kernels
+// get with CONFIG_TDISPLAYS3_BLEND_SELF_TEST. ESP_FAIL if the C reference of t_display_s3_lv_blend.c writes anything
+// different from LVGL
+esp_err_t host_sim_blend_check(void);
@@ -0,0 +1,252 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Edge mode button check
+//
+// Two buttons of t_display_s3_button.c on the simulated GPIO pins of the board's buttons (active low) and the
+// espressif/button mock of host_sim/components/button. The edges are set with gpio_sim_set_input(), whose interrupt
+// handler runs before it returns, the button timer runs from the simulated esp_timer, stepped by
+// host_sim_clock_run_ms(). Each step checks the edge mode counters and the callbacks against what the edges should
+// have done:
+//  - idle buttons are never scanned,
+//  - the first edge of a bouncing press arms the timer, the bounces after it take no interrupt, the press is reported
+//    once with the time of its first edge, and the timer stops again after the release,
+//  - a second button pressed while the timer runs takes its edge without arming it again,
+//  - a glitch shorter than the debounce arms the timer and it stops again without a press,
+//  - a button held when it's created fires right away (the interrupt is level triggered),
+//  - a long press, and ESP_ERR_NO_MEM past BUTTON_EDGE_MAX_BUTTONS.
+// The times are simulated.
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+#include <esp_log.h>
+#include <esp_check.h>
+#include <esp_timer.h>
+#include "freertos/FreeRTOS.h"
+#include "driver/gpio.h"
+#include "t_display_s3.h"
+#include "t_display_s3_button.h"
+#include "host_sim_clock.h"
+#include "host_sim_button.h"
+
+static const char *TAG = "host_sim_button";
+
+#define HOST_SIM_BUTTON_COUNT         2
+#define HOST_SIM_BUTTON_LONG_PRESS_MS 300
+// the debounce of a press and a few scans more
+#define HOST_SIM_BUTTON_PRESS_MS      (CONFIG_BUTTON_PERIOD_TIME_MS * (CONFIG_BUTTON_DEBOUNCE_TICKS + 1) + 30)
+// a release is followed by the click window (the short press time) before the button is idle
+#define HOST_SIM_BUTTON_IDLE_MS       (CONFIG_BUTTON_SHORT_PRESS_TIME_MS + 100)
+// a reported press, measured from its edge
+#define HOST_SIM_BUTTON_MAX_REPORT_US 20000
+
+typedef struct {
+    uint32_t events[BUTTON_EVENT_MAX];
+    int64_t press_time_us;      // button_edge_take_press_time_us() of the last BUTTON_PRESS_DOWN
+    int64_t reported_us;        // time of the last BUTTON_PRESS_DOWN
+} host_sim_button_log_t;
+
+static const gpio_num_t pins[HOST_SIM_BUTTON_COUNT] = {BTN_PIN_NUM_1, BTN_PIN_NUM_2};
+static button_handle_t buttons[HOST_SIM_BUTTON_COUNT];
+static host_sim_button_log_t logs[HOST_SIM_BUTTON_COUNT];
+static portMUX_TYPE log_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// runs in the esp_timer callback of the button timer
+static void host_sim_button_cb(void *button_handle, void *usr_data) {
+    host_sim_button_log_t *log = (host_sim_button_log_t *) usr_data;
+    button_event_t event = iot_button_get_event(button_handle);
+    int64_t press_time_us = event == BUTTON_PRESS_DOWN ? button_edge_take_press_time_us(button_handle) : 0;
+
+    portENTER_CRITICAL(&log_lock);
+    log->events[event]++;
+    if (event == BUTTON_PRESS_DOWN) {
+        log->press_time_us = press_time_us;
+        log->reported_us = esp_timer_get_time();
+    }
+    portEXIT_CRITICAL(&log_lock);
+}
+
+static uint32_t host_sim_button_events(int i, button_event_t event) {
+    portENTER_CRITICAL(&log_lock);
+    uint32_t count = logs[i].events[event];
+    portEXIT_CRITICAL(&log_lock);
+    return count;
+}
+
+static esp_err_t host_sim_button_create(int i) {
+    const button_config_t config = {
+            .long_press_time = HOST_SIM_BUTTON_LONG_PRESS_MS,
+    };
+    const button_gpio_config_t gpio_config = {
+            .gpio_num = pins[i],
+            .active_level = 0,
+    };
+    memset(&logs[i], 0, sizeof(host_sim_button_log_t));
+    ESP_RETURN_ON_ERROR(button_edge_new_gpio_device(&config, &gpio_config, &buttons[i]), TAG, "create button failed");
+    ESP_RETURN_ON_ERROR(iot_button_register_cb(buttons[i], BUTTON_PRESS_DOWN, NULL, host_sim_button_cb, &logs[i]),
+                        TAG, "register callback failed");
+    ESP_RETURN_ON_ERROR(iot_button_register_cb(buttons[i], BUTTON_PRESS_UP, NULL, host_sim_button_cb, &logs[i]),
+                        TAG, "register callback failed");
+    ESP_RETURN_ON_ERROR(iot_button_register_cb(buttons[i], BUTTON_LONG_PRESS_START, NULL, host_sim_button_cb,
+                                               &logs[i]), TAG, "register callback failed");
+    return ESP_OK;
+}
+
+static void host_sim_button_delete(int i) {
+    if (buttons[i] != NULL) {
+        iot_button_delete(buttons[i]);
+        buttons[i] = NULL;
+    }
+}
+
+// level 0: pressed, toggles bounces times before it settles
+static void host_sim_button_set(int i, int level, int bounces) {
+    for (int b = 0; b < bounces; b++) {
+        gpio_sim_set_input(pins[i], level);
+        gpio_sim_set_input(pins[i], !level);
+    }
+    gpio_sim_set_input(pins[i], level);
+}
+
+esp_err_t host_sim_button_check(void) {
+    esp_err_t ret = ESP_OK;
+    button_edge_stats_t start;
+    button_edge_stats_t before;
+    button_edge_stats_t after;
+    int64_t start_us = esp_timer_get_time();
+
+    for (int i = 0; i < HOST_SIM_BUTTON_COUNT; i++) {
+        gpio_sim_set_input(pins[i], 1);
+        ESP_GOTO_ON_ERROR(host_sim_button_create(i), err, TAG, "button %d", i);
+    }
+    button_edge_get_stats(&start);
+
+    // idle: no scans
+    host_sim_clock_run_ms(HOST_SIM_BUTTON_IDLE_MS);
+    button_edge_get_stats(&after);
+    ESP_GOTO_ON_FALSE(after.edges == start.edges && after.arms == start.arms &&
+                      after.level_reads == start.level_reads, ESP_FAIL, err, TAG,
+                      "idle buttons: %" PRIu32 " edges, %" PRIu32 " arms, %" PRIu32 " scans", after.edges - start.edges,
+                      after.arms - start.arms, after.level_reads - start.level_reads);
+
+    // a bouncing press and release of button 0
+    before = after;
+    int64_t edge_us = esp_timer_get_time();
+    host_sim_button_set(0, 0, 3);
+    int64_t edge_done_us = esp_timer_get_time();
+    button_edge_get_stats(&after);
+    ESP_GOTO_ON_FALSE(after.edges == before.edges + 1 && after.arms == before.arms + 1, ESP_FAIL, err, TAG,
+                      "bouncing press: %" PRIu32 " edges, %" PRIu32 " arms, expected 1 each",
+                      after.edges - before.edges, after.arms - before.arms);
+    host_sim_clock_run_ms(HOST_SIM_BUTTON_PRESS_MS);
+    portENTER_CRITICAL(&log_lock);
+    host_sim_button_log_t log = logs[0];
+    portEXIT_CRITICAL(&log_lock);
+    ESP_GOTO_ON_FALSE(log.events[BUTTON_PRESS_DOWN] == 1, ESP_FAIL, err, TAG, "bouncing press: %" PRIu32 " presses",
+                      log.events[BUTTON_PRESS_DOWN]);
+    ESP_GOTO_ON_FALSE(log.press_time_us >= edge_us && log.press_time_us <= edge_done_us, ESP_FAIL, err, TAG,
+                      "press time %" PRId64 " us, the edge was at %" PRId64 " - %" PRId64 " us", log.press_time_us,
+                      edge_us, edge_done_us);
+    int64_t report_us = log.reported_us - log.press_time_us;
+    ESP_GOTO_ON_FALSE(report_us < HOST_SIM_BUTTON_MAX_REPORT_US, ESP_FAIL, err, TAG,
+                      "press reported %" PRId64 " us after its edge", report_us);
+    host_sim_button_set(0, 1, 3);
+    host_sim_clock_run_ms(HOST_SIM_BUTTON_IDLE_MS);
+    ESP_GOTO_ON_FALSE(host_sim_button_events(0, BUTTON_PRESS_UP) == 1 &&
+                      host_sim_button_events(0, BUTTON_PRESS_DOWN) == 1, ESP_FAIL, err, TAG,
+                      "bouncing release: %" PRIu32 " presses, %" PRIu32 " releases",
+                      host_sim_button_events(0, BUTTON_PRESS_DOWN), host_sim_button_events(0, BUTTON_PRESS_UP));
+    button_edge_get_stats(&before);
+    host_sim_clock_run_ms(HOST_SIM_BUTTON_IDLE_MS);
+    button_edge_get_stats(&after);
+    ESP_GOTO_ON_FALSE(after.level_reads == before.level_reads && after.edges == before.edges, ESP_FAIL, err, TAG,
+                      "timer still scanning after the release (%" PRIu32 " scans)",
+                      after.level_reads - before.level_reads);
+
+    // button 1 pressed while button 0 is held, one arm
+    before = after;
+    host_sim_button_set(0, 0, 0);
+    host_sim_clock_run_ms(HOST_SIM_BUTTON_PRESS_MS);
+    host_sim_button_set(1, 0, 0);
+    host_sim_clock_run_ms(HOST_SIM_BUTTON_PRESS_MS);
+    button_edge_get_stats(&after);
+    ESP_GOTO_ON_FALSE(after.edges == before.edges + 2 && after.arms == before.arms + 1, ESP_FAIL, err, TAG,
+                      "two presses: %" PRIu32 " edges, %" PRIu32 " arms, expected 2 and 1", after.edges - before.edges,
+                      after.arms - before.arms);
+    ESP_GOTO_ON_FALSE(host_sim_button_events(0, BUTTON_PRESS_DOWN) == 2 &&
+                      host_sim_button_events(1, BUTTON_PRESS_DOWN) == 1, ESP_FAIL, err, TAG,
+                      "two presses: %" PRIu32 " and %" PRIu32 " reported", host_sim_button_events(0, BUTTON_PRESS_DOWN),
+                      host_sim_button_events(1, BUTTON_PRESS_DOWN));
+    host_sim_button_set(0, 1, 0);
+    host_sim_button_set(1, 1, 0);
+    host_sim_clock_run_ms(HOST_SIM_BUTTON_IDLE_MS);
+
+    // a glitch between two scans: armed, no press, stopped again
+    button_edge_get_stats(&before);
+    host_sim_button_set(1, 0, 0);
+    host_sim_button_set(1, 1, 0);
+    host_sim_clock_run_ms(HOST_SIM_BUTTON_IDLE_MS);
+    button_edge_get_stats(&after);
+    ESP_GOTO_ON_FALSE(after.arms == before.arms + 1 && host_sim_button_events(1, BUTTON_PRESS_DOWN) == 1, ESP_FAIL,
+                      err, TAG, "glitch: %" PRIu32 " arms, %" PRIu32 " presses of button 1", after.arms - before.arms,
+                      host_sim_button_events(1, BUTTON_PRESS_DOWN));
+    before = after;
+    host_sim_clock_run_ms(HOST_SIM_BUTTON_IDLE_MS);
+    button_edge_get_stats(&after);
+    ESP_GOTO_ON_FALSE(after.level_reads == before.level_reads, ESP_FAIL, err, TAG,
+                      "timer still scanning after the glitch");
+
+    // button 1 held when it's created
+    host_sim_button_delete(1);
+    button_edge_get_stats(&before);
+    gpio_sim_set_input(pins[1], 0);
+    ESP_GOTO_ON_ERROR(host_sim_button_create(1), err, TAG, "button 1");
+    host_sim_clock_run_ms(HOST_SIM_BUTTON_PRESS_MS);
+    button_edge_get_stats(&after);
+    ESP_GOTO_ON_FALSE(after.arms == before.arms + 1 && host_sim_button_events(1, BUTTON_PRESS_DOWN) == 1, ESP_FAIL,
+                      err, TAG, "held at creation: %" PRIu32 " arms, %" PRIu32 " presses", after.arms - before.arms,
+                      host_sim_button_events(1, BUTTON_PRESS_DOWN));
+    host_sim_button_set(1, 1, 0);
+    host_sim_clock_run_ms(HOST_SIM_BUTTON_IDLE_MS);
+
+    // long press of button 0
+    host_sim_button_set(0, 0, 0);
+    host_sim_clock_run_ms(HOST_SIM_BUTTON_LONG_PRESS_MS + HOST_SIM_BUTTON_PRESS_MS);
+    ESP_GOTO_ON_FALSE(host_sim_button_events(0, BUTTON_LONG_PRESS_START) == 1, ESP_FAIL, err, TAG,
+                      "long press: %" PRIu32 " long presses", host_sim_button_events(0, BUTTON_LONG_PRESS_START));
+    host_sim_button_set(0, 1, 0);
+    host_sim_clock_run_ms(HOST_SIM_BUTTON_IDLE_MS);
+    ESP_GOTO_ON_FALSE(host_sim_button_events(0, BUTTON_PRESS_UP) == 3, ESP_FAIL, err, TAG,
+                      "long press: %" PRIu32 " releases", host_sim_button_events(0, BUTTON_PRESS_UP));
+
+    // no slot past BUTTON_EDGE_MAX_BUTTONS
+    button_handle_t extra[BUTTON_EDGE_MAX_BUTTONS] = {0};
+    const button_config_t extra_config = {0};
+    esp_err_t extra_ret = ESP_OK;
+    int extra_count = 0;
+    for (int i = 0; extra_ret == ESP_OK && i < BUTTON_EDGE_MAX_BUTTONS; i++) {
+        button_gpio_config_t extra_gpio_config = {.gpio_num = GPIO_NUM_1 + i};
+        extra_ret = button_edge_new_gpio_device(&extra_config, &extra_gpio_config, &extra[i]);
+        extra_count += extra_ret == ESP_OK;
+    }
+    for (int i = 0; i < extra_count; i++) {
+        iot_button_delete(extra[i]);
+    }
+    ESP_GOTO_ON_FALSE(extra_ret == ESP_ERR_NO_MEM && extra_count == BUTTON_EDGE_MAX_BUTTONS - HOST_SIM_BUTTON_COUNT,
+                      ESP_FAIL, err, TAG, "%d buttons created past %d, then %s", extra_count, HOST_SIM_BUTTON_COUNT,
+                      esp_err_to_name(extra_ret));
+
+    button_edge_get_stats(&after);
+    printf("buttons (edge mode, simulated time): press reported %" PRId64 " us after its edge (%d ms scans, %d debounce "
+           "ticks), %" PRIu32 " edges, %" PRIu32 " arms, %" PRIu32 " scans, timer ran %" PRIu64 " of %" PRId64 " ms\n",
+           report_us, CONFIG_BUTTON_PERIOD_TIME_MS, CONFIG_BUTTON_DEBOUNCE_TICKS, after.edges - start.edges,
+           after.arms - start.arms, after.level_reads - start.level_reads, (after.armed_us - start.armed_us) / 1000,
+           (esp_timer_get_time() - start_us) / 1000);
+
+err:
+    for (int i = 0; i < HOST_SIM_BUTTON_COUNT; i++) {
+        host_sim_button_delete(i);
+    }
+    return ret;
+}
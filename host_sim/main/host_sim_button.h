@@ -0,0 +1,11 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "esp_err.h"
+
+// drives two edge mode buttons with synthetic (bouncing) edges on the simulated GPIO pins and checks the interrupts,
+// timer arms, scans and callbacks each should cause. Prints the press report time and the time the button timer ran.
+// Logs the first failure, ESP_FAIL if any check failed
+esp_err_t host_sim_button_check(void);
@@ -0,0 +1,36 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Lockstep of the simulated clock
+//
+// The esp_timer of host_sim (host_sim/components/esp_timer) only moves when it is told to. The main task holds the
+// lvgl lock from host_sim_clock_start() on and steps the board 1 ms at a time: the esp_timer callbacks (button scans,
+// backlight fades, the port's tick timer) run in it, then lv_timer_handler() does what the LVGL task would do at that
+// time, then the step waits for the flush task to send the stripes, which spends their bus time on the same clock.
+// So every refresh, transfer and esp_timer timestamp falls at the same simulated time on every host.
+
+#include <esp_log.h>
+#include <esp_check.h>
+#include <esp_timer.h>
+#include "t_display_s3.h"
+#include "t_display_s3_priv.h"
+#include "host_sim_clock.h"
+
+static const char *TAG = "host_sim_clock";
+
+// host time the flush task gets to send what one lv_timer_handler() queued
+#define HOST_SIM_CLOCK_FLUSH_TIMEOUT_MS 1000
+
+esp_err_t host_sim_clock_start(void) {
+    // never given back, the port task waits for it from now on
+    ESP_RETURN_ON_FALSE(lvgl_port_lock(0), ESP_FAIL, TAG, "lvgl lock not taken");
+    return ESP_OK;
+}
+
+void host_sim_clock_run_ms(uint32_t ms) {
+    for (uint32_t i = 0; i < ms; i++) {
+        esp_timer_sim_advance(1000);
+        lv_timer_handler();
+        ESP_ERROR_CHECK(lcd_flush_wait_idle(HOST_SIM_CLOCK_FLUSH_TIMEOUT_MS));
+    }
+}
@@ -0,0 +1,15 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+// takes the lvgl lock for the rest of the run, so LVGL only runs from host_sim_clock_run_ms() and not from the port
+// task. ESP_FAIL if the lock can't be taken
+esp_err_t host_sim_clock_start(void);
+
+// runs the simulated board for ms of simulated time, 1 ms at a time: the esp_timer callbacks due, lv_timer_handler()
+// like the LVGL task, then the stripes it queued. Aborts if the flush pipeline doesn't drain
+void host_sim_clock_run_ms(uint32_t ms);
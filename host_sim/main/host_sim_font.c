@@ -0,0 +1,136 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Glyph lookup benchmark
+//
+// lv_font_get_glyph_dsc_fmt_txt() is wrapped by t_display_s3_font.c, __real_lv_font_get_glyph_dsc_fmt_txt() is
+// LVGL's cmap walk and kerning binary search. Both look up the letters (and the letter after each, for the kerning)
+// of the texts the example UI shows, on the Montserrat fonts lcd_init() registered. Before timing, every printable
+// ASCII pair and every letter of Latin-1 and the LV_SYMBOL range must get the same glyph descriptor from both.
+// The times are host times.
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include "t_display_s3.h"
+#include "misc/lv_text_private.h"
+#include "host_sim_font.h"
+
+static const char *TAG = "host_sim_font";
+
+bool __real_lv_font_get_glyph_dsc_fmt_txt(const lv_font_t *font, lv_font_glyph_dsc_t *dsc_out,
+                                          uint32_t unicode_letter, uint32_t unicode_letter_next);
+bool __wrap_lv_font_get_glyph_dsc_fmt_txt(const lv_font_t *font, lv_font_glyph_dsc_t *dsc_out,
+                                          uint32_t unicode_letter, uint32_t unicode_letter_next);
+
+typedef bool (*host_sim_font_lookup_t)(const lv_font_t *font, lv_font_glyph_dsc_t *dsc_out, uint32_t unicode_letter,
+                                       uint32_t unicode_letter_next);
+
+#define HOST_SIM_FONT_ROUNDS      20000
+#define HOST_SIM_FONT_MAX_LETTERS 256
+
+// what the example UI shows, symbols included
+static const char *const texts[] = {
+        "Battery Power",
+        "Charge Level: 92 %",
+        "4123 mV",
+        "USB Power",
+        "----------",
+        "Brightness",
+        LV_SYMBOL_BATTERY_FULL LV_SYMBOL_BATTERY_3 LV_SYMBOL_USB LV_SYMBOL_LEFT,
+        "AVA Tv To Yo 0123456789",
+};
+
+static const struct {
+    const lv_font_t *font;
+    int size;
+} fonts[] = {
+#if LV_FONT_MONTSERRAT_14
+        {&lv_font_montserrat_14, 14},
+#endif
+#if LV_FONT_MONTSERRAT_20
+        {&lv_font_montserrat_20, 20},
+#endif
+#if LV_FONT_MONTSERRAT_24
+        {&lv_font_montserrat_24, 24},
+#endif
+};
+
+static uint32_t letters[HOST_SIM_FONT_MAX_LETTERS];
+static uint32_t letter_count;
+
+static bool host_sim_font_same(const lv_font_t *font, uint32_t letter, uint32_t letter_next) {
+    lv_font_glyph_dsc_t real = {0};
+    lv_font_glyph_dsc_t wrap = {0};
+    bool real_found = __real_lv_font_get_glyph_dsc_fmt_txt(font, &real, letter, letter_next);
+    bool wrap_found = __wrap_lv_font_get_glyph_dsc_fmt_txt(font, &wrap, letter, letter_next);
+    if (real_found != wrap_found) {
+        return false;
+    }
+    return !real_found || (real.adv_w == wrap.adv_w && real.box_w == wrap.box_w && real.box_h == wrap.box_h &&
+                           real.ofs_x == wrap.ofs_x && real.ofs_y == wrap.ofs_y && real.format == wrap.format &&
+                           real.gid.index == wrap.gid.index);
+}
+
+static bool host_sim_font_check(const lv_font_t *font, int size) {
+    for (uint32_t letter = ' '; letter <= '~'; letter++) {
+        for (uint32_t next = ' '; next <= '~'; next++) {
+            if (!host_sim_font_same(font, letter, next)) {
+                ESP_LOGE(TAG, "montserrat %d: U+%04" PRIX32 " before U+%04" PRIX32 " differs", size, letter, next);
+                return false;
+            }
+        }
+    }
+    for (uint32_t letter = 0; letter <= 0xF8FF; letter = letter == 0xFF ? 0xF000 : letter + 1) {
+        if (!host_sim_font_same(font, letter, 0) || !host_sim_font_same(font, letter, 'A')) {
+            ESP_LOGE(TAG, "montserrat %d: U+%04" PRIX32 " differs", size, letter);
+            return false;
+        }
+    }
+    return true;
+}
+
+// ns per letter
+static uint32_t host_sim_font_time(const lv_font_t *font, host_sim_font_lookup_t lookup) {
+    lv_font_glyph_dsc_t dsc;
+    volatile uint32_t adv_w = 0;
+    int64_t start = esp_timer_sim_get_host_time();
+    for (int round = 0; round < HOST_SIM_FONT_ROUNDS; round++) {
+        for (uint32_t i = 0; i < letter_count; i++) {
+            if (lookup(font, &dsc, letters[i], letters[i + 1])) {
+                adv_w += dsc.adv_w;
+            }
+        }
+    }
+    int64_t elapsed = esp_timer_sim_get_host_time() - start;
+    return (uint32_t) (elapsed * 1000 / ((int64_t) HOST_SIM_FONT_ROUNDS * letter_count));
+}
+
+esp_err_t host_sim_font_benchmark(void) {
+    // the letters of all texts one after the other, the last one followed by 0
+    letter_count = 0;
+    for (size_t t = 0; t < sizeof(texts) / sizeof(texts[0]); t++) {
+        uint32_t i = 0;
+        uint32_t letter;
+        while ((letter = lv_text_encoded_next(texts[t], &i)) != 0 && letter_count < HOST_SIM_FONT_MAX_LETTERS - 1) {
+            letters[letter_count++] = letter;
+        }
+        letters[letter_count] = 0;
+    }
+
+    esp_err_t ret = ESP_OK;
+    for (size_t f = 0; f < sizeof(fonts) / sizeof(fonts[0]); f++) {
+        const lv_font_t *font = fonts[f].font;
+        if (!host_sim_font_check(font, fonts[f].size)) {
+            ret = ESP_FAIL;
+            continue;
+        }
+        uint32_t real_ns = host_sim_font_time(font, __real_lv_font_get_glyph_dsc_fmt_txt);
+        uint32_t wrap_ns = host_sim_font_time(font, __wrap_lv_font_get_glyph_dsc_fmt_txt);
+        printf("glyph lookup (host time): montserrat %d, %" PRIu32 " letters: LVGL %" PRIu32 " ns/char, tables %"
+               PRIu32 " ns/char\n", fonts[f].size, letter_count, real_ns, wrap_ns);
+    }
+    return ret;
+}
@@ -0,0 +1,10 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "esp_err.h"
+
+// checks the glyph descriptors of the font tables against LVGL's lookup on Montserrat 14 / 20 / 24 and prints the ns
+// per letter of both on the texts of the example UI. ESP_FAIL if a descriptor differs
+esp_err_t host_sim_font_benchmark(void);
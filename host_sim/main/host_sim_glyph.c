@@ -0,0 +1,70 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Glyph cache font drop
+//
+// The glyph cache keys its glyphs on the font's address. A font freed at run time has to take its glyphs with it, or
+// the next font allocated at the same address is drawn with them. A heap copy of a built-in font stands in for a font
+// loaded at run time (lv_binfont_create()): its glyphs are unpacked next to the same glyphs of the built-in font, and
+// after lcd_glyph_cache_drop_font() only the built-in font's must still hit.
+
+#include <string.h>
+#include <esp_log.h>
+#include <esp_check.h>
+#include "t_display_s3.h"
+#include "host_sim_glyph.h"
+
+static const char *TAG = "host_sim_glyph";
+
+static const char letters[] = "Ag%7";
+
+// unpack every letter of a font, returns the glyph cache hits of the letters
+static uint32_t host_sim_glyph_unpack(const lv_font_t *font, lv_draw_buf_t *draw_buf) {
+    lcd_glyph_cache_stats_t before, after;
+    lcd_get_glyph_cache_stats(&before);
+    for (const char *c = letters; *c != '\0'; c++) {
+        lv_font_glyph_dsc_t g;
+        if (lv_font_get_glyph_dsc(font, &g, (uint32_t) *c, 0)) {
+            lv_draw_buf_reshape(draw_buf, LV_COLOR_FORMAT_A8, g.box_w, g.box_h, LV_STRIDE_AUTO);
+            lv_font_get_glyph_bitmap(&g, draw_buf);
+        }
+    }
+    lcd_get_glyph_cache_stats(&after);
+    return after.hits - before.hits;
+}
+
+esp_err_t host_sim_glyph_check(void) {
+#if LV_FONT_MONTSERRAT_14
+    esp_err_t ret = ESP_OK;
+    const uint32_t count = sizeof(letters) - 1;
+
+    lvgl_port_lock(0);
+    lv_font_t *font = lv_malloc(sizeof(lv_font_t));
+    lv_draw_buf_t *draw_buf = lv_draw_buf_create(32, 32, LV_COLOR_FORMAT_A8, LV_STRIDE_AUTO);
+    ESP_GOTO_ON_FALSE(font && draw_buf, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for the check!");
+    memcpy(font, &lv_font_montserrat_14, sizeof(lv_font_t));
+
+    host_sim_glyph_unpack(&lv_font_montserrat_14, draw_buf);
+    host_sim_glyph_unpack(font, draw_buf);
+    ESP_GOTO_ON_FALSE(host_sim_glyph_unpack(font, draw_buf) == count, ESP_FAIL, err, TAG,
+                      "glyphs of the copy not cached");
+
+    lcd_glyph_cache_drop_font(font);
+    uint32_t hits = host_sim_glyph_unpack(font, draw_buf);
+    ESP_GOTO_ON_FALSE(hits == 0, ESP_FAIL, err, TAG, "%u glyphs of the copy still cached after the drop",
+                      (unsigned) hits);
+    // the copy's glyphs are back, drop them before freeing it
+    lcd_glyph_cache_drop_font(font);
+    hits = host_sim_glyph_unpack(&lv_font_montserrat_14, draw_buf);
+    ESP_GOTO_ON_FALSE(hits == count, ESP_FAIL, err, TAG, "%u of %u glyphs of the font dropped with the copy",
+                      (unsigned) (count - hits), (unsigned) count);
+
+err:
+    lv_draw_buf_destroy(draw_buf);
+    lv_free(font);
+    lvgl_port_unlock();
+    return ret;
+#else
+    return ESP_OK;
+#endif
+}
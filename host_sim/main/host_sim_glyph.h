@@ -0,0 +1,11 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "esp_err.h"
+
+// unpacks a few glyphs of a heap copy of Montserrat 14 and of the font itself through the glyph cache, drops the copy
+// with lcd_glyph_cache_drop_font() and unpacks them again. ESP_FAIL if a glyph of the copy is still cached after the
+// drop, or a glyph of the font itself isn't
+esp_err_t host_sim_glyph_check(void);
@@ -0,0 +1,163 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Image cache benchmark
+//
+// An icon-heavy screen: a grid of lv_image widgets showing a few A4 icons (4 bit alpha, recolored by the style, like
+// the converter makes for monochrome icons) many times over. LVGL's bin decoder expands an A4 image to A8 on every
+// open, and only keeps the result in the image cache t_display_s3_cache.c sizes and counts (indexed images aren't
+// cached without LV_BIN_DECODER_RAM_LOAD, they are converted line by line on every draw). The screen is redrawn a few
+// times, the hits and misses are read from lcd_get_image_cache_stats(), the time one decode takes (the decoder opened
+// without the cache) is multiplied by the hits for the decoding time they saved. The panel must show the same with
+// the cache disabled. The times are host times.
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <esp_log.h>
+#include <esp_check.h>
+#include <esp_timer.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_lcd_sim.h"
+#include "t_display_s3.h"
+#include "draw/lv_image_decoder_private.h"
+#include "host_sim_image.h"
+
+static const char *TAG = "host_sim_image";
+
+// time the flush pipeline gets to send a refresh
+#define HOST_SIM_IMAGE_SETTLE_MS     100
+#define HOST_SIM_IMAGE_ICONS         8
+#define HOST_SIM_IMAGE_SIZE          32
+#define HOST_SIM_IMAGE_PITCH         40
+#define HOST_SIM_IMAGE_REFRESHES     10
+#define HOST_SIM_IMAGE_DECODE_ROUNDS 200
+// A4: 2 px per byte
+#define HOST_SIM_IMAGE_STRIDE        (HOST_SIM_IMAGE_SIZE / 2)
+#define HOST_SIM_IMAGE_DATA_SIZE     (HOST_SIM_IMAGE_STRIDE * HOST_SIM_IMAGE_SIZE)
+
+static uint8_t icon_data[HOST_SIM_IMAGE_ICONS][HOST_SIM_IMAGE_DATA_SIZE];
+static lv_image_dsc_t icons[HOST_SIM_IMAGE_ICONS];
+
+// rings of opacity around a center that moves with the icon, transparent outside the circle
+static void host_sim_image_make_icons(void) {
+    for (int i = 0; i < HOST_SIM_IMAGE_ICONS; i++) {
+        uint8_t *px = icon_data[i];
+        int cx = HOST_SIM_IMAGE_SIZE / 2 + i % 3 - 1;
+        int cy = HOST_SIM_IMAGE_SIZE / 2 + i / 3 - 1;
+        for (int y = 0; y < HOST_SIM_IMAGE_SIZE; y++) {
+            for (int x = 0; x < HOST_SIM_IMAGE_SIZE; x++) {
+                int d2 = (x - cx) * (x - cx) + (y - cy) * (y - cy);
+                uint8_t alpha = d2 >= (HOST_SIM_IMAGE_SIZE / 2) * (HOST_SIM_IMAGE_SIZE / 2) ? 0 :
+                                (uint8_t) (1 + (d2 / (8 + i) + i) % 15);
+                uint8_t *byte = &px[y * HOST_SIM_IMAGE_STRIDE + x / 2];
+                *byte = x % 2 ? (*byte & 0xF0) | alpha : (uint8_t) (alpha << 4);
+            }
+        }
+        icons[i] = (lv_image_dsc_t) {
+                .header = {
+                        .magic = LV_IMAGE_HEADER_MAGIC,
+                        .cf = LV_COLOR_FORMAT_A4,
+                        .w = HOST_SIM_IMAGE_SIZE,
+                        .h = HOST_SIM_IMAGE_SIZE,
+                        .stride = HOST_SIM_IMAGE_STRIDE,
+                },
+                .data_size = HOST_SIM_IMAGE_DATA_SIZE,
+                .data = icon_data[i],
+        };
+    }
+}
+
+// redraw the whole screen, returns the hash of the frame memory
+static uint32_t host_sim_image_refresh(lv_obj_t *box, int refreshes) {
+    lvgl_port_lock(0);
+    for (int i = 0; i < refreshes; i++) {
+        lv_obj_invalidate(box);
+        lv_refr_now(NULL);
+    }
+    lvgl_port_unlock();
+    vTaskDelay(pdMS_TO_TICKS(HOST_SIM_IMAGE_SETTLE_MS));
+    return esp_lcd_sim_hash_gram(LCD_X_GAP, LCD_Y_GAP, LCD_H_RES, LCD_V_RES);
+}
+
+// ns per decode of an icon, without the cache
+static uint32_t host_sim_image_decode_time(void) {
+    const lv_image_decoder_args_t args = {.no_cache = true};
+    lv_image_decoder_dsc_t dsc;
+    uint32_t decodes = 0;
+    lvgl_port_lock(0);
+    int64_t start = esp_timer_sim_get_host_time();
+    for (int round = 0; round < HOST_SIM_IMAGE_DECODE_ROUNDS; round++) {
+        for (int i = 0; i < HOST_SIM_IMAGE_ICONS; i++) {
+            if (lv_image_decoder_open(&dsc, &icons[i], &args) == LV_RESULT_OK) {
+                lv_image_decoder_close(&dsc);
+                decodes++;
+            }
+        }
+    }
+    int64_t elapsed = esp_timer_sim_get_host_time() - start;
+    lvgl_port_unlock();
+    return decodes ? (uint32_t) (elapsed * 1000 / decodes) : 0;
+}
+
+esp_err_t host_sim_image_benchmark(void) {
+    esp_err_t ret = ESP_OK;
+    lcd_image_cache_stats_t before;
+    lcd_image_cache_stats_t after;
+    host_sim_image_make_icons();
+
+    lvgl_port_lock(0);
+    lv_obj_t *box = lv_obj_create(lv_screen_active());
+    lv_obj_set_size(box, LCD_H_RES, LCD_V_RES);
+    lv_obj_remove_flag(box, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_style_pad_all(box, 0, LV_PART_MAIN | LV_STATE_DEFAULT);
+    lv_obj_set_style_radius(box, 0, LV_PART_MAIN | LV_STATE_DEFAULT);
+    lv_obj_set_style_border_width(box, 0, LV_PART_MAIN | LV_STATE_DEFAULT);
+    int images = 0;
+    for (int y = 0; y + HOST_SIM_IMAGE_SIZE <= LCD_V_RES; y += HOST_SIM_IMAGE_PITCH) {
+        for (int x = 0; x + HOST_SIM_IMAGE_SIZE <= LCD_H_RES; x += HOST_SIM_IMAGE_PITCH) {
+            lv_obj_t *img = lv_image_create(box);
+            lv_image_set_src(img, &icons[images % HOST_SIM_IMAGE_ICONS]);
+            lv_obj_set_style_image_recolor(img, lv_palette_main(images % LV_PALETTE_LAST), LV_PART_MAIN);
+            lv_obj_set_pos(img, x, y);
+            images++;
+        }
+    }
+    lvgl_port_unlock();
+
+    lcd_get_image_cache_stats(&before);
+    uint32_t cached_hash = host_sim_image_refresh(box, HOST_SIM_IMAGE_REFRESHES);
+    lcd_get_image_cache_stats(&after);
+    uint32_t hits = after.hits - before.hits;
+    uint32_t misses = after.misses - before.misses;
+    ESP_GOTO_ON_FALSE(hits > 0 && misses == HOST_SIM_IMAGE_ICONS && after.evictions == before.evictions, ESP_FAIL,
+                      err, TAG, "%d icons: %" PRIu32 " hits, %" PRIu32 " misses, %" PRIu32 " evictions",
+                      HOST_SIM_IMAGE_ICONS, hits, misses, after.evictions - before.evictions);
+
+    // every image decoded on every draw
+    lvgl_port_lock(0);
+    lv_image_cache_resize(0, true);
+    lvgl_port_unlock();
+    uint32_t uncached_hash = host_sim_image_refresh(box, 1);
+    lvgl_port_lock(0);
+    lv_image_cache_resize(LVGL_IMAGE_CACHE_SRAM_SIZE + LVGL_IMAGE_CACHE_PSRAM_SIZE, false);
+    lvgl_port_unlock();
+    ESP_GOTO_ON_FALSE(uncached_hash == cached_hash, ESP_FAIL, err, TAG,
+                      "the icons show differently without the image cache (0x%08" PRIx32 " vs 0x%08" PRIx32 ")",
+                      uncached_hash, cached_hash);
+
+    uint32_t decode_ns = host_sim_image_decode_time();
+    printf("image cache (icons, host time): %d images of %d icons, %d refreshes: %" PRIu32 " hits, %" PRIu32
+           " misses, %" PRIu32 " ns per decode, %" PRIu64 " us of decoding saved, %u B cached in SRAM\n", images,
+           HOST_SIM_IMAGE_ICONS, HOST_SIM_IMAGE_REFRESHES, hits, misses, decode_ns,
+           (uint64_t) hits * decode_ns / 1000, (unsigned) after.sram_bytes);
+
+err:
+    lvgl_port_lock(0);
+    lv_obj_delete(box);
+    for (int i = 0; i < HOST_SIM_IMAGE_ICONS; i++) {
+        lv_image_cache_drop(&icons[i]);
+    }
+    lvgl_port_unlock();
+    return ret;
+}
@@ -0,0 +1,11 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "esp_err.h"
+
+// redraws a screen of A4 icons (a few icons shown many times) and prints the image cache hits and misses of
+// t_display_s3_cache.c and the host time of the decodes the hits saved. ESP_FAIL if an icon was decoded more than
+// once, or the screen shows differently with the image cache disabled
+esp_err_t host_sim_image_benchmark(void);
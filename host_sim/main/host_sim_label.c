@@ -0,0 +1,163 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Label update benchmark
+//
+// lv_label_set_text_fmt() is wrapped by t_display_s3_label.c, __real_lv_label_set_text_fmt() is LVGL's. The voltage
+// and charge labels of the example UI get the same scripted battery readings (one per hw info timer period on the
+// board, repeats included) through both, once refreshing after every update to count the pixels invalidated
+// (LV_EVENT_INVALIDATE_AREA of the display) and check the panel ends up showing the same labels, and once without
+// refreshing to time the calls. The times are host times.
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <esp_log.h>
+#include <esp_check.h>
+#include <esp_timer.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_lcd_sim.h"
+#include "t_display_s3.h"
+#include "host_sim_label.h"
+
+static const char *TAG = "host_sim_label";
+
+void __real_lv_label_set_text_fmt(lv_obj_t *obj, const char *fmt, ...);
+void __wrap_lv_label_set_text_fmt(lv_obj_t *obj, const char *fmt, ...);
+
+typedef void (*host_sim_label_set_text_fmt_t)(lv_obj_t *obj, const char *fmt, ...);
+
+// time the flush pipeline gets to send a refresh
+#define HOST_SIM_LABEL_SETTLE_MS 100
+#define HOST_SIM_LABEL_ROUNDS    200
+// the labels, at the top right of the screen like the example's
+#define HOST_SIM_LABEL_X         (LCD_H_RES - 150)
+#define HOST_SIM_LABEL_W         150
+#define HOST_SIM_LABEL_H         40
+
+typedef struct {
+    int millivolts;
+    int percentage;
+} host_sim_label_reading_t;
+
+static const host_sim_label_reading_t readings[] = {
+        {4123, 92},
+        {4123, 92},
+        {4124, 92},
+        {4124, 92},
+        {4121, 92},
+        {4121, 92},
+        {4118, 91},
+        {4118, 91},
+        {4118, 91},
+        {4109, 91},
+        {4098, 90},
+        {4100, 90},
+        {4100, 90},
+        {4097, 90},
+        {4097, 89},
+        {4097, 89},
+};
+#define HOST_SIM_LABEL_UPDATES (sizeof(readings) / sizeof(readings[0]))
+
+typedef struct {
+    uint32_t areas;
+    uint64_t pixels;
+} host_sim_label_count_t;
+
+static lv_obj_t *lbl_voltage;
+static lv_obj_t *lbl_battery_pct;
+
+// called with the lvgl lock held
+static void host_sim_label_inv_cb(lv_event_t *e) {
+    host_sim_label_count_t *count = (host_sim_label_count_t *) lv_event_get_user_data(e);
+    count->areas++;
+    count->pixels += lv_area_get_size((const lv_area_t *) lv_event_get_param(e));
+}
+
+// called with the lvgl lock held
+static void host_sim_label_update(host_sim_label_set_text_fmt_t set_text_fmt,
+                                  const host_sim_label_reading_t *reading) {
+    set_text_fmt(lbl_voltage, "%d mV", reading->millivolts);
+    set_text_fmt(lbl_battery_pct, "Charge Level: %d %%", reading->percentage);
+}
+
+// every reading with a refresh after each, returns the hash of the labels on the panel
+static uint32_t host_sim_label_run(host_sim_label_set_text_fmt_t set_text_fmt, host_sim_label_count_t *count) {
+    lv_display_t *disp = lv_display_get_default();
+    lvgl_port_lock(0);
+    __real_lv_label_set_text_fmt(lbl_voltage, "%d mV", 0);
+    __real_lv_label_set_text_fmt(lbl_battery_pct, "Charge Level: %d %%", 0);
+    lv_refr_now(NULL);
+    lv_display_add_event_cb(disp, host_sim_label_inv_cb, LV_EVENT_INVALIDATE_AREA, count);
+    for (int i = 0; i < HOST_SIM_LABEL_UPDATES; i++) {
+        host_sim_label_update(set_text_fmt, &readings[i]);
+        lv_refr_now(NULL);
+    }
+    lv_display_remove_event_cb_with_user_data(disp, host_sim_label_inv_cb, count);
+    lvgl_port_unlock();
+    vTaskDelay(pdMS_TO_TICKS(HOST_SIM_LABEL_SETTLE_MS));
+    return esp_lcd_sim_hash_gram(LCD_X_GAP + HOST_SIM_LABEL_X, LCD_Y_GAP, HOST_SIM_LABEL_W, HOST_SIM_LABEL_H);
+}
+
+// ns per update of both labels, without refreshing
+static uint32_t host_sim_label_time(host_sim_label_set_text_fmt_t set_text_fmt) {
+    lvgl_port_lock(0);
+    int64_t start = esp_timer_sim_get_host_time();
+    for (int round = 0; round < HOST_SIM_LABEL_ROUNDS; round++) {
+        for (int i = 0; i < HOST_SIM_LABEL_UPDATES; i++) {
+            host_sim_label_update(set_text_fmt, &readings[i]);
+        }
+    }
+    int64_t elapsed = esp_timer_sim_get_host_time() - start;
+    lv_refr_now(NULL);
+    lvgl_port_unlock();
+    return (uint32_t) (elapsed * 1000 / (HOST_SIM_LABEL_ROUNDS * HOST_SIM_LABEL_UPDATES));
+}
+
+esp_err_t host_sim_label_benchmark(void) {
+    esp_err_t ret = ESP_OK;
+    host_sim_label_count_t real = {0};
+    host_sim_label_count_t wrap = {0};
+    lcd_label_stats_t stats_before;
+    lcd_label_stats_t stats_after;
+
+    lvgl_port_lock(0);
+    lv_obj_t *box = lv_obj_create(lv_screen_active());
+    lv_obj_set_pos(box, HOST_SIM_LABEL_X, 0);
+    lv_obj_set_size(box, HOST_SIM_LABEL_W, HOST_SIM_LABEL_H);
+    lv_obj_remove_flag(box, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_style_pad_all(box, 0, LV_PART_MAIN | LV_STATE_DEFAULT);
+    lv_obj_set_style_radius(box, 0, LV_PART_MAIN | LV_STATE_DEFAULT);
+    lv_obj_set_style_border_width(box, 0, LV_PART_MAIN | LV_STATE_DEFAULT);
+    lbl_voltage = lv_label_create(box);
+    lv_obj_align(lbl_voltage, LV_ALIGN_TOP_RIGHT, 0, 0);
+    lbl_battery_pct = lv_label_create(box);
+    lv_obj_align(lbl_battery_pct, LV_ALIGN_BOTTOM_LEFT, 0, 0);
+    lvgl_port_unlock();
+
+    uint32_t real_hash = host_sim_label_run(__real_lv_label_set_text_fmt, &real);
+    lcd_get_label_stats(&stats_before);
+    uint32_t wrap_hash = host_sim_label_run(__wrap_lv_label_set_text_fmt, &wrap);
+    lcd_get_label_stats(&stats_after);
+    ESP_GOTO_ON_FALSE(wrap_hash == real_hash, ESP_FAIL, err, TAG,
+                      "the labels show differently updated by the wrapper (0x%08" PRIx32 " vs 0x%08" PRIx32 ")",
+                      wrap_hash, real_hash);
+    ESP_GOTO_ON_FALSE(wrap.pixels <= real.pixels, ESP_FAIL, err, TAG,
+                      "the wrapper invalidated %" PRIu64 " px, LVGL %" PRIu64 " px", wrap.pixels, real.pixels);
+
+    uint32_t real_ns = host_sim_label_time(__real_lv_label_set_text_fmt);
+    uint32_t wrap_ns = host_sim_label_time(__wrap_lv_label_set_text_fmt);
+    printf("label updates (%d, 2 labels each): LVGL %" PRIu64 " px/update, wrapper %" PRIu64 " px/update (%" PRIu32
+           " skipped, %" PRIu32 " partial, %" PRIu32 " full), host time %" PRIu32 " vs %" PRIu32 " ns/update\n",
+           (int) HOST_SIM_LABEL_UPDATES, real.pixels / HOST_SIM_LABEL_UPDATES, wrap.pixels / HOST_SIM_LABEL_UPDATES,
+           stats_after.skipped_updates - stats_before.skipped_updates,
+           stats_after.partial_updates - stats_before.partial_updates,
+           stats_after.full_updates - stats_before.full_updates, real_ns, wrap_ns);
+
+err:
+    lvgl_port_lock(0);
+    lv_obj_delete(box);
+    lvgl_port_unlock();
+    return ret;
+}
@@ -0,0 +1,11 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "esp_err.h"
+
+// updates the voltage and charge labels with scripted battery readings through the label wrapper and LVGL's
+// lv_label_set_text_fmt(), prints the pixels invalidated per update and the host ns per update of both. ESP_FAIL if
+// the panel shows the labels differently after the wrapper's updates, or the wrapper invalidated more
+esp_err_t host_sim_label_benchmark(void);
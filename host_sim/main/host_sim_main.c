@@ -0,0 +1,243 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Host simulation of the T-Display S3
+//
+// Runs lcd_init() and the whole LVGL + esp_lvgl_port + tdisplays3 flush path on the linux target, against the mock
+// panel IO (which records every transfer on a simulated i80 bus), an emulated AW9364 and a scripted battery voltage.
+// With LCD_BK_LIGHT_RMT it first checks the pulse trains of every backlight step transition on the emulated AW9364.
+// Then it checks the RGB565 byte order of a few full screen colors in the simulated frame memory, checks the C
+// reference of the SIMD blend kernel check against LVGL's fill and image blend, checks the rows the row hashes send
+// and skip, checks the battery percentage against the discharge equation of its curve, drives the edge mode buttons
+// with synthetic edges, counts the areas the status labels invalidate through the old update loop and the subjects,
+// times the glyph lookups of the font tables against LVGL's, checks the glyph cache drops the glyphs of a freed font,
+// counts the pixels the label updates invalidate with and without the label wrapper and counts the image cache hits
+// of a screen of icons.
+// From lcd_init() on the main task holds the lvgl lock and runs the board in lockstep with the simulated esp_timer
+// clock (host_sim_clock.c), the checks that wait for timers included. The script below injects a synthetic button
+// press at fixed intervals through an input ring, the press handler updates a few widgets. Then it prints the
+// recorded bus time and transfers, the tdisplays3 stats, the input latency distribution of the presses and a hash of
+// the simulated frame memory, and exits.
+//
+// Refreshes, transfers and every esp_timer time (frame times, input latencies, LVGL wakeups) are simulated time: the
+// script, the timers and LVGL only run when the clock is stepped, and the bus transfers spend their time on the same
+// clock, so the numbers are the same on every host. The HOST_SIM line at the end holds the ones to compare between
+// builds, host_sim/check_baseline.py checks them against host_sim/baseline.txt. The benchmarks of the checks time
+// host code and say so (host time), the battery ADC is paced by FreeRTOS-linux, whose ticks are the host's wall
+// clock, but its samples don't depend on when it runs. Set HOST_SIM_CSV=<file> to write every recorded transfer as
+// CSV.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <esp_log.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <esp_timer.h>
+#include "esp_lcd_sim.h"
+#include "esp_adc/adc_continuous.h"
+#include "t_display_s3.h"
+#include "host_sim_aw9364.h"
+#include "host_sim_swap.h"
+#include "host_sim_blend.h"
+#include "host_sim_rowhash.h"
+#include "host_sim_battery.h"
+#include "host_sim_button.h"
+#include "host_sim_update.h"
+#include "host_sim_font.h"
+#include "host_sim_glyph.h"
+#include "host_sim_label.h"
+#include "host_sim_image.h"
+#include "host_sim_clock.h"
+
+#define TAG "host_sim"
+
+// synthetic button presses of the script, one every HOST_SIM_STEP_MS
+#define HOST_SIM_STEPS   60
+#define HOST_SIM_STEP_MS 50
+#define HOST_SIM_INPUT_RING_SIZE 8
+
+// battery voltage at the ADC pin (halved by the divider): discharging from 4.1 V to 3.6 V, then on USB power
+static const adc_sim_point_t battery_script[] = {
+        {.time_ms = 0, .millivolts = 4100 / 2},
+        {.time_ms = 2000, .millivolts = 3600 / 2},
+        {.time_ms = 2500, .millivolts = 5000 / 2},
+};
+// host time the ADC takes through the script from the start of app_main(), with the time the battery filter takes
+// to settle on the USB voltage
+#define HOST_SIM_BATTERY_SCRIPT_MS 6000
+
+static lv_obj_t *lbl_counter;
+static lv_obj_t *lbl_status;
+static lv_obj_t *bar;
+static lcd_input_ring_handle_t input_ring;
+
+static void host_sim_ui_init(void) {
+    lvgl_port_lock(0);
+    lv_obj_t *scr = lv_screen_active();
+    lbl_counter = lv_label_create(scr);
+    lv_obj_set_style_text_font(lbl_counter, &lv_font_montserrat_24, 0);
+    lv_obj_align(lbl_counter, LV_ALIGN_CENTER, 0, -30);
+    lv_label_set_text(lbl_counter, "0");
+
+    lbl_status = lv_label_create(scr);
+    lv_obj_align(lbl_status, LV_ALIGN_TOP_LEFT, 5, 5);
+    lv_label_set_text(lbl_status, "host sim");
+
+    bar = lv_bar_create(scr);
+    lv_obj_set_size(bar, 200, 16);
+    lv_obj_align(bar, LV_ALIGN_CENTER, 0, 30);
+    lv_bar_set_range(bar, 0, HOST_SIM_STEPS);
+    lvgl_port_unlock();
+}
+
+// called with the lvgl lock held
+static void host_sim_step(int step) {
+    lv_label_set_text_fmt(lbl_counter, "%d", step);
+    lv_bar_set_value(bar, step, LV_ANIM_OFF);
+    if (step % 10 == 0) {
+        lv_label_set_text_fmt(lbl_status, "step %d, brightness %d %%", step, lcd_get_brightness_pct());
+    }
+
+    if (step == 10) {
+        lcd_set_brightness_pct_fade(25, 500);
+    } else if (step == 40) {
+        lcd_set_brightness_step(16);
+    }
+}
+
+// drained right after each post under the lvgl lock, a press carries its step
+static void host_sim_input_handler(const lcd_input_event_t *events, uint32_t count, void *user_data) {
+    for (uint32_t i = 0; i < count; i++) {
+        host_sim_step(events[i].value);
+    }
+}
+
+static void host_sim_report(void) {
+    esp_lcd_sim_stats_t sim;
+    esp_lcd_sim_get_stats(&sim);
+    printf("i80 bus: %" PRIu32 " draw_bitmap, %" PRIu32 " color / %" PRIu32 " param transfers, %" PRIu64
+           " color bytes, %" PRIu64 " us simulated bus time\n", sim.draw_bitmaps, sim.color_transfers,
+           sim.param_transfers, sim.color_bytes, sim.bus_ns / 1000);
+
+    lcd_row_hash_stats_t row_hash;
+    lcd_get_row_hash_stats(&row_hash);
+    printf("row hash: %" PRIu32 " stripes, %" PRIu32 " skipped, %" PRIu64 " of %" PRIu64 " bytes saved\n",
+           row_hash.stripes, row_hash.stripes_skipped, row_hash.bytes_saved, row_hash.bytes_rendered);
+
+    lcd_label_stats_t label;
+    lcd_get_label_stats(&label);
+    printf("labels: %" PRIu32 " set_text, %" PRIu32 " skipped, %" PRIu32 " partial, %" PRIu32 " full\n",
+           label.set_text_calls, label.skipped_updates, label.partial_updates, label.full_updates);
+
+    lcd_flush_stats_t flush;
+    lcd_get_flush_stats(&flush);
+    printf("flush (simulated time): %" PRIu32 " frames, last %" PRIu32 " us\n", flush.frame_count, flush.frame_time_us);
+
+    // render threads: CONFIG_LV_DRAW_SW_DRAW_UNIT_CNT
+    lcd_trace_stats_t frame_time;
+    lcd_trace_stats_t render_time;
+    lcd_trace_get_stats(LCD_TRACE_FRAME_TIME, &frame_time);
+    lcd_trace_get_stats(LCD_TRACE_RENDER_TIME, &render_time);
+    printf("render (simulated time, %d draw units): frame time n=%" PRIu32 " p50=%" PRIu32 " p95=%" PRIu32
+           " us, area render time n=%" PRIu32 " p50=%" PRIu32 " p95=%" PRIu32 " us\n", LV_DRAW_SW_DRAW_UNIT_CNT,
+           frame_time.count, frame_time.p50_us, frame_time.p95_us, render_time.count, render_time.p50_us,
+           render_time.p95_us);
+
+    lcd_tick_stats_t tick;
+    lcd_get_tick_stats(&tick);
+    printf("lvgl task (simulated time): %" PRIu32 " wakeups/s, %" PRIu32 " requested, %" PRIu32 " tick irqs/s, %" PRIu32
+           " %% idle\n", tick.wakeups_per_s, tick.event_wakes_per_s, tick.tick_irqs_per_s, tick.idle_pct);
+
+    host_sim_aw9364_state_t aw9364;
+    host_sim_aw9364_get_state(&aw9364);
+    printf("aw9364: step %d (%" PRIu32 " uA), %" PRIu32 " step changes, %" PRIu32 " pulses (%" PRIu32 " bad)\n",
+           aw9364.step, aw9364.led_current_ua, aw9364.step_changes, aw9364.pulses, aw9364.bad_pulses);
+
+    static const char *latency_names[] = {"invalidate", "render", "flush", "photon"};
+    lcd_trace_stats_t latency;
+    for (int i = 0; i < 4; i++) {
+        lcd_trace_get_stats(LCD_TRACE_INPUT_TO_INVALIDATE + i, &latency);
+        printf("input to %s (simulated time): n=%" PRIu32 " p50=%" PRIu32 " p95=%" PRIu32 " p99=%" PRIu32 " max=%"
+               PRIu32 " us\n", latency_names[i], latency.count, latency.p50_us, latency.p95_us, latency.p99_us,
+               latency.max_us);
+    }
+
+    battery_info_t battery;
+    get_battery_info(&battery);
+    printf("battery: %d mV, %d %%, usb %d, charging %d\n", battery.millivolts, battery.percentage,
+           battery.usb_power, battery.charging);
+
+    // one line to compare between builds (host_sim/check_baseline.py), latency is the last one printed: to photon
+    printf("HOST_SIM transfers=%" PRIu32 " bytes=%" PRIu64 " bus_us=%" PRIu64 " saved=%" PRIu64 " frames=%" PRIu32
+           " photon_p95_us=%" PRIu32 " sim_ms=%" PRId64 " gram=0x%08" PRIx32 "\n", sim.color_transfers,
+           sim.color_bytes, sim.bus_ns / 1000, row_hash.bytes_saved, flush.frame_count, latency.p95_us,
+           esp_timer_get_time() / 1000, esp_lcd_sim_hash_gram(LCD_X_GAP, LCD_Y_GAP, LCD_H_RES, LCD_V_RES));
+
+    const char *csv_path = getenv("HOST_SIM_CSV");
+    if (csv_path != NULL) {
+        FILE *f = fopen(csv_path, "w");
+        if (f == NULL) {
+            ESP_LOGE(TAG, "can't write %s", csv_path);
+            return;
+        }
+        esp_lcd_sim_write_csv(f);
+        fclose(f);
+        ESP_LOGI(TAG, "transfers written to %s", csv_path);
+    }
+}
+
+void app_main(void) {
+    int64_t start_us = esp_timer_sim_get_host_time();
+    ESP_ERROR_CHECK(adc_sim_set_script(ADC_UNIT_1, ADC_CHANNEL_3, battery_script,
+                                       sizeof(battery_script) / sizeof(battery_script[0]), 10));
+
+    lv_disp_t *disp;
+    lcd_init(&disp, true);
+    // LVGL, the timers and the script run on the simulated clock from here on
+    ESP_ERROR_CHECK(host_sim_clock_start());
+    ESP_ERROR_CHECK(host_sim_aw9364_start(10));
+#if LCD_BK_LIGHT_RMT
+    // every pulse train the backlight can get, before the script
+    ESP_ERROR_CHECK(host_sim_aw9364_check());
+#endif
+    // the pixels reach the frame memory in the panel's byte order
+    ESP_ERROR_CHECK(host_sim_swap_check());
+    // the C reference the SIMD blend kernels are checked against is LVGL's
+    ESP_ERROR_CHECK(host_sim_blend_check());
+    // the rows the row hashes skip show what LVGL rendered
+    ESP_ERROR_CHECK(host_sim_rowhash_check());
+    // the battery percentage against the discharge equation
+    ESP_ERROR_CHECK(host_sim_battery_check());
+    // synthetic edges through the edge mode buttons
+    ESP_ERROR_CHECK(host_sim_button_check());
+    // the status labels through the old update loop and the subjects
+    ESP_ERROR_CHECK(host_sim_update_check());
+    // glyph lookups through the font tables against LVGL's
+    ESP_ERROR_CHECK(host_sim_font_benchmark());
+    // the glyphs of a freed font leave the glyph cache with it
+    ESP_ERROR_CHECK(host_sim_glyph_check());
+    // label updates through the label wrapper against LVGL's
+    ESP_ERROR_CHECK(host_sim_label_benchmark());
+    // an icon-heavy screen through the image cache
+    ESP_ERROR_CHECK(host_sim_image_benchmark());
+
+    host_sim_ui_init();
+    ESP_ERROR_CHECK(lcd_input_ring_create(HOST_SIM_INPUT_RING_SIZE, &input_ring));
+    for (int step = 1; step <= HOST_SIM_STEPS; step++) {
+        host_sim_clock_run_ms(HOST_SIM_STEP_MS);
+        lcd_input_post(input_ring, LCD_INPUT_BUTTON, 0, step);
+        lcd_input_drain(host_sim_input_handler, NULL, 0);
+    }
+    // let the last refresh and the fade finish
+    host_sim_clock_run_ms(500);
+    // the battery ADC runs on the host's clock, let it get past the end of its script
+    int64_t battery_left_us = HOST_SIM_BATTERY_SCRIPT_MS * 1000 - (esp_timer_sim_get_host_time() - start_us);
+    if (battery_left_us > 0) {
+        vTaskDelay(pdMS_TO_TICKS(battery_left_us / 1000) + 1);
+    }
+
+    host_sim_report();
+    fflush(stdout);
+    exit(0);
+}
@@ -0,0 +1,160 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// Row hash check
+//
+// Runs the row hashes of t_display_s3_rowhash.c in the flush pipeline against the recording panel IO: the rows sent
+// after a full screen invalidation are read from the recorded color transfers (their RASET windows), and what the
+// panel shows in the skipped rows is compared with a full resend, where lcd_row_hash_reset() made the flush task
+// forget every hash.
+
+#include <stdlib.h>
+#include <string.h>
+#include <esp_log.h>
+#include <esp_check.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_lcd_sim.h"
+#include "t_display_s3.h"
+#include "t_display_s3_priv.h"
+#include "host_sim_rowhash.h"
+
+static const char *TAG = "host_sim_rowhash";
+
+#if LCD_ROW_HASH
+
+// time the flush pipeline gets to send a refresh
+#define HOST_SIM_ROWHASH_SETTLE_MS 100
+// the recolored bar, across the screen
+#define HOST_SIM_ROWHASH_BAR_Y     60
+#define HOST_SIM_ROWHASH_BAR_H     10
+
+static void host_sim_rowhash_refresh(void) {
+    lvgl_port_lock(0);
+    lv_refr_now(NULL);
+    lvgl_port_unlock();
+    vTaskDelay(pdMS_TO_TICKS(HOST_SIM_ROWHASH_SETTLE_MS));
+}
+
+static uint32_t host_sim_rowhash_transfers(void) {
+    esp_lcd_sim_stats_t stats;
+    esp_lcd_sim_get_stats(&stats);
+    return stats.color_transfers;
+}
+
+// rows (display coordinates) of the color transfers since transfer first, false when the recorder dropped some
+static bool host_sim_rowhash_sent_rows(uint32_t first, bool *rows) {
+    memset(rows, 0, LCD_V_RES * sizeof(bool));
+    uint32_t count = host_sim_rowhash_transfers();
+    for (uint32_t i = first; i < count; i++) {
+        esp_lcd_sim_transfer_t transfer;
+        if (!esp_lcd_sim_get_transfer(i, &transfer)) {
+            return false;
+        }
+        for (int y = transfer.y1 - LCD_Y_GAP; y <= transfer.y2 - LCD_Y_GAP; y++) {
+            if (y >= 0 && y < LCD_V_RES) {
+                rows[y] = true;
+            }
+        }
+    }
+    return true;
+}
+
+static void host_sim_rowhash_read_gram(uint16_t *gram) {
+    for (int y = 0; y < LCD_V_RES; y++) {
+        for (int x = 0; x < LCD_H_RES; x++) {
+            gram[y * LCD_H_RES + x] = esp_lcd_sim_get_gram_px(LCD_X_GAP + x, LCD_Y_GAP + y);
+        }
+    }
+}
+
+esp_err_t host_sim_rowhash_check(void) {
+    esp_err_t ret = ESP_OK;
+    bool *rows = malloc(LCD_V_RES * sizeof(bool));
+    uint16_t *gram = malloc(LCD_H_RES * LCD_V_RES * sizeof(uint16_t));
+    uint16_t *reference = malloc(LCD_H_RES * LCD_V_RES * sizeof(uint16_t));
+    lv_obj_t *bar = NULL;
+    lv_obj_t *label = NULL;
+    ESP_GOTO_ON_FALSE(rows && gram && reference, ESP_ERR_NO_MEM, err, TAG, "Not enough memory for the check!");
+
+    lvgl_port_lock(0);
+    bar = lv_obj_create(lv_screen_active());
+    lv_obj_remove_style_all(bar);
+    lv_obj_set_style_bg_opa(bar, LV_OPA_COVER, 0);
+    lv_obj_set_style_bg_color(bar, lv_color_hex(0x204080), 0);
+    lv_obj_set_pos(bar, 0, HOST_SIM_ROWHASH_BAR_Y);
+    lv_obj_set_size(bar, LCD_H_RES, HOST_SIM_ROWHASH_BAR_H);
+    label = lv_label_create(lv_screen_active());
+    lv_obj_align(label, LV_ALIGN_BOTTOM_MID, 0, -10);
+    lv_label_set_text(label, "row hash check");
+    lvgl_port_unlock();
+    host_sim_rowhash_refresh();
+    // the bands drawn in parts above now hash the full rows
+    lvgl_port_lock(0);
+    lv_obj_invalidate(lv_screen_active());
+    lvgl_port_unlock();
+    host_sim_rowhash_refresh();
+
+    // everything is rendered again, only the bar's rows differ from what the panel shows
+    uint32_t first = host_sim_rowhash_transfers();
+    lvgl_port_lock(0);
+    lv_obj_set_style_bg_color(bar, lv_color_hex(0x804020), 0);
+    lv_obj_invalidate(lv_screen_active());
+    lvgl_port_unlock();
+    host_sim_rowhash_refresh();
+
+    ESP_GOTO_ON_FALSE(host_sim_rowhash_sent_rows(first, rows), ESP_FAIL, err, TAG, "transfers dropped by the recorder");
+    int band_y1 = HOST_SIM_ROWHASH_BAR_Y / LCD_ROW_HASH_ROWS * LCD_ROW_HASH_ROWS;
+    int band_y2 = (HOST_SIM_ROWHASH_BAR_Y + HOST_SIM_ROWHASH_BAR_H - 1) / LCD_ROW_HASH_ROWS * LCD_ROW_HASH_ROWS +
+                  LCD_ROW_HASH_ROWS - 1;
+    for (int y = 0; y < LCD_V_RES; y++) {
+        bool expected = y >= band_y1 && y <= band_y2;
+        ESP_GOTO_ON_FALSE(rows[y] == expected, ESP_FAIL, err, TAG, "row %d %s, the bar covers rows %d - %d", y,
+                          rows[y] ? "sent" : "skipped", HOST_SIM_ROWHASH_BAR_Y,
+                          HOST_SIM_ROWHASH_BAR_Y + HOST_SIM_ROWHASH_BAR_H - 1);
+    }
+    host_sim_rowhash_read_gram(gram);
+
+    // the same screen, every row sent
+    first = host_sim_rowhash_transfers();
+    lvgl_port_lock(0);
+    lcd_row_hash_reset();
+    lv_obj_invalidate(lv_screen_active());
+    lvgl_port_unlock();
+    host_sim_rowhash_refresh();
+
+    ESP_GOTO_ON_FALSE(host_sim_rowhash_sent_rows(first, rows), ESP_FAIL, err, TAG, "transfers dropped by the recorder");
+    for (int y = 0; y < LCD_V_RES; y++) {
+        ESP_GOTO_ON_FALSE(rows[y], ESP_FAIL, err, TAG, "row %d skipped after lcd_row_hash_reset()", y);
+    }
+    host_sim_rowhash_read_gram(reference);
+    for (int i = 0; i < LCD_H_RES * LCD_V_RES; i++) {
+        ESP_GOTO_ON_FALSE(gram[i] == reference[i], ESP_FAIL, err, TAG, "pixel (%d, %d) is 0x%04x, 0x%04x when resent",
+                          i % LCD_H_RES, i / LCD_H_RES, gram[i], reference[i]);
+    }
+    ESP_LOGI(TAG, "row hashes ok: %d of %d rows sent, the skipped rows show the screen", band_y2 - band_y1 + 1,
+             LCD_V_RES);
+
+err:
+    lvgl_port_lock(0);
+    if (bar != NULL) {
+        lv_obj_delete(bar);
+    }
+    if (label != NULL) {
+        lv_obj_delete(label);
+    }
+    lvgl_port_unlock();
+    free(rows);
+    free(gram);
+    free(reference);
+    return ret;
+}
+
+#else
+
+esp_err_t host_sim_rowhash_check(void) {
+    ESP_LOGI(TAG, "row hashes disabled (LCD_ROW_HASH), not checked");
+    return ESP_OK;
+}
+
+#endif // LCD_ROW_HASH
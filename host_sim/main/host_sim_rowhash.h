@@ -0,0 +1,12 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "esp_err.h"
+
+// LCD_ROW_HASH only: recolors a bar across the screen and invalidates the whole screen, checks that exactly the bar's
+// rows (in LCD_ROW_HASH_ROWS bands) were sent to the simulated panel, then checks the frame memory against a full
+// resend without the row hashes, the skipped rows included. Logs the first wrong row / pixel and removes the bar.
+// ESP_FAIL if any check failed
+esp_err_t host_sim_rowhash_check(void);
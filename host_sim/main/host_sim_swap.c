@@ -0,0 +1,79 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// RGB565 byte order check
+//
+// LVGL renders little-endian RGB565, the ST7789 takes the high byte of every pixel first. The simulated panel IO
+// sends the bytes the way the i80 peripheral does (swapped with swap_color_bytes) and keeps the first byte of every
+// pixel in the high byte of its frame memory, so a pixel in the frame memory equals lv_color_to_u16() of its color
+// only when exactly one of the i80 peripheral and lv_draw_sw_rgb565_swap() swapped it.
+
+#include <inttypes.h>
+#include <esp_log.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_lcd_sim.h"
+#include "t_display_s3.h"
+#include "host_sim_swap.h"
+
+static const char *TAG = "host_sim_swap";
+
+// time the flush pipeline gets to send a refresh
+#define HOST_SIM_SWAP_TIMEOUT_MS 500
+#define HOST_SIM_SWAP_POLL_MS    10
+
+// the two bytes of every color differ, a swapped pixel never matches
+static const uint32_t swap_colors[] = {0xff0000, 0x00ff00, 0x0000ff, 0x1040a0};
+
+// first visible pixel that isn't expected, false when all are
+static bool host_sim_swap_find_wrong_px(uint16_t expected, int *x, int *y, uint16_t *px) {
+    for (int row = 0; row < LCD_V_RES; row++) {
+        for (int col = 0; col < LCD_H_RES; col++) {
+            uint16_t value = esp_lcd_sim_get_gram_px(LCD_X_GAP + col, LCD_Y_GAP + row);
+            if (value != expected) {
+                *x = col;
+                *y = row;
+                *px = value;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+esp_err_t host_sim_swap_check(void) {
+    esp_err_t ret = ESP_OK;
+
+    for (size_t i = 0; i < sizeof(swap_colors) / sizeof(swap_colors[0]); i++) {
+        lv_color_t color = lv_color_hex(swap_colors[i]);
+        uint16_t expected = lv_color_to_u16(color);
+
+        lvgl_port_lock(0);
+        lv_obj_set_style_bg_color(lv_screen_active(), color, 0);
+        lv_refr_now(NULL);
+        lvgl_port_unlock();
+
+        // the last stripes are sent by the flush task after lv_refr_now() returns
+        int x = 0;
+        int y = 0;
+        uint16_t px = 0;
+        bool wrong = true;
+        for (int waited_ms = 0; waited_ms <= HOST_SIM_SWAP_TIMEOUT_MS && wrong; waited_ms += HOST_SIM_SWAP_POLL_MS) {
+            vTaskDelay(pdMS_TO_TICKS(HOST_SIM_SWAP_POLL_MS));
+            wrong = host_sim_swap_find_wrong_px(expected, &x, &y, &px);
+        }
+        if (wrong) {
+            ESP_LOGE(TAG, "color 0x%06" PRIx32 ": pixel (%d, %d) is 0x%04x, expected 0x%04x", swap_colors[i], x, y,
+                     px, expected);
+            ret = ESP_FAIL;
+        }
+    }
+
+    lvgl_port_lock(0);
+    lv_obj_remove_local_style_prop(lv_screen_active(), LV_STYLE_BG_COLOR, 0);
+    lvgl_port_unlock();
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "RGB565 byte order ok (LCD_I80_SWAP_COLOR_BYTES %d)", LCD_I80_SWAP_COLOR_BYTES);
+    }
+    return ret;
+}
@@ -0,0 +1,12 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "esp_err.h"
+
+// fills the screen with a few colors and checks every visible pixel of the simulated frame memory holds the color's
+// RGB565 value in the ST7789's big-endian byte order, whichever of the i80 peripheral (LCD_I80_SWAP_COLOR_BYTES) or
+// lv_draw_sw_rgb565_swap() swaps the bytes. Logs the first wrong pixel of each color and restores the screen.
+// ESP_FAIL if any color was wrong
+esp_err_t host_sim_swap_check(void);
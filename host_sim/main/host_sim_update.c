@@ -0,0 +1,280 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+// UI update path check
+//
+// The status labels of main/main.c fed the same scripted hw readings (one every HOST_SIM_UPDATE_TICK_MS, the period of
+// its hw info timer) through the two update paths, counting the areas LVGL gets invalidated (LV_EVENT_INVALIDATE_AREA
+// of the display) per second:
+//  - before: the old ui_update_task, update_ui() in a loop re-setting every label with LVGL's own lv_label_set_text()
+//    (the __real_ one, without the label wrapper of t_display_s3_label.c),
+//  - after: the readings published to lv_subject_t subjects the labels are bound to, only when they changed.
+// A tick whose readings didn't change must invalidate nothing after, and both paths must end with the same texts.
+// The loop spins on the host's clock, so its rate and the before numbers are host time, the ticks of after are
+// simulated.
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <esp_log.h>
+#include <esp_check.h>
+#include <esp_timer.h>
+#include "t_display_s3.h"
+#include "host_sim_clock.h"
+#include "host_sim_update.h"
+
+static const char *TAG = "host_sim_update";
+
+#define HOST_SIM_UPDATE_TICK_MS 250
+
+void __real_lv_label_set_text(lv_obj_t *obj, const char *text);
+void __real_lv_label_set_text_fmt(lv_obj_t *obj, const char *fmt, ...);
+
+typedef struct {
+    int32_t millivolts;
+    int32_t percentage;
+    int32_t usb_power;
+    int32_t brightness;
+} host_sim_update_reading_t;
+
+// a discharging battery, repeated readings, then USB power
+static const host_sim_update_reading_t readings[] = {
+        {4123, 92, 0, 16},
+        {4121, 92, 0, 16},
+        {4121, 92, 0, 16},
+        {4118, 91, 0, 15},
+        {4118, 91, 0, 15},
+        {4977, 100, 1, 15},
+        {4998, 100, 1, 15},
+        {4998, 100, 1, 15},
+};
+#define HOST_SIM_UPDATE_TICKS (sizeof(readings) / sizeof(readings[0]))
+
+static const char *battery_symbols[5] = {
+        LV_SYMBOL_BATTERY_EMPTY,
+        LV_SYMBOL_BATTERY_1,
+        LV_SYMBOL_BATTERY_2,
+        LV_SYMBOL_BATTERY_3,
+        LV_SYMBOL_BATTERY_FULL
+};
+
+typedef struct {
+    lv_obj_t *top_bar;
+    lv_obj_t *lbl_power_mode;
+    lv_obj_t *lbl_battery_pct;
+    lv_obj_t *lbl_voltage;
+    lv_obj_t *lbl_power_icon;
+    lv_obj_t *slider;
+} host_sim_update_ui_t;
+
+typedef struct {
+    uint32_t areas;
+    uint64_t pixels;
+} host_sim_update_count_t;
+
+static host_sim_update_ui_t ui;
+static lv_subject_t voltage_subject;
+static lv_subject_t pct_subject;
+static lv_subject_t usb_power_subject;
+static lv_subject_t brightness_subject;
+
+// called with the lvgl lock held
+static void host_sim_update_inv_cb(lv_event_t *e) {
+    host_sim_update_count_t *count = (host_sim_update_count_t *) lv_event_get_user_data(e);
+    const lv_area_t *area = (const lv_area_t *) lv_event_get_param(e);
+    count->areas++;
+    count->pixels += lv_area_get_size(area);
+}
+
+static host_sim_update_count_t host_sim_update_get_count(host_sim_update_count_t *count) {
+    lvgl_port_lock(0);
+    host_sim_update_count_t copy = *count;
+    lvgl_port_unlock();
+    return copy;
+}
+
+static int host_sim_update_symbol_idx(int percentage) {
+    if (percentage > 75) {
+        return 4;
+    } else if (percentage > 50) {
+        return 3;
+    } else if (percentage > 25) {
+        return 2;
+    } else if (percentage > 10) {
+        return 1;
+    }
+    return 0;
+}
+
+// the layout of main.c's ui_init(), called with the lvgl lock held
+static void host_sim_update_ui_create(void) {
+    ui.top_bar = lv_obj_create(lv_screen_active());
+    lv_obj_align(ui.top_bar, LV_ALIGN_TOP_RIGHT, 0, 0);
+    lv_obj_set_size(ui.top_bar, LCD_H_RES - 50, 50);
+    lv_obj_remove_flag(ui.top_bar, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_set_style_radius(ui.top_bar, 0, LV_PART_MAIN | LV_STATE_DEFAULT);
+    lv_obj_set_style_border_width(ui.top_bar, 0, LV_PART_MAIN | LV_STATE_DEFAULT);
+    lv_obj_set_style_bg_opa(ui.top_bar, 0, LV_PART_MAIN | LV_STATE_DEFAULT);
+
+    ui.lbl_power_mode = lv_label_create(ui.top_bar);
+    lv_obj_align(ui.lbl_power_mode, LV_ALIGN_TOP_LEFT, 0, 0);
+    ui.lbl_voltage = lv_label_create(ui.top_bar);
+    lv_obj_align(ui.lbl_voltage, LV_ALIGN_TOP_RIGHT, 0, 0);
+    ui.lbl_power_icon = lv_label_create(ui.top_bar);
+    lv_obj_align(ui.lbl_power_icon, LV_ALIGN_BOTTOM_RIGHT, 0, 5);
+    ui.lbl_battery_pct = lv_label_create(ui.top_bar);
+    lv_obj_align(ui.lbl_battery_pct, LV_ALIGN_BOTTOM_LEFT, 0, 5);
+
+    ui.slider = lv_slider_create(lv_screen_active());
+    lv_obj_set_size(ui.slider, LCD_H_RES - 100, 25);
+    lv_obj_align(ui.slider, LV_ALIGN_CENTER, 30, 0);
+    lv_slider_set_range(ui.slider, 0, 16);
+}
+
+static void host_sim_update_ui_delete(void) {
+    lvgl_port_lock(0);
+    lv_obj_delete(ui.top_bar);
+    lv_obj_delete(ui.slider);
+    lvgl_port_unlock();
+}
+
+// the old update_ui(), called with the lvgl lock held
+static void host_sim_update_before(const host_sim_update_reading_t *reading) {
+    lv_slider_set_value(ui.slider, reading->brightness, LV_ANIM_OFF);
+    if (reading->usb_power) {
+        __real_lv_label_set_text(ui.lbl_power_mode, "USB Power");
+        __real_lv_label_set_text(ui.lbl_battery_pct, "----------");
+        __real_lv_label_set_text(ui.lbl_power_icon, LV_SYMBOL_USB);
+    } else {
+        __real_lv_label_set_text(ui.lbl_power_mode, "Battery Power");
+        __real_lv_label_set_text_fmt(ui.lbl_battery_pct, "Charge Level: %d %%", (int) reading->percentage);
+        __real_lv_label_set_text(ui.lbl_power_icon, battery_symbols[host_sim_update_symbol_idx(reading->percentage)]);
+    }
+    __real_lv_label_set_text_fmt(ui.lbl_voltage, "%d mV", (int) reading->millivolts);
+}
+
+// main.c's power_state_observer_cb()
+static void host_sim_update_power_observer_cb(lv_observer_t *observer, lv_subject_t *subject) {
+    int percentage = lv_subject_get_int(&pct_subject);
+    if (lv_subject_get_int(&usb_power_subject)) {
+        lv_label_set_text(ui.lbl_power_mode, "USB Power");
+        lv_label_set_text(ui.lbl_battery_pct, "----------");
+        lv_label_set_text(ui.lbl_power_icon, LV_SYMBOL_USB);
+    } else {
+        lv_label_set_text(ui.lbl_power_mode, "Battery Power");
+        lv_label_set_text_fmt(ui.lbl_battery_pct, "Charge Level: %d %%", percentage);
+        lv_label_set_text(ui.lbl_power_icon, battery_symbols[host_sim_update_symbol_idx(percentage)]);
+    }
+}
+
+// called with the lvgl lock held
+static void host_sim_update_bind(const host_sim_update_reading_t *reading) {
+    lv_subject_init_int(&voltage_subject, reading->millivolts);
+    lv_subject_init_int(&pct_subject, reading->percentage);
+    lv_subject_init_int(&usb_power_subject, reading->usb_power);
+    lv_subject_init_int(&brightness_subject, reading->brightness);
+    lv_label_bind_text(ui.lbl_voltage, &voltage_subject, "%d mV");
+    lv_slider_bind_value(ui.slider, &brightness_subject);
+    lv_subject_add_observer_obj(&pct_subject, host_sim_update_power_observer_cb, ui.top_bar, NULL);
+    lv_subject_add_observer_obj(&usb_power_subject, host_sim_update_power_observer_cb, ui.top_bar, NULL);
+}
+
+static void host_sim_update_set_if_changed(lv_subject_t *subject, int32_t value) {
+    if (lv_subject_get_int(subject) != value) {
+        lv_subject_set_int(subject, value);
+    }
+}
+
+// input_event_handler() of main.c, called with the lvgl lock held
+static void host_sim_update_after(const host_sim_update_reading_t *reading) {
+    host_sim_update_set_if_changed(&voltage_subject, reading->millivolts);
+    host_sim_update_set_if_changed(&pct_subject, reading->percentage);
+    host_sim_update_set_if_changed(&usb_power_subject, reading->usb_power);
+    host_sim_update_set_if_changed(&brightness_subject, reading->brightness);
+}
+
+// texts of the labels, with the lvgl lock held
+static void host_sim_update_get_texts(char *texts, size_t size) {
+    snprintf(texts, size, "%s|%s|%s|%s|%" PRId32, lv_label_get_text(ui.lbl_power_mode),
+             lv_label_get_text(ui.lbl_battery_pct), lv_label_get_text(ui.lbl_voltage),
+             lv_label_get_text(ui.lbl_power_icon), lv_slider_get_value(ui.slider));
+}
+
+esp_err_t host_sim_update_check(void) {
+    esp_err_t ret = ESP_OK;
+    lv_display_t *disp = lv_display_get_default();
+    host_sim_update_count_t before = {0};
+    host_sim_update_count_t after = {0};
+    char before_texts[128];
+    char after_texts[128];
+    int64_t run_us = HOST_SIM_UPDATE_TICKS * HOST_SIM_UPDATE_TICK_MS * 1000;
+
+    // before: the spinning update_ui() loop, the readings change every tick
+    lvgl_port_lock(0);
+    host_sim_update_ui_create();
+    host_sim_update_before(&readings[0]);
+    lv_refr_now(NULL);
+    lv_display_add_event_cb(disp, host_sim_update_inv_cb, LV_EVENT_INVALIDATE_AREA, &before);
+    lvgl_port_unlock();
+    uint32_t cycles = 0;
+    int64_t start_us = esp_timer_sim_get_host_time();
+    int64_t elapsed_us = 0;
+    while (elapsed_us < run_us) {
+        lvgl_port_lock(0);
+        host_sim_update_before(&readings[elapsed_us / (HOST_SIM_UPDATE_TICK_MS * 1000)]);
+        lvgl_port_unlock();
+        cycles++;
+        elapsed_us = esp_timer_sim_get_host_time() - start_us;
+    }
+    lvgl_port_lock(0);
+    lv_display_remove_event_cb_with_user_data(disp, host_sim_update_inv_cb, &before);
+    host_sim_update_before(&readings[HOST_SIM_UPDATE_TICKS - 1]);
+    host_sim_update_get_texts(before_texts, sizeof(before_texts));
+    lvgl_port_unlock();
+    host_sim_update_ui_delete();
+
+    // after: one publish per tick, like the hw info timer
+    lvgl_port_lock(0);
+    host_sim_update_ui_create();
+    host_sim_update_bind(&readings[0]);
+    lv_refr_now(NULL);
+    lv_display_add_event_cb(disp, host_sim_update_inv_cb, LV_EVENT_INVALIDATE_AREA, &after);
+    lvgl_port_unlock();
+    for (int tick = 1; tick < HOST_SIM_UPDATE_TICKS; tick++) {
+        host_sim_clock_run_ms(HOST_SIM_UPDATE_TICK_MS);
+        host_sim_update_count_t last = host_sim_update_get_count(&after);
+        lvgl_port_lock(0);
+        host_sim_update_after(&readings[tick]);
+        lvgl_port_unlock();
+        host_sim_update_count_t count = host_sim_update_get_count(&after);
+        bool changed = memcmp(&readings[tick], &readings[tick - 1], sizeof(host_sim_update_reading_t)) != 0;
+        ESP_GOTO_ON_FALSE(changed == (count.areas > last.areas), ESP_FAIL, err, TAG,
+                          "tick %d: readings %s, %" PRIu32 " areas invalidated", tick,
+                          changed ? "changed" : "unchanged", count.areas - last.areas);
+    }
+    host_sim_clock_run_ms(HOST_SIM_UPDATE_TICK_MS);
+    lvgl_port_lock(0);
+    host_sim_update_get_texts(after_texts, sizeof(after_texts));
+    lvgl_port_unlock();
+    ESP_GOTO_ON_FALSE(strcmp(before_texts, after_texts) == 0, ESP_FAIL, err, TAG, "texts differ: \"%s\" vs \"%s\"",
+                      before_texts, after_texts);
+
+    after = host_sim_update_get_count(&after);
+    printf("ui update (host time): update_ui() loop %" PRIu64 " areas/s (%" PRIu64 " px/s, %" PRIu64 " loops/s), "
+           "subjects %" PRIu64 " areas/s (%" PRIu64 " px/s)\n", (uint64_t) before.areas * 1000000 / elapsed_us,
+           before.pixels * 1000000 / elapsed_us, (uint64_t) cycles * 1000000 / elapsed_us,
+           (uint64_t) after.areas * 1000000 / run_us, after.pixels * 1000000 / run_us);
+
+err:
+    lvgl_port_lock(0);
+    lv_display_remove_event_cb_with_user_data(disp, host_sim_update_inv_cb, &after);
+    lvgl_port_unlock();
+    host_sim_update_ui_delete();
+    lvgl_port_lock(0);
+    lv_subject_deinit(&voltage_subject);
+    lv_subject_deinit(&pct_subject);
+    lv_subject_deinit(&usb_power_subject);
+    lv_subject_deinit(&brightness_subject);
+    lvgl_port_unlock();
+    return ret;
+}
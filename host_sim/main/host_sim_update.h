@@ -0,0 +1,11 @@
+// SPDX-FileCopyrightText: © 2025 Hiruna Wijesinghe <hiruna.kawinda@gmail.com>
+// SPDX-License-Identifier: MIT
+
+#pragma once
+
+#include "esp_err.h"
+
+// feeds scripted hw readings to main.c's status labels through the old update_ui() loop and through lv_subject_t
+// subjects, prints the areas invalidated per second of each. ESP_FAIL if a tick with unchanged readings invalidated
+// anything (or a changed one nothing) on the subjects, or the two paths end with different texts
+esp_err_t host_sim_update_check(void);
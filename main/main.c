@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: MIT
 
 #include <stdio.h>
+#include <inttypes.h>
 #include <esp_log.h>
 #include <esp_timer.h>
 #include <math.h>
@@ -9,8 +10,7 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "t_display_s3.h"
-#include "iot_button.h"
-#include "button_gpio.h"
+#include "t_display_s3_button.h"
 
 
 #if defined CONFIG_LV_USE_DEMO_BENCHMARK
@@ -21,6 +21,20 @@
 
 #define TAG "ESP-IDF-T-Display-S3-Example"
 
+// time full screen flushes over the bounce buffer chunk sizes at start up (lcd_flush_benchmark_sweep)
+#define RUN_FLUSH_BENCHMARK 0
+
+// time the SIMD fill / image blend kernels against LVGL's C path at start up (lcd_blend_benchmark)
+#define RUN_BLEND_BENCHMARK 0
+
+// drive the brightness slider with the buttons as an LVGL encoder (lcd_add_navigation_buttons), button 2 is prev,
+// button 1 next and a long press enter, holding a button still steps the brightness through input_ring. 0: the button
+// callbacks post to input_ring and ui_update_task sets the brightness, the old path, to compare the logged input
+// latency with
+#define UI_NAVIGATION_BUTTONS 1
+// period of the input latency and heap log
+#define INPUT_LATENCY_LOG_MS 10000
+
 #define NUM_BUTTONS 2
 
 // gpio nums of the buttons
@@ -32,14 +46,20 @@ static gpio_num_t btn_gpio_nums[NUM_BUTTONS] = {
 // store button handles
 button_handle_t btn_handles[NUM_BUTTONS];
 
-// used for setup_test_ui() function
-char *power_icon = LV_SYMBOL_POWER;
-char *lbl_btn_1_value = "";
-char *lbl_btn_2_value = "";
-int battery_voltage;
-int battery_percentage;
-bool on_usb_power = false;
-int current_battery_symbol_idx = 0;
+// the button callbacks and the hw info timer run in the esp_timer task, the single producer of input_ring,
+// ui_update_task drains it under the lvgl lock
+static lcd_input_ring_handle_t input_ring;
+#define INPUT_RING_SIZE 32
+
+// hw readings posted as LCD_INPUT_READING events
+enum {
+    HW_READING_MILLIVOLTS,
+    HW_READING_PERCENTAGE,
+    HW_READING_USB_POWER,
+    HW_READING_BRIGHTNESS,
+    HW_READING_MAX,
+};
+
 char *battery_symbols[5] = {
         LV_SYMBOL_BATTERY_EMPTY,
         LV_SYMBOL_BATTERY_1,
@@ -50,6 +70,15 @@ char *battery_symbols[5] = {
 
 TaskHandle_t lcd_brightness_task_hdl;
 esp_timer_handle_t lcd_brightness_timer_hdl;
+TaskHandle_t ui_update_task_hdl;
+
+// lvgl subjects, observers only get notified (and labels only re-set) when a value actually changes
+static lv_subject_t btn_1_symbol_subject;
+static lv_subject_t btn_2_symbol_subject;
+static lv_subject_t brightness_step_subject;
+static lv_subject_t battery_voltage_subject;
+static lv_subject_t battery_pct_subject;
+static lv_subject_t usb_power_subject;
 
 // lvgl ui elements
 lv_obj_t *side_bar;
@@ -73,37 +102,21 @@ static int get_button_idx(button_handle_t btn_hdl) {
     return -1;
 }
 
-// Callback function when buttons are released
+// Callback function when buttons are released, runs in the esp_timer task: only queue the event for the ui
 static void button_event_handler_cb(void *arg, void *usr_data) {
     button_handle_t button_hdl = (button_handle_t) arg;
-    button_event_t btn_event = iot_button_get_event(button_hdl);
     int btn_idx = get_button_idx(button_hdl);
-
-    ESP_LOGI(TAG, "button %d, event %s", btn_idx, iot_button_get_event_str(btn_event));
-    switch (btn_event) {
-        case BUTTON_PRESS_DOWN:
-        case BUTTON_LONG_PRESS_START:
-        case BUTTON_LONG_PRESS_HOLD:
-            if(btn_idx == 0) {
-                lbl_btn_1_value = LV_SYMBOL_LEFT;
-                lcd_increment_brightness_step();
-            }
-            if(btn_idx == 1) {
-                lbl_btn_2_value = LV_SYMBOL_LEFT;
-                lcd_decrement_brightness_step();
-            }
-            break;
-        default:
-            if(btn_idx == 0) {
-                lbl_btn_1_value = "";;
-            }
-            if(btn_idx == 1) {
-                lbl_btn_2_value = "";;
-            }
+    if (btn_idx < 0) {
+        return;
     }
+    button_event_t event = iot_button_get_event(button_hdl);
+    // a press is timestamped at its gpio edge, so the input latency covers the debounce too
+    int64_t time_us = event == BUTTON_PRESS_DOWN ? button_edge_take_press_time_us(button_hdl) : esp_timer_get_time();
+    lcd_input_post_at(input_ring, LCD_INPUT_BUTTON, btn_idx, event, time_us);
 }
 
-// Function to configure the boo & GPIO14 buttons using espressif/button component
+// Function to configure the boo & GPIO14 buttons using espressif/button component,
+// in edge mode the button timer only runs while a button is pressed
 static void setup_buttons() {
     for (size_t i = 0; i < NUM_BUTTONS; i++) {
         ESP_LOGI(TAG, "Configuring button %ld", ((int32_t) i) + 1);
@@ -113,13 +126,15 @@ static void setup_buttons() {
                 .active_level = 0,
         };
         button_handle_t btn_handle;
-        esp_err_t err = iot_button_new_gpio_device(&btn_cfg, &btn_gpio_cfg, &btn_handle);
+        esp_err_t err = button_edge_new_gpio_device(&btn_cfg, &btn_gpio_cfg, &btn_handle);
         if (err != ESP_OK) {
-            ESP_LOGE(TAG, "error iot_button_new_gpio_device [button %d]: %s", i + 1, esp_err_to_name(err));
+            ESP_LOGE(TAG, "error button_edge_new_gpio_device [button %d]: %s", i + 1, esp_err_to_name(err));
         }
         if (NULL == btn_handle) {
             ESP_LOGE(TAG, "Button %d create failed", i + 1);
         }
+        btn_handles[i] = btn_handle;
+#if !UI_NAVIGATION_BUTTONS
         err = iot_button_register_cb(btn_handle, BUTTON_PRESS_DOWN, NULL, button_event_handler_cb, NULL);
         if (err != ESP_OK) {
             ESP_LOGE(TAG, "error iot_button_register_cb [button %d]: %s", i + 1, esp_err_to_name(err));
@@ -137,15 +152,78 @@ static void setup_buttons() {
         if (err != ESP_OK) {
             ESP_LOGE(TAG, "error iot_button_register_cb [button %d]: %s", i + 1, esp_err_to_name(err));
         }
+#endif
+        // holding a button keeps stepping the brightness, on the encoder too
         err = iot_button_register_cb(btn_handle, BUTTON_LONG_PRESS_HOLD, NULL, button_event_handler_cb, NULL);
         if (err != ESP_OK) {
             ESP_LOGE(TAG, "error iot_button_register_cb [button %d]: %s", i + 1, esp_err_to_name(err));
         }
-        btn_handles[i] = btn_handle;
     }
 }
 
 
+static int get_battery_symbol_idx(int percentage) {
+    if (percentage > 75) {
+        return 4;
+    } else if (percentage > 50) {
+        return 3;
+    } else if (percentage > 25) {
+        return 2;
+    } else if (percentage > 10) {
+        return 1;
+    }
+    return 0;
+}
+
+// observer for the battery percentage and usb power subjects, updates the power mode, charge level and icon labels
+static void power_state_observer_cb(lv_observer_t *observer, lv_subject_t *subject) {
+    int percentage = lv_subject_get_int(&battery_pct_subject);
+    if (percentage > 100) {
+        percentage = 100;
+    }
+
+    if (lv_subject_get_int(&usb_power_subject)) {
+        lv_label_set_text(lbl_power_mode, "USB Power");
+        lv_label_set_text(lbl_battery_pct, "----------");
+        lv_label_set_text(lbl_power_icon, LV_SYMBOL_USB);
+    } else {
+        lv_label_set_text(lbl_power_mode, "Battery Power");
+        lv_label_set_text_fmt(lbl_battery_pct, "Charge Level: %d %%", percentage);
+        lv_label_set_text(lbl_power_icon, battery_symbols[get_battery_symbol_idx(percentage)]);
+    }
+}
+
+static void subject_set_int_if_changed(lv_subject_t *subject, int32_t value) {
+    if (lv_subject_get_int(subject) != value) {
+        lv_subject_set_int(subject, value);
+    }
+}
+
+static void subject_set_pointer_if_changed(lv_subject_t *subject, void *ptr) {
+    if (lv_subject_get_pointer(subject) != ptr) {
+        lv_subject_set_pointer(subject, ptr);
+    }
+}
+
+#if UI_NAVIGATION_BUTTONS
+// the encoder changed the slider, runs in the lvgl task
+static void brightness_slider_event_cb(lv_event_t *e) {
+    lv_obj_t *slider = lv_event_get_target_obj(e);
+    if (lv_event_get_code(e) == LV_EVENT_KEY) {
+        uint32_t key = lv_event_get_key(e);
+        if (key != LV_KEY_LEFT && key != LV_KEY_RIGHT) {
+            // the enter of a long press, the hold steps are shown by handle_button_event
+            return;
+        }
+        bool next = key == LV_KEY_RIGHT;
+        subject_set_pointer_if_changed(&btn_1_symbol_subject, next ? LV_SYMBOL_LEFT : "");
+        subject_set_pointer_if_changed(&btn_2_symbol_subject, next ? "" : LV_SYMBOL_LEFT);
+        return;
+    }
+    lcd_set_brightness_step(lv_slider_get_value(slider));
+}
+#endif
+
 void ui_init() {
     side_bar = lv_obj_create(lv_screen_active());
     lv_obj_set_width(side_bar, 50);
@@ -199,49 +277,138 @@ void ui_init() {
     screen_brightness = lv_label_create(screen_brightness_slider);
     lv_obj_align(screen_brightness, LV_ALIGN_CENTER, 0, 0);
     lv_label_set_text(screen_brightness, "Brightness");
-    lv_slider_set_value(screen_brightness_slider, lcd_get_brightness_step(), LV_ANIM_OFF);
+
+    // bind the ui elements to the subjects
+    battery_info_t battery_info;
+    get_battery_info(&battery_info);
+    lv_subject_init_pointer(&btn_1_symbol_subject, "");
+    lv_subject_init_pointer(&btn_2_symbol_subject, "");
+    lv_subject_init_int(&brightness_step_subject, lcd_get_brightness_step());
+    lv_subject_init_int(&battery_voltage_subject, battery_info.millivolts);
+    lv_subject_init_int(&battery_pct_subject, battery_info.percentage);
+    lv_subject_init_int(&usb_power_subject, battery_info.usb_power);
+
+    lv_label_bind_text(lbl_btn_1, &btn_1_symbol_subject, NULL);
+    lv_label_bind_text(lbl_btn_2, &btn_2_symbol_subject, NULL);
+    lv_label_bind_text(lbl_voltage, &battery_voltage_subject, "%d mV");
+    lv_slider_bind_value(screen_brightness_slider, &brightness_step_subject);
+    lv_subject_add_observer_obj(&battery_pct_subject, power_state_observer_cb, top_bar, NULL);
+    lv_subject_add_observer_obj(&usb_power_subject, power_state_observer_cb, top_bar, NULL);
+
+#if UI_NAVIGATION_BUTTONS
+    // the slider is the only object of the group, left / right change it right away
+    lv_group_t *group = lv_group_create();
+    lv_group_add_obj(group, screen_brightness_slider);
+    lv_group_set_editing(group, true);
+    lv_obj_add_event_cb(screen_brightness_slider, brightness_slider_event_cb, LV_EVENT_KEY, NULL);
+    lv_obj_add_event_cb(screen_brightness_slider, brightness_slider_event_cb, LV_EVENT_VALUE_CHANGED, NULL);
+    lv_indev_t *nav = lcd_add_navigation_buttons(lv_display_get_default(), btn_handles[1], btn_handles[0]);
+    if (nav != NULL) {
+        lv_indev_set_group(nav, group);
+    }
+#endif
 }
 
 static void update_hw_info_timer_cb(void *arg) {
-    battery_voltage = get_battery_voltage();
-    on_usb_power = usb_power_voltage(battery_voltage);
-    battery_percentage = (int) volts_to_percentage((double) battery_voltage / 1000);
+    // last posted readings, only changes are queued for the ui
+    static int32_t posted[HW_READING_MAX] = {-1, -1, -1, -1};
+
+    // one consistent snapshot of the filtered battery reading, this doesn't touch the ADC
+    battery_info_t battery_info;
+    get_battery_info(&battery_info);
+    int32_t readings[HW_READING_MAX] = {
+            [HW_READING_MILLIVOLTS] = battery_info.millivolts,
+            [HW_READING_PERCENTAGE] = battery_info.percentage,
+            [HW_READING_USB_POWER] = battery_info.usb_power,
+            [HW_READING_BRIGHTNESS] = lcd_get_brightness_step(),
+    };
+    for (int i = 0; i < HW_READING_MAX; i++) {
+        if (readings[i] != posted[i] && lcd_input_post(input_ring, LCD_INPUT_READING, i, readings[i])) {
+            posted[i] = readings[i];
+        }
+    }
 }
 
-static void update_ui() {
-    lv_label_set_text(lbl_btn_1, lbl_btn_1_value);
-    lv_label_set_text(lbl_btn_2, lbl_btn_2_value);
-    lv_slider_set_value(screen_brightness_slider, lcd_get_brightness_step(), LV_ANIM_OFF);
-    if (on_usb_power) {
-        power_icon = LV_SYMBOL_USB;
-        lv_label_set_text(lbl_power_mode, "USB Power");
-        lv_label_set_text(lbl_battery_pct, "----------");
-    } else {
-        power_icon = battery_symbols[current_battery_symbol_idx];
-        if (battery_percentage > 100) {
-            battery_percentage = 100;
+// lv_subject_set_* always notifies the observers, so only publish values that changed
+static void handle_button_event(int btn_idx, button_event_t btn_event) {
+    ESP_LOGD(TAG, "button %d, event %s", btn_idx, iot_button_get_event_str(btn_event));
+    lv_subject_t *symbol_subject = btn_idx == 0 ? &btn_1_symbol_subject : &btn_2_symbol_subject;
+    switch (btn_event) {
+        case BUTTON_PRESS_DOWN:
+        case BUTTON_LONG_PRESS_START:
+        case BUTTON_LONG_PRESS_HOLD:
+            subject_set_pointer_if_changed(symbol_subject, LV_SYMBOL_LEFT);
+            if (btn_idx == 0) {
+                lcd_increment_brightness_step();
+            } else {
+                lcd_decrement_brightness_step();
+            }
+            subject_set_int_if_changed(&brightness_step_subject, lcd_get_brightness_step());
+            break;
+        default:
+            subject_set_pointer_if_changed(symbol_subject, "");
+    }
+}
+
+// runs in ui_update_task under the lvgl lock, with a batch of events from the producers
+static void input_event_handler(const lcd_input_event_t *events, uint32_t count, void *user_data) {
+    for (uint32_t i = 0; i < count; i++) {
+        const lcd_input_event_t *event = &events[i];
+        if (event->type == LCD_INPUT_BUTTON) {
+            handle_button_event(event->id, (button_event_t) event->value);
+            continue;
+        }
+        switch (event->id) {
+            case HW_READING_MILLIVOLTS:
+                subject_set_int_if_changed(&battery_voltage_subject, event->value);
+                break;
+            case HW_READING_PERCENTAGE:
+                subject_set_int_if_changed(&battery_pct_subject, event->value);
+                break;
+            case HW_READING_USB_POWER:
+                subject_set_int_if_changed(&usb_power_subject, event->value);
+                break;
+            case HW_READING_BRIGHTNESS:
+                subject_set_int_if_changed(&brightness_step_subject, event->value);
+                break;
         }
-        lv_label_set_text(lbl_power_mode, "Battery Power");
-        lv_label_set_text_fmt(lbl_battery_pct, "Charge Level: %d %%", battery_percentage);
     }
-    lv_label_set_text_fmt(lbl_voltage, "%d mV", battery_voltage);
+}
 
 
-    if (battery_percentage > 75 && battery_percentage <= 100) {
-        current_battery_symbol_idx = 4;
-    } else if (battery_percentage > 50 && battery_percentage <= 75) {
-        current_battery_symbol_idx = 3;
-    } else if (battery_percentage > 25 && battery_percentage <= 50) {
-        current_battery_symbol_idx = 2;
-    } else if (battery_percentage > 10 && battery_percentage <= 25) {
-        current_battery_symbol_idx = 1;
-    } else {
-        current_battery_symbol_idx = 0;
+// log the distribution of the button press to panel latency
+static void log_input_latency(void) {
+    lcd_trace_stats_t stats;
+    if (lcd_trace_get_stats(LCD_TRACE_INPUT_TO_PHOTON, &stats) != ESP_OK || stats.count == 0) {
+        return;
     }
-
-    lv_label_set_text(lbl_power_icon, power_icon);
+    ESP_LOGI(TAG, "input to photon (%s): n=%" PRIu32 " p50=%" PRIu32 " p95=%" PRIu32 " max=%" PRIu32 " us",
+             UI_NAVIGATION_BUTTONS ? "lvgl encoder" : "input ring", stats.count, stats.p50_us, stats.p95_us,
+             stats.max_us);
+#if UI_NAVIGATION_BUTTONS
+    lcd_nav_stats_t nav;
+    lcd_get_navigation_stats(&nav);
+    ESP_LOGI(TAG, "press to lv_indev_read: avg=%" PRIu32 " max=%" PRIu32 " us", nav.avg_read_us, nav.max_read_us);
+#else
+    lcd_input_stats_t input;
+    lcd_input_get_stats(&input);
+    ESP_LOGI(TAG, "post to handler: avg=%" PRIu32 " max=%" PRIu32 " us", input.avg_latency_us, input.max_latency_us);
+#endif
 }
 
+// log the usage of the SRAM / PSRAM heaps LVGL allocates from
+static void log_heaps(void) {
+    static const char *names[LCD_MEM_POOL_MAX] = {[LCD_MEM_POOL_SRAM] = "SRAM", [LCD_MEM_POOL_PSRAM] = "PSRAM"};
+    for (int i = 0; i < LCD_MEM_POOL_MAX; i++) {
+        lcd_mem_pool_stats_t stats;
+        if (lcd_get_mem_pool_stats(i, &stats) != ESP_OK) {
+            continue;
+        }
+        ESP_LOGI(TAG, "%s heap: %u of %u bytes free (min %u, largest %u), %" PRIu32 " draw buffer fallbacks", names[i],
+                 (unsigned) stats.free_bytes, (unsigned) stats.total_bytes, (unsigned) stats.min_free_bytes,
+                 (unsigned) stats.largest_free_block, stats.fallbacks);
+    }
+}
 
 static void ui_update_task(void *pvParam) {
     // setup the test ui
@@ -249,25 +416,31 @@ static void ui_update_task(void *pvParam) {
     ui_init();
     lvgl_port_unlock();
 
+    int64_t last_log_us = esp_timer_get_time();
     while (1) {
-        // update the ui every 50 milliseconds
-        //vTaskDelay(pdMS_TO_TICKS(50));
-        if (lvgl_port_lock(0)) {
-            // update ui under lvgl semaphore lock
-            update_ui();
-            lvgl_port_unlock();
+        // sleep until the hw info timer or a button callback has queued something for the ui,
+        // then update the ui with everything queued under one lvgl lock
+        lcd_input_drain(input_event_handler, NULL, INPUT_LATENCY_LOG_MS);
+
+        int64_t now_us = esp_timer_get_time();
+        if (now_us - last_log_us >= INPUT_LATENCY_LOG_MS * 1000) {
+            log_input_latency();
+            log_heaps();
+            last_log_us = now_us;
         }
     }
 
     // a freeRTOS task should never return ^^^
 }
 
+#if !LVGL_TICKLESS
 // increment lvgl timer
 static void lvgl_ticker_timer_cb(void *arg)
 {
     /* Tell LVGL how many milliseconds have elapsed */
     lv_tick_inc(LVGL_TICK_PERIOD_MS);
 }
+#endif
 
 static void ui_lvgl_demos_task(void *pvParam) {
     // this is a workaround to get the lvgl demos working with esp-idf lvgl port
@@ -277,6 +450,8 @@ static void ui_lvgl_demos_task(void *pvParam) {
     // first acquire port lock
     lvgl_port_lock(0);
 
+    // with LVGL_TICKLESS LVGL reads the time from esp_timer, there is no tick timer to replace
+#if !LVGL_TICKLESS
     // stop lvgl port (lvgl tick timer)
     if(lvgl_port_stop() == ESP_OK) {
         ESP_LOGI(TAG, "lvgl_port_stop ok");
@@ -293,6 +468,7 @@ static void ui_lvgl_demos_task(void *pvParam) {
     esp_timer_handle_t tick_timer;
     esp_timer_create(&lvgl_tick_timer_args, &tick_timer);
     esp_timer_start_periodic(tick_timer, LVGL_TICK_PERIOD_MS * 1000);
+#endif
 
 
     // start the lvgl demos
@@ -330,6 +506,12 @@ void app_main(void) {
     // don't turn on backlight yet - demo of gradual brightness increase is shown below
     // otherwise you can set it to true to turn on the backlight at lcd init
     lcd_init(&disp_handle, false);
+#if RUN_FLUSH_BENCHMARK
+    lcd_flush_benchmark_sweep();
+#endif
+#if RUN_BLEND_BENCHMARK && LCD_SIMD_BLEND
+    lcd_blend_benchmark();
+#endif
 
 #if defined CONFIG_LV_USE_DEMO_BENCHMARK || defined CONFIG_LV_USE_DEMO_STRESS
     lcd_set_brightness_step(100);
@@ -343,6 +525,8 @@ void app_main(void) {
 #else
     // otherwise it will show my example
 
+    ESP_ERROR_CHECK(lcd_input_ring_create(INPUT_RING_SIZE, &input_ring));
+
     // configure the buttons
     setup_buttons();
 
@@ -358,7 +542,7 @@ void app_main(void) {
     ESP_ERROR_CHECK(esp_timer_start_periodic(update_hw_info_timer_handle, 250 * 1000));
 
     // configure a FreeRTOS task, pinned to the second core (core 0 should be used for hw such as wifi, bt etc)
-    xTaskCreatePinnedToCore(ui_update_task, "update_ui", 4096 * 2, NULL, 0, NULL, 1);
+    xTaskCreatePinnedToCore(ui_update_task, "update_ui", 4096 * 2, NULL, 0, &ui_update_task_hdl, 1);
 
     // demonstrate the lcd brightness fade using aw9364 driver
     lcd_set_brightness_pct_fade(100,3000);